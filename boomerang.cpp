@@ -14,6 +14,7 @@
 #include "prog.h"
 #include "proc.h"
 #include "BinaryFile.h"
+#include "IBinarySymbols.h"
 #include "frontend.h"
 #include "signature.h"
 //#include "transformer.h"
@@ -28,6 +29,7 @@
 #endif
 
 #include <QtCore/QDebug>
+#include <algorithm>
 #include <ctime>
 
 Boomerang *Boomerang::boomerang = nullptr;
@@ -686,6 +688,20 @@ Prog *Boomerang::loadAndDecode(const QString &fname, const char *pname) {
         LOG_STREAM(LL_Default) << "failed.\n";
         return nullptr;
     }
+    return decode(prog, fe, pname);
+}
+
+/**
+ * Decodes a program whose file has already been loaded.
+ *
+ * \param prog  The Prog to decode into.
+ * \param fe    The front end for the loaded file, made for \a prog.
+ * \param pname How the Prog will be named.
+ *
+ * \returns \a prog.
+ */
+Prog *Boomerang::decode(Prog *prog, FrontEnd *fe, const char *pname) {
+    QTextStream q_cout(stdout);
     prog->setFrontEnd(fe);
 
     // Add symbols from -s switch(es)
@@ -711,6 +727,10 @@ Prog *Boomerang::loadAndDecode(const QString &fname, const char *pname) {
     }
 
     if (entrypoints.size() == 0) { // no -e or -E given
+        if (linearSweep) {
+            q_cout << "sweeping for procedures...\n";
+            fe->sweepForProcs();
+        }
         if (decodeMain)
             q_cout << "decoding entry point...\n";
         fe->decode(prog, decodeMain, pname);
@@ -774,7 +794,64 @@ int Boomerang::decompile(const QString &fname, const char *pname) {
         if (prog == nullptr)
             return 1;
     }
+    return decompile(prog, start);
+}
 
+/**
+ * Decompiles each member of the archive (static library) \a fname in turn, in the order they are in the archive.
+ * Each member that is an object file becomes a Prog of its own, named after the member, so its output goes to a
+ * directory of that name. The functions a member defines are its entry points; -e and -E switches are ignored,
+ * since their addresses can't apply to every member.
+ *
+ * \param fname The name of the archive.
+ *
+ * \return Zero if the archive was read and every object file in it decompiled; nonzero otherwise.
+ */
+int Boomerang::decompileArchive(const QString &fname) {
+    if (logger == nullptr)
+        setLogger(new FileLogger());
+    QTextStream q_cout(stdout);
+    std::vector<ADDRESS> givenEntrypoints;
+    givenEntrypoints.swap(entrypoints);
+    int failures = 0;
+    BinaryFileFactory bff;
+    bool loaded = bff.LoadArchive(fname, [&](const QString &member, QObject *pBF) {
+        if (pBF == nullptr) {
+            q_cout << "skipping member " << member << "\n";
+            return;
+        }
+        q_cout << "decompiling member " << member << "\n";
+        time_t start;
+        time(&start);
+        Prog *prog = new Prog(member);
+        FrontEnd *fe = FrontEnd::instantiate(pBF, prog, &bff);
+        if (fe == nullptr) {
+            ++failures;
+            delete prog;
+            return;
+        }
+        entrypoints.clear();
+        for (const IBinarySymbol *sym : *getSymbols())
+            if (sym->isFunction() && !sym->isImported())
+                entrypoints.push_back(sym->getLocation());
+        std::sort(entrypoints.begin(), entrypoints.end());
+        entrypoints.erase(std::unique(entrypoints.begin(), entrypoints.end()), entrypoints.end());
+        QByteArray name = QFileInfo(member).completeBaseName().toLocal8Bit();
+        if (decompile(decode(prog, fe, name.constData()), start) != 0)
+            ++failures;
+    });
+    entrypoints.swap(givenEntrypoints);
+    return (loaded && failures == 0) ? 0 : 1;
+}
+
+/**
+ * Decompiles a decoded program and writes its output, then deletes it. After decompilation the elapsed time since
+ * \a start is printed.
+ *
+ * \return Zero on success, nonzero on failure.
+ */
+int Boomerang::decompile(Prog *prog, time_t start) {
+    QTextStream q_cout(stdout);
     if (saveBeforeDecompile) {
         LOG_STREAM() << "saving persistable state...\n";
         XMLProgParser *p = new XMLProgParser();
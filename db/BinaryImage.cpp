@@ -49,7 +49,22 @@ void Write4(int *pi, int val,bool bigEndian) {
     }
 }
 
-BinaryImage::BinaryImage()
+/***************************************************************************/ /**
+  * \brief The section range most recently found by getSectionInfoByAddr, per thread.
+  * Consecutive lookups (decoding, reading a jump table) nearly always fall in the same section, so checking this
+  * first saves most of the interval map searches.
+  ******************************************************************************/
+struct SectionLastHit {
+    const BinaryImage *Image = nullptr;
+    uint64_t Generation = 0;
+    ADDRESS From, To; // [From, To)
+    const SectionInfo *Section = nullptr;
+};
+static thread_local SectionLastHit lastHit;
+// Generations are unique across all images: an image allocated where a deleted one was must not match its stale hits
+static std::atomic<uint64_t> nextGeneration(1);
+
+BinaryImage::BinaryImage() : Generation(nextGeneration++), LazySections(false)
 {
 }
 
@@ -58,11 +73,15 @@ BinaryImage::~BinaryImage()
 }
 void BinaryImage::reset()
 {
+    Generation = nextGeneration++;
     SectionMap.clear();
     for(IBinarySection *si : Sections) {
         delete si;
     }
     Sections.clear();
+    StringIndex.clear();
+    AllStrings.clear();
+    AllStringsBuilt = false;
 }
 
 char BinaryImage::readNative1(ADDRESS nat) {
@@ -181,7 +200,8 @@ void BinaryImage::calculateTextLimits() {
         ADDRESS hiAddress = pSect->sourceAddr() + pSect->size();
         if (hiAddress > limitTextHigh)
             limitTextHigh = hiAddress;
-        ptrdiff_t host_native_diff = (pSect->hostAddr() - pSect->sourceAddr()).m_value;
+        // Not hostAddr(), which would load the contents of a lazily loaded section
+        ptrdiff_t host_native_diff = (static_cast<SectionInfo *>(pSect)->uHostAddr - pSect->sourceAddr()).m_value;
         if (TextDelta == 0)
             TextDelta = host_native_diff;
         else {
@@ -192,14 +212,31 @@ void BinaryImage::calculateTextLimits() {
 }
 
 const IBinarySection *BinaryImage::getSectionInfoByAddr(ADDRESS uEntry) const {
+    if (lastHit.Image == this && lastHit.Generation == Generation && lastHit.From <= uEntry && uEntry < lastHit.To)
+        return lastHit.Section;
     if(!uEntry.isSourceAddr())
         qDebug()<<"getSectionInfoByAddr with non-Source ADDRESS";
     auto iter = SectionMap.find(uEntry);
     if(iter==SectionMap.end()) {
         return nullptr;
     }
+    lastHit.Image = this;
+    lastHit.Generation = Generation;
+    lastHit.From = iter->first.lower();
+    lastHit.To = iter->first.upper();
+    lastHit.Section = iter->second;
     return iter->second;
 }
+
+const uint8_t *BinaryImage::readSpan(ADDRESS nat, size_t size) const {
+    const IBinarySection *si = getSectionInfoByAddr(nat);
+    if (si == nullptr || si->hostAddr().isZero())
+        return nullptr;
+    ADDRESS offset = nat - si->sourceAddr();
+    if (offset.m_value + size > si->size())
+        return nullptr;
+    return (const uint8_t *)(si->hostAddr() + offset).m_value;
+}
 //! Find section index given name, or -1 if not found
 int BinaryImage::GetSectionIndexByName(const QString &sName) {
     for (int32_t i = Sections.size()-1; i >= 0; --i) {
@@ -221,12 +258,129 @@ bool BinaryImage::isReadOnly(ADDRESS uEntry) {
     const SectionInfo * p = static_cast<const SectionInfo *>(getSectionInfoByAddr(uEntry));
     if(!p)
         return false;
-    if(p->bReadOnly)
+    return p->bReadOnly || p->hasAttribute(ATTR_ReadOnly,uEntry);
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief Whether section si may hold string constants: a data or read only section, or one with a range the loader
+  * marked as holding strings. Code is left out, as runs of opcode bytes would swamp the index.
+  ******************************************************************************/
+static bool holdsStrings(const SectionInfo *si) {
+    uint32_t flags = si->attributeFlagsInRange(si->uNativeAddr, si->uNativeAddr + si->uSectionSize);
+    if (flags & ATTR_StringsSection)
         return true;
-    QVariant v = p->attributeInRange("ReadOnly",uEntry,uEntry+1);
-    return !v.isNull();
+    if (si->bCode || (flags & ATTR_Code))
+        return false;
+    return si->bData || si->bReadOnly || (flags & (ATTR_Data | ATTR_ReadOnly)) != 0;
 }
 
+/***************************************************************************/ /**
+  *
+  * \brief Find every NUL terminated run of at least two text characters (printable, tab, newline, carriage return
+  * or 8 bit) in section si, in address order
+  ******************************************************************************/
+static void findSectionStrings(const SectionInfo *si, std::vector<StringConstant> &strings) {
+    auto isText = [](uint8_t c) { return c >= 0x80 || (c >= ' ' && c != 0x7F) || c == '\t' || c == '\n' || c == '\r'; };
+    bool hasStringsSection =
+        (si->attributeFlagsInRange(si->uNativeAddr, si->uNativeAddr + si->uSectionSize) & ATTR_StringsSection) != 0;
+    const uint8_t *bytes = (const uint8_t *)si->hostAddr().m_value;
+    uint32_t size = si->uSectionSize;
+    for (uint32_t i = 0; i < size; ++i) {
+        uint32_t start = i;
+        uint8_t encoding = 0;
+        for (; i < size && isText(bytes[i]); ++i)
+            if (bytes[i] >= 0x80)
+                encoding = 1;
+        if (i == size || bytes[i] != 0 || i - start < 2)
+            continue;
+        ADDRESS addr = si->uNativeAddr + start;
+        bool inStrings = hasStringsSection && si->hasAttribute(ATTR_StringsSection, addr);
+        strings.push_back({addr, i - start, encoding, inStrings});
+    }
+    strings.shrink_to_fit();
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief Index the strings of the loaded data sections, so that string constant queries are lookups rather than
+  * byte scans. Sections whose contents are loaded lazily are left until a query first needs them; if there are none,
+  * the list for getStrings() is made here too.
+  ******************************************************************************/
+void BinaryImage::indexStrings() {
+    std::lock_guard<std::mutex> guard(StringIndexMutex);
+    StringIndex.clear();
+    AllStrings.clear();
+    bool allIndexed = true;
+    for (IBinarySection *sect : Sections) {
+        const SectionInfo *si = static_cast<const SectionInfo *>(sect);
+        if (si->bBss || si->uHostAddr.isZero() || si->uSectionSize == 0 || !holdsStrings(si))
+            continue;
+        StringIndex.emplace_back(new SectionStrings(si));
+        if (si->isMaterialised()) {
+            findSectionStrings(si, StringIndex.back()->Strings);
+            StringIndex.back()->Indexed = true;
+        }
+        else
+            allIndexed = false;
+    }
+    if (allIndexed)
+        collectStrings();
+    AllStringsBuilt.store(allIndexed, std::memory_order_release);
+}
+
+//! Gather the strings of every StringIndex entry, all of which are indexed, into AllStrings. StringIndexMutex is held
+void BinaryImage::collectStrings() const {
+    for (const std::unique_ptr<SectionStrings> &entry : StringIndex)
+        AllStrings.insert(AllStrings.end(), entry->Strings.begin(), entry->Strings.end());
+    std::sort(AllStrings.begin(), AllStrings.end(),
+              [](const StringConstant &a, const StringConstant &b) { return a.addr < b.addr; });
+    AllStrings.shrink_to_fit();
+}
+
+//! The strings of the section that StringIndex entry \a entry is for, indexing them first if need be
+const std::vector<StringConstant> &BinaryImage::sectionStrings(const SectionStrings &entry) const {
+    if (!entry.Indexed.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> guard(StringIndexMutex);
+        if (!entry.Indexed.load(std::memory_order_relaxed)) {
+            findSectionStrings(entry.Section, entry.Strings);
+            entry.Indexed.store(true, std::memory_order_release);
+        }
+    }
+    return entry.Strings;
+}
+
+const StringConstant *BinaryImage::findString(ADDRESS a) const {
+    const IBinarySection *si = getSectionInfoByAddr(a);
+    if (si == nullptr)
+        return nullptr;
+    for (const std::unique_ptr<SectionStrings> &entry : StringIndex) {
+        if (entry->Section != si)
+            continue;
+        const std::vector<StringConstant> &strings = sectionStrings(*entry);
+        auto it = std::upper_bound(strings.begin(), strings.end(), a,
+                                   [](ADDRESS addr, const StringConstant &s) { return addr < s.addr; });
+        if (it == strings.begin())
+            return nullptr;
+        --it;
+        return a < it->addr + it->length ? &*it : nullptr;
+    }
+    return nullptr;
+}
+
+//! Made by indexStrings, or by the first call if some sections were still to be loaded then; never changed after that
+const std::vector<StringConstant> &BinaryImage::getStrings() const {
+    if (!AllStringsBuilt.load(std::memory_order_acquire)) {
+        for (const std::unique_ptr<SectionStrings> &entry : StringIndex)
+            sectionStrings(*entry);
+        std::lock_guard<std::mutex> guard(StringIndexMutex);
+        if (!AllStringsBuilt.load(std::memory_order_relaxed)) {
+            collectStrings();
+            AllStringsBuilt.store(true, std::memory_order_release);
+        }
+    }
+    return AllStrings;
+}
 
 ADDRESS BinaryImage::getLimitTextLow() {
     auto interval = SectionMap.begin()->first;
@@ -248,6 +402,7 @@ SectionInfo *BinaryImage::createSection(const QString &name, ADDRESS from, ADDRE
     if(SectionMap.find(interval<ADDRESS>::right_open(from,to))!=SectionMap.end()) {
         return nullptr;
     }
+    Generation = nextGeneration++;
     SectionInfo *sect = new SectionInfo(name);
     sect->uNativeAddr = from;
     sect->uSectionSize = (to-from).m_value;
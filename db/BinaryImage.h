@@ -4,6 +4,10 @@
 #include "IBinaryImage.h"
 
 #include <boost/icl/interval_map.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 
 struct SectionHolder {
     SectionHolder() : val(nullptr) {}
@@ -43,6 +47,7 @@ public:
     float  readNativeFloat4(ADDRESS nat) override;
     double readNativeFloat8(ADDRESS nat) override;
     void   writeNative4(ADDRESS nat, uint32_t n) override;
+    const uint8_t *readSpan(ADDRESS nat, size_t size) const override;
     void calculateTextLimits() override;
     //! Find the section, given an address in the section
     const IBinarySection *getSectionInfoByAddr(ADDRESS uEntry) const override;
@@ -51,6 +56,11 @@ public:
     IBinarySection *GetSectionInfoByName(const QString &sName) override;
     const IBinarySection *GetSectionInfo(int idx) const override { return Sections[idx]; }
     bool        isReadOnly(ADDRESS uEntry) override;
+    void        setLazySections(bool lazy) override { LazySections = lazy; }
+    bool        lazySections() const override { return LazySections; }
+    void        indexStrings() override;
+    const StringConstant *findString(ADDRESS a) const override;
+    const std::vector<StringConstant> &getStrings() const override;
     ADDRESS     getLimitTextLow() override;
     ADDRESS     getLimitTextHigh() override;
     ptrdiff_t   getTextDelta() override { return TextDelta; }
@@ -70,6 +80,22 @@ private:
     ptrdiff_t TextDelta;
     MapAddressRangeToSection SectionMap;
     SectionListType Sections; //!< The section info
+    uint64_t Generation;      //!< Changed whenever SectionMap changes, to invalidate the threads' last hit caches.
+                              //!< Drawn from a process-wide counter, so no two images ever share a generation
+    bool LazySections;
+    //! The strings of one section; found when the section is first searched if it was not loaded by indexStrings
+    struct SectionStrings {
+        explicit SectionStrings(const SectionInfo *si) : Section(si), Indexed(false) {}
+        const SectionInfo *Section;
+        mutable std::vector<StringConstant> Strings; //!< By address
+        mutable std::atomic<bool> Indexed;
+    };
+    const std::vector<StringConstant> &sectionStrings(const SectionStrings &entry) const;
+    void collectStrings() const;
+    std::vector<std::unique_ptr<SectionStrings>> StringIndex; //!< One entry per data section with contents
+    mutable std::vector<StringConstant> AllStrings;          //!< All the strings by address, for getStrings()
+    mutable std::atomic<bool> AllStringsBuilt{false};        //!< AllStrings is complete, and will not change again
+    mutable std::mutex StringIndexMutex;                     //!< Guards the lazy parts of the string index
 };
 
 
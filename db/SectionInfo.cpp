@@ -7,8 +7,24 @@
 #include <boost/icl/interval_set.hpp>
 #include <boost/icl/interval_map.hpp>
 #include <algorithm>
+#include <cstring>
+#include <mutex>
 #include <utility>
 using namespace boost::icl;
+namespace {
+//! The well known attribute names, in SectionAttribute bit order
+const char *const AttributeNames[] = {"StringsSection", "ReadOnly", "Code", "Data"};
+const int NumAttributeNames = sizeof(AttributeNames) / sizeof(AttributeNames[0]);
+
+//! The SectionAttribute flag for the attribute called name, or ATTR_None if it is not a well known one
+uint32_t attributeFlag(const QString &name) {
+    for (int i = 0; i < NumAttributeNames; ++i)
+        if (name == QLatin1String(AttributeNames[i]))
+            return 1u << i;
+    return ATTR_None;
+}
+}
+
 struct VariantHolder {
     mutable QVariantMap val;
     QVariantMap &get() const {return val;}
@@ -21,9 +37,20 @@ struct VariantHolder {
     }
 
 };
+//! SectionAttribute flags; overlapping ranges combine their flags
+struct AttributeBits {
+    uint32_t bits;
+    AttributeBits &operator+=(const AttributeBits &other) {
+        bits |= other.bits;
+        return *this;
+    }
+    bool operator==(const AttributeBits &other) const { return bits == other.bits; }
+};
 struct SectionInfoImpl {
     boost::icl::interval_set<ADDRESS> HasDefinedValue;
-    boost::icl::interval_map<ADDRESS,VariantHolder> AttributeMap;
+    boost::icl::interval_map<ADDRESS,AttributeBits> FlagMap;
+    uint32_t AnyFlags = 0; //!< Union of all the flags in FlagMap, so that most queries need no lookup at all
+    boost::icl::interval_map<ADDRESS,VariantHolder> AttributeMap; //!< Attributes that are not well known ones
     void clearDefinedArea() {
         HasDefinedValue.clear();
     }
@@ -34,13 +61,41 @@ struct SectionInfoImpl {
         assert(!HasDefinedValue.empty());
         return HasDefinedValue.find(a)==HasDefinedValue.end();
     }
+    void addAttributeFlags(uint32_t flags, ADDRESS from, ADDRESS to) {
+        if (flags == ATTR_None || !(from < to))
+            return;
+        FlagMap.add(std::make_pair(interval<ADDRESS>::right_open(from,to),AttributeBits{flags}));
+        AnyFlags |= flags;
+    }
+    uint32_t attributeFlagsInRange(ADDRESS from, ADDRESS to) const {
+        if (AnyFlags == ATTR_None)
+            return ATTR_None;
+        uint32_t res = ATTR_None;
+        auto v = FlagMap.equal_range(interval<ADDRESS>::right_open(from,to));
+        for(auto iter=v.first; iter!=v.second; ++iter)
+            res |= iter->second.bits;
+        return res;
+    }
+    bool hasAttribute(uint32_t flags, ADDRESS a) const {
+        if ((AnyFlags & flags) == 0)
+            return false;
+        auto iter = FlagMap.find(a);
+        return iter != FlagMap.end() && (iter->second.bits & flags) != 0;
+    }
     void setAttributeForRange(const QString &name, const QVariant &val, ADDRESS from, ADDRESS to) {
+        // As before, it is the presence of a well known attribute that counts, not its value
+        if (uint32_t flag = attributeFlag(name)) {
+            addAttributeFlags(flag,from,to);
+            return;
+        }
         QVariantMap vmap;
         vmap[name] = val;
         VariantHolder map { vmap  };
         AttributeMap.add(std::make_pair(interval<ADDRESS>::right_open(from,to),map));
     }
     QVariant attributeInRange(const QString &attrib, ADDRESS from, ADDRESS to) const {
+        if (uint32_t flag = attributeFlag(attrib))
+            return (attributeFlagsInRange(from,to) & flag) ? QVariant(true) : QVariant();
         auto v = AttributeMap.equal_range(interval<ADDRESS>::right_open(from,to));
         if(v.first==AttributeMap.end())
             return QVariant();
@@ -56,6 +111,10 @@ struct SectionInfoImpl {
     }
     QVariantMap getAttributesForRange(ADDRESS from, ADDRESS to) {
         QVariantMap res;
+        uint32_t flags = attributeFlagsInRange(from,to);
+        for (int i = 0; i < NumAttributeNames; ++i)
+            if (flags & (1u << i))
+                res[AttributeNames[i]] = true;
         auto v = AttributeMap.equal_range(interval<ADDRESS>::right_open(from,to));
         if(v.first==AttributeMap.end())
             return res;
@@ -69,7 +128,8 @@ struct SectionInfoImpl {
 
 SectionInfo::SectionInfo(const QString &name)
     : pSectionName(name),uNativeAddr(ADDRESS::g(0L)), uHostAddr(ADDRESS::g(0L)), uSectionSize(0),
-      uSectionEntrySize(0), uType(0), bCode(false), bData(false), bBss(0), bReadOnly(0),Impl(new SectionInfoImpl) {}
+      uSectionEntrySize(0), uType(0), bCode(false), bData(false), bBss(0), bReadOnly(0), Endiannes(0),
+      LazySource(nullptr), LazySize(0), LazyPending(false), Impl(new SectionInfoImpl) {}
 
 SectionInfo::SectionInfo(const SectionInfo &other) : SectionInfo(other.pSectionName)
 {
@@ -82,6 +142,10 @@ SectionInfo::SectionInfo(const SectionInfo &other) : SectionInfo(other.pSectionN
     bData = other.bData;
     bBss = other.bBss;
     bReadOnly = other.bReadOnly;
+    Endiannes = other.Endiannes;
+    LazySource = other.LazySource;
+    LazySize = other.LazySize;
+    LazyPending = other.LazyPending.load();
 }
 SectionInfo::~SectionInfo() {
     delete Impl;
@@ -98,6 +162,25 @@ bool SectionInfo::isAddressBss(ADDRESS a) const {
     return Impl->isAddressBss(a);
 }
 
+IBinarySection &SectionInfo::setLazyContents(const void *src, uint32_t size)
+{
+    LazySource = src;
+    LazySize = size;
+    LazyPending.store(size != 0, std::memory_order_release);
+    return *this;
+}
+
+void SectionInfo::materialise() const
+{
+    // Rare (once per section), so one lock for all sections will do
+    static std::mutex materialiseMutex;
+    std::lock_guard<std::mutex> guard(materialiseMutex);
+    if (!LazyPending.load(std::memory_order_relaxed))
+        return;
+    memcpy((void *)uHostAddr.m_value, LazySource, LazySize);
+    LazyPending.store(false, std::memory_order_release);
+}
+
 bool SectionInfo::anyDefinedValues() const { return !Impl->HasDefinedValue.empty();}
 
 void SectionInfo::resize(uint32_t sz)
@@ -134,3 +217,18 @@ QVariant SectionInfo::attributeInRange(const QString &attrib, ADDRESS from, ADDR
 {
     return Impl->attributeInRange(attrib,from,to);
 }
+
+void SectionInfo::addAttributeFlags(uint32_t flags, ADDRESS from, ADDRESS to)
+{
+    Impl->addAttributeFlags(flags,from,to);
+}
+
+uint32_t SectionInfo::attributeFlagsInRange(ADDRESS from, ADDRESS to) const
+{
+    return Impl->attributeFlagsInRange(from,to);
+}
+
+bool SectionInfo::hasAttribute(uint32_t flags, ADDRESS a) const
+{
+    return Impl->hasAttribute(flags,a);
+}
@@ -4,6 +4,7 @@
 #include "IBinarySection.h"
 
 #include <QString>
+#include <atomic>
 class QVariant;
 struct SectionInfoImpl;
 //! SectionInfo structure - All information about the sections is contained in these
@@ -23,11 +24,18 @@ public:
     unsigned    bBss : 1;          // Set if section is BSS (allocated only)
     unsigned    bReadOnly : 1;     // Set if this is a read only section
     uint8_t     Endiannes;          // 0 Little endian, 1 Big endian
+    const void *LazySource;        // Where the contents are copied from when first used (see setLazyContents)
+    uint32_t    LazySize;
+    mutable std::atomic<bool> LazyPending; // Set while the contents are still to be copied in
 
     SectionInfo(const QString &name="");    // Constructor
     SectionInfo(const SectionInfo &other);
     virtual ~SectionInfo();
-    ADDRESS  hostAddr()     const override { return uHostAddr; }
+    ADDRESS  hostAddr()     const override {
+        if (LazyPending.load(std::memory_order_acquire))
+            materialise();
+        return uHostAddr;
+    }
     ADDRESS  sourceAddr()   const override { return uNativeAddr; }
     uint8_t  getEndian()    const override { return Endiannes; }
     bool     isReadOnly()   const override { return bReadOnly; }
@@ -44,6 +52,9 @@ public:
     IBinarySection &setHostAddr(ADDRESS v) override { uHostAddr = v; return *this; }
     IBinarySection &setEntrySize(uint32_t v) override { uSectionEntrySize = v; return *this; }
     IBinarySection &setEndian(uint8_t v) override { Endiannes = v; return *this; }
+    IBinarySection &setLazyContents(const void *src, uint32_t size) override;
+    void     materialise() const override;
+    bool     isMaterialised() const override { return !LazyPending.load(std::memory_order_acquire); }
 
     bool        isAddressBss(ADDRESS a) const override;
     bool        anyDefinedValues() const override;
@@ -54,6 +65,9 @@ public:
     void        setAttributeForRange(const QString &name,const QVariant &val,ADDRESS from,ADDRESS to) override;
     QVariantMap getAttributesForRange(ADDRESS from,ADDRESS to) override;
     QVariant    attributeInRange(const QString &attrib,ADDRESS from,ADDRESS to) const;
+    void        addAttributeFlags(uint32_t flags,ADDRESS from,ADDRESS to) override;
+    uint32_t    attributeFlagsInRange(ADDRESS from,ADDRESS to) const override;
+    bool        hasAttribute(uint32_t flags,ADDRESS a) const override;
 private:
     SectionInfoImpl *Impl;
 };
@@ -9,13 +9,14 @@
 
 /***************************************************************************/ /**
   * \file        SymTab.cpp
-  * \brief    This file contains the implementation of the class SymTab, a simple class to maintain a pair of maps
-  *                so that symbols can be accessed by symbol or by name
+  * \brief    This file contains the implementation of the class SymTab, a simple class to maintain a pair of hash
+  *                indexes so that symbols can be accessed by address or by name
   ******************************************************************************/
 #include "SymTab.h"
 #include "boomerang.h"
 
 #include <QDebug>
+#include <algorithm>
 #include <cassert>
 SymTab::SymTab() {}
 
@@ -25,50 +26,104 @@ SymTab::~SymTab() {
 void SymTab::clear() {
     for(IBinarySymbol *s : SymbolList)
         delete s;
-    for(std::pair<const ADDRESS, BinarySymbol *> &s : amap)
-        delete s.second;
     SymbolList.clear();
-    amap.clear();
-    smap.clear();
+    Symbols.clear();
+    AddressIndex.clear();
+    NameIndex.clear();
+    invalidateRangeIndex();
+}
+void SymTab::reserve(size_t n) {
+    AddressIndex.reserve(Symbols.size() + n);
+    NameIndex.reserve(Symbols.size() + n);
 }
 IBinarySymbol &SymTab::create(ADDRESS a, const QString &s, bool local) {
-    assert(amap.find(a)==amap.end());
-    assert(smap.find(s)==smap.end());
-    BinarySymbol * sym = new BinarySymbol;
+    assert(AddressIndex.find(a)==-1);
+    assert(NameIndex.find(s)==-1);
+    uint32_t pos = (uint32_t)Symbols.size();
+    Symbols.emplace_back();
+    BinarySymbol *sym = &Symbols.back();
+    sym->Owner = this;
     sym->Location = a;
     sym->Name = s;
-    amap[a] = sym;
+    AddressIndex.insert(a,pos);
     if(!local)
-        smap[s] = sym;
+        NameIndex.insert(s,pos);
+    invalidateRangeIndex();
     return *sym;
 }
 
 const IBinarySymbol *SymTab::find(ADDRESS a) const {
-    auto ff = amap.find(a);
-    if (ff == amap.end())
-        return nullptr;
-    return ff->second;
+    long pos = AddressIndex.find(a);
+    return pos < 0 ? nullptr : &Symbols[pos];
 }
 
 const IBinarySymbol *SymTab::find(const QString &s) const {
-    auto ff = smap.find(s);
-    if (ff == smap.end())
-        return nullptr;
-    return ff->second;
+    long pos = NameIndex.find(s);
+    return pos < 0 ? nullptr : &Symbols[pos];
+}
+
+void SymTab::invalidateRangeIndex() {
+    std::lock_guard<std::mutex> guard(RangeIndexMutex);
+    RangeIndexValid = false;
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief Build the interval index of the symbols' ranges. Sizes are usually only known once the loader is done,
+  * so this is done by the first query after the symbols were last changed (i.e. once per load).
+  * \note RangeIndexMutex must be held
+  ******************************************************************************/
+void SymTab::buildRangeIndex() const {
+    RangeIndex.clear();
+    for (const BinarySymbol &s : Symbols)
+        if (s.Size != 0)
+            RangeIndex.push_back({s.Location, s.Location + s.Size, ADDRESS::g(0L), &s});
+    std::sort(RangeIndex.begin(), RangeIndex.end(),
+              [](const SymbolRange &a, const SymbolRange &b) { return a.Start < b.Start; });
+    for (size_t i = 0; i < RangeIndex.size(); ++i) {
+        SymbolRange &r = RangeIndex[i];
+        r.MaxEnd = (i == 0 || RangeIndex[i - 1].MaxEnd < r.End) ? r.End : RangeIndex[i - 1].MaxEnd;
+    }
+    RangeIndexValid = true;
+}
+
+const IBinarySymbol *SymTab::findContainingSymbol(ADDRESS a) const {
+    std::lock_guard<std::mutex> guard(RangeIndexMutex);
+    if (!RangeIndexValid)
+        buildRangeIndex();
+    // Last range starting at or before a
+    auto it = std::upper_bound(RangeIndex.begin(), RangeIndex.end(), a,
+                               [](ADDRESS addr, const SymbolRange &r) { return addr < r.Start; });
+    // Walk back to the nearest start whose range contains a. MaxEnd stops the walk as soon as no earlier range can
+    // reach a, so this only goes past the first candidate for nested or overlapping symbols
+    while (it != RangeIndex.begin()) {
+        --it;
+        if (!(a < it->MaxEnd))
+            break;
+        if (a < it->End)
+            return it->Symbol;
+    }
+    return nullptr;
 }
 
+void BinarySymbol::setSize(size_t v) {
+    Size = v;
+    if (Owner)
+        Owner->invalidateRangeIndex();
+}
 
 bool BinarySymbol::rename(const QString &s)
 {
-    //TODO: this code assumes only one BinarySymbolTable instance exists
-    SymTab *sym_tab = (SymTab *)Boomerang::get()->getSymbols();
-    if(sym_tab->smap.find(s)!=sym_tab->smap.end()) {
+    SymTab *sym_tab = Owner ? Owner : (SymTab *)Boomerang::get()->getSymbols();
+    if(sym_tab->NameIndex.find(s)!=-1) {
         qDebug()<<"Renaming symbol " << Name << " to " << s << " failed - new name clashes with another symbol";
         return false; // symbol name clash
     }
-    sym_tab->smap.erase(Name);
+    long pos = sym_tab->AddressIndex.find(Location);
+    assert(pos >= 0 && &sym_tab->Symbols[pos] == this);
+    sym_tab->NameIndex.erase(Name);
     Name = s;
-    sym_tab->smap[Name] = this;
+    sym_tab->NameIndex.insert(Name,(uint32_t)pos);
     return true;
 }
 bool BinarySymbol::isImported() const {
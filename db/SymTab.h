@@ -23,23 +23,28 @@
 #include "IBinarySymbols.h"
 
 #include "types.h"
+#include <QHash>
 #include <QVariantMap>
+#include <deque>
 #include <memory>
-#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
 typedef std::shared_ptr<class Type> SharedType;
+class SymTab;
 struct BinarySymbol : public IBinarySymbol {
+    SymTab *Owner = nullptr; //!< The table this symbol is in
     QString Name;
     ADDRESS Location;
     SharedType type;
-    size_t Size;
+    size_t Size = 0;
     //! it's mutable since no changes in attribute map will influence the layout of symbols in SymTable
     mutable QVariantMap attributes;
 
     const QString &getName() const override { return Name; }
     size_t getSize() const override { return Size; }
-    void setSize(size_t v) override { Size=v; }
+    void setSize(size_t v) override;
     ADDRESS getLocation() const override { return Location; }
     const IBinarySymbol &setAttr(const QString &name,const QVariant &v) const override {
         attributes[name] = v;
@@ -53,23 +58,131 @@ struct BinarySymbol : public IBinarySymbol {
     bool isImported() const override;
     QString belongsToSourceFile() const override;
 };
+
+inline uint32_t symbolKeyHash(const QString &s) { return qHash(s); }
+inline uint32_t symbolKeyHash(ADDRESS a) {
+    uint64_t v = (uint64_t)a.m_value * 0x9E3779B97F4A7C15ULL; // Fibonacci hashing; the high bits are well mixed
+    return uint32_t(v >> 32);
+}
+
+/***************************************************************************/ /**
+  * Open addressing (linear probing) hash index from a key to a position in SymTab's symbol storage. The keys and
+  * their hashes are kept in the slots, so a lookup touches one cache line in the common case and only compares
+  * whole keys when the hashes match.
+  ******************************************************************************/
+template <typename Key> class SymbolHashIndex {
+    enum : uint32_t { EMPTY = 0, ERASED = ~0u };
+    struct Slot {
+        Key key;
+        uint32_t hash;
+        uint32_t pos; //!< EMPTY, ERASED, or the position + 1
+    };
+    std::vector<Slot> Slots;
+    size_t Used = 0; //!< Slots that are not EMPTY
+
+    void grow(size_t wanted) {
+        size_t cap = 16;
+        while (cap < 2 * wanted)
+            cap *= 2;
+        std::vector<Slot> old;
+        old.swap(Slots);
+        Slots.resize(cap, Slot{Key(), 0, EMPTY});
+        Used = 0;
+        for (const Slot &s : old)
+            if (s.pos != EMPTY && s.pos != ERASED)
+                place(s);
+    }
+    void place(const Slot &s) {
+        size_t mask = Slots.size() - 1;
+        for (size_t i = s.hash & mask;; i = (i + 1) & mask) {
+            if (Slots[i].pos == EMPTY) {
+                Slots[i] = s;
+                ++Used;
+                return;
+            }
+        }
+    }
+    //! Slot holding \a k, or -1
+    long lookup(const Key &k, uint32_t h) const {
+        if (Slots.empty())
+            return -1;
+        size_t mask = Slots.size() - 1;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            const Slot &s = Slots[i];
+            if (s.pos == EMPTY)
+                return -1;
+            if (s.pos != ERASED && s.hash == h && s.key == k)
+                return (long)i;
+        }
+    }
+
+  public:
+    void reserve(size_t n) {
+        if (2 * n > Slots.size())
+            grow(n);
+    }
+    void clear() {
+        Slots.clear();
+        Used = 0;
+    }
+    //! Position of the symbol with key \a k, or -1 if none
+    long find(const Key &k) const {
+        long i = lookup(k, symbolKeyHash(k));
+        return i < 0 ? -1 : long(Slots[i].pos - 1);
+    }
+    //! Map \a k to \a pos, replacing any existing mapping of k
+    void insert(const Key &k, uint32_t pos) {
+        uint32_t h = symbolKeyHash(k);
+        long i = lookup(k, h);
+        if (i >= 0) {
+            Slots[i].pos = pos + 1;
+            return;
+        }
+        if (2 * (Used + 1) > Slots.size())
+            grow(Used + 1); // Also drops the erased slots
+        place(Slot{k, h, pos + 1});
+    }
+    void erase(const Key &k) {
+        long i = lookup(k, symbolKeyHash(k));
+        if (i >= 0) {
+            Slots[i].key = Key();
+            Slots[i].pos = ERASED; // Still Used, so that probe sequences through it carry on
+        }
+    }
+};
+
 class SymTab : public IBinarySymbolTable {
     friend struct BinarySymbol;
 private:
-    // The map indexed by address.
-    std::map<ADDRESS, BinarySymbol *> amap;
-    // The map indexed by string. Note that the strings are stored twice.
-    std::map<QString, BinarySymbol *> smap;
+    //! All the symbols, in order of creation. A deque keeps them in large blocks without moving them as it grows
+    std::deque<BinarySymbol> Symbols;
+    SymbolHashIndex<ADDRESS> AddressIndex;
+    //! Index by name of the non local symbols
+    SymbolHashIndex<QString> NameIndex;
     std::vector<IBinarySymbol *>     SymbolList;
+    //! One symbol's range [Start, End) in the interval index
+    struct SymbolRange {
+        ADDRESS Start, End;
+        ADDRESS MaxEnd; //!< Largest End of this and all the ranges before it
+        const BinarySymbol *Symbol;
+    };
+    //! The ranges of all symbols with a non zero size, sorted by start; built on demand by findContainingSymbol
+    mutable std::vector<SymbolRange> RangeIndex;
+    mutable bool RangeIndexValid = false;
+    mutable std::mutex RangeIndexMutex; // Guards RangeIndex and RangeIndexValid
+    void buildRangeIndex() const;
+    void invalidateRangeIndex();
 
 public:
     SymTab();                     // Constructor
     ~SymTab();                    // Destructor
     BinarySymbol *getOrCreateSymbol();
+    void reserve(size_t n) override;
 
     IBinarySymbol &create(ADDRESS a, const QString &s,bool local=false) override;
     const IBinarySymbol *find(ADDRESS a) const override;  //!< Find an entry by address; nullptr if none
     const IBinarySymbol *find(const QString &s) const override;  //!< Find an entry by name; NO_ADDRESS if none
+    const IBinarySymbol *findContainingSymbol(ADDRESS a) const override;
     SymbolListType &        getSymbolList() { return SymbolList; }
     iterator                begin()       override { return SymbolList.begin(); }
     const_iterator          begin() const override { return SymbolList.begin(); }
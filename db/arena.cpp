@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2016, The Boomerang team
+ *
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL
+ * WARRANTIES.
+ *
+ */
+
+/***************************************************************************/ /**
+  * \file       arena.cpp
+  * \brief   Implementation of the ProcArena class
+  ******************************************************************************/
+
+#include "arena.h"
+
+#include <new>
+
+namespace {
+const size_t ALIGN = alignof(std::max_align_t);
+const size_t SLAB_SIZE = 64 * 1024;
+const size_t MAX_SMALL = SLAB_SIZE / 4; // Anything bigger gets a slab of its own
+// Every object is preceded by a header naming its arena (nullptr for the heap), so deallocate() can tell arena
+// memory from the heap without a shared index, and so without a lock
+const size_t HEADER = (sizeof(ProcArena *) + ALIGN - 1) & ~(ALIGN - 1);
+}
+
+thread_local ProcArena *ProcArena::Current = nullptr;
+
+ProcArena::Scope::Scope(ProcArena *arena) : Saved(Current) { Current = arena; }
+
+ProcArena::Scope::~Scope() { Current = Saved; }
+
+ProcArena::ProcArena() : Allocs(0), Frees(0) {}
+
+ProcArena::~ProcArena() {
+    for (const Slab &s : Slabs)
+        ::operator delete(s.begin);
+}
+
+ProcArena::Slab ProcArena::newSlab(size_t size) {
+    Slab s{(char *)::operator new(size), nullptr};
+    s.end = s.begin + size;
+    Slabs.push_back(s);
+    return s;
+}
+
+void *ProcArena::bump(size_t size) {
+    size = (size + ALIGN - 1) & ~(ALIGN - 1);
+    ++Allocs;
+    Bytes += size;
+    if (size > MAX_SMALL)
+        return newSlab(size).begin;
+    if (size > size_t(Limit - Next)) {
+        Slab s = newSlab(SLAB_SIZE);
+        Next = s.begin;
+        Limit = s.end;
+    }
+    void *res = Next;
+    Next += size;
+    return res;
+}
+
+void *ProcArena::allocate(size_t size) {
+    ProcArena *owner = Current;
+    char *block = (char *)(owner ? owner->bump(HEADER + size) : ::operator new(HEADER + size));
+    *(ProcArena **)block = owner;
+    return block + HEADER;
+}
+
+void ProcArena::deallocate(void *p) {
+    if (p == nullptr)
+        return;
+    char *block = (char *)p - HEADER;
+    if (ProcArena *owner = *(ProcArena **)block) {
+        ++owner->Frees; // Released with the rest of the arena
+        return;
+    }
+    ::operator delete(block);
+}
@@ -1508,33 +1508,39 @@ void BasicBlock::prependStmt(Instruction *s, UserProc *proc) {
 // Check for overlap of liveness between the currently live locations (liveLocs) and the set of locations in ls
 // Also check for type conflicts if DFA_TYPE_ANALYSIS
 // This is a helper function that is not directly declared in the BasicBlock class
-void checkForOverlap(LocationSet &liveLocs, LocationSet &ls, ConnectionGraph &ig, UserProc * /*proc*/) {
+void checkForOverlap(LocationBitSet &liveLocs, LocationSet &ls, LocationNumbering &nums, ConnectionGraph &ig,
+                     UserProc * /*proc*/) {
     // For each location to be considered
     for (Exp *u : ls) {
         if (!u->isSubscript())
             continue; // Only interested in subscripted vars
-        RefExp *r = (RefExp *)u;
+        int r = nums.number(u);
         // Interference if we can find a live variable which differs only in the reference
-        Exp *dr;
-        if (liveLocs.findDifferentRef(r, dr)) {
+        int dr;
+        if (liveLocs.findDifferentRef(nums, r, dr)) {
             // We have an interference between r and dr. Record it
-            ig.connect(r, dr);
+            // The graph keeps the pointers it is given (they can become symbol map keys), but the numbering
+            // deletes its own locations when it is cleared, so give the graph a copy
+            Exp *other = nums.location(dr);
+            ig.connect(u, ig.find(other) == -1 ? other->clone() : other);
             if (VERBOSE || DEBUG_LIVENESS)
-                LOG << "interference of " << dr << " with " << r << "\n";
+                LOG << "interference of " << nums.location(dr) << " with " << u << "\n";
         }
         // Add the uses one at a time. Note: don't use makeUnion, because then we don't discover interferences
         // from the same statement, e.g.  blah := r24{2} + r24{3}
-        liveLocs.insert(u);
+        liveLocs.insert(r);
     }
 }
 
 bool BasicBlock::calcLiveness(ConnectionGraph &ig, UserProc *myProc) {
+    LocationNumbering &nums = myProc->getCFG()->getLiveNumbering();
     // Start with the liveness at the bottom of the BB
-    LocationSet liveLocs, phiLocs;
-    getLiveOut(liveLocs, phiLocs);
+    LocationBitSet liveLocs;
+    LocationSet phiLocs;
+    getLiveOut(liveLocs, phiLocs, nums);
     // Do the livensses that result from phi statements at successors first.
     // FIXME: document why this is necessary
-    checkForOverlap(liveLocs, phiLocs, ig, myProc);
+    checkForOverlap(liveLocs, phiLocs, nums, ig, myProc);
     // For each RTL in this BB
     std::list<RTL *>::reverse_iterator rit;
     if (ListOfRTLs) // this can be nullptr
@@ -1563,7 +1569,11 @@ bool BasicBlock::calcLiveness(ConnectionGraph &ig, UserProc *myProc) {
                     checkForOverlap(liveLocs, defs, ig, myProc, false);
 #endif
                 // Definitions kill uses. Now we are moving to the "top" of statement s
-                liveLocs.makeDiff(defs);
+                for (Exp *d : defs) {
+                    int n = nums.find(d);
+                    if (n != -1)
+                        liveLocs.remove(n);
+                }
                 // Phi functions are a special case. The operands of phi functions are uses, but they don't interfere
                 // with each other (since they come via different BBs). However, we don't want to put these uses into
                 // liveLocs, because then the livenesses will flow to all predecessors. Only the appropriate livenesses
@@ -1573,14 +1583,17 @@ bool BasicBlock::calcLiveness(ConnectionGraph &ig, UserProc *myProc) {
                 // Check for livenesses that overlap
                 LocationSet uses;
                 s->addUsedLocs(uses);
-                checkForOverlap(liveLocs, uses, ig, myProc);
-                if (DEBUG_LIVENESS)
-                    LOG << " ## liveness: at top of " << s << ", liveLocs is " << liveLocs.prints() << "\n";
+                checkForOverlap(liveLocs, uses, nums, ig, myProc);
+                if (DEBUG_LIVENESS) {
+                    LocationSet live;
+                    liveLocs.toLocationSet(nums, live);
+                    LOG << " ## liveness: at top of " << s << ", liveLocs is " << live.prints() << "\n";
+                }
             }
         }
     // liveIn is what we calculated last time
-    if (!(liveLocs == LiveIn)) {
-        LiveIn = liveLocs;
+    if (!(liveLocs == LiveInBits)) {
+        LiveInBits = liveLocs;
         return true; // A change
     }
     // No change
@@ -1591,11 +1604,11 @@ bool BasicBlock::calcLiveness(ConnectionGraph &ig, UserProc *myProc) {
 // successors
 // liveout gets all the livenesses, and phiLocs gets a subset of these, which are due to phi statements at the top of
 // successors
-void BasicBlock::getLiveOut(LocationSet &liveout, LocationSet &phiLocs) {
+void BasicBlock::getLiveOut(LocationBitSet &liveout, LocationSet &phiLocs, LocationNumbering &nums) {
     liveout.clear();
     for (BasicBlock *currBB : OutEdges) {
         // First add the non-phi liveness
-        liveout.makeUnion(currBB->LiveIn); // add successor liveIn to this liveout set.
+        liveout.makeUnion(currBB->LiveInBits); // add successor liveIn to this liveout set.
         // The first RTL will have the phi functions, if any
         if (currBB->ListOfRTLs == nullptr || currBB->ListOfRTLs->size() == 0)
             continue;
@@ -1636,7 +1649,7 @@ void BasicBlock::getLiveOut(LocationSet &liveout, LocationSet &phiLocs) {
                 }
             }
             Exp *r = RefExp::get(pa->getLeft()->clone(), def);
-            liveout.insert(r);
+            liveout.insert(nums.number(r));
             phiLocs.insert(r);
             if (DEBUG_LIVENESS)
                 LOG << " ## Liveness: adding " << r << " due to ref to phi " << st << " in BB at " << getLowAddr()
@@ -1772,6 +1772,15 @@ void Cfg::findInterferences(ConnectionGraph &cg) {
     std::set<BasicBlock *> workSet;
     appendBBs(workList, workSet);
 
+    // The livenesses are calculated as bit vectors over a numbering of the locations, starting from the LiveIn sets
+    // left by an earlier calculation (if any)
+    liveNumbering.clear();
+    for (BasicBlock *bb : m_listBB) {
+        bb->LiveInBits.clear();
+        for (Exp *e : bb->LiveIn)
+            bb->LiveInBits.insert(liveNumbering.number(e));
+    }
+
     int count = 0;
     while (workList.size() && count < 100000) {
         count++; // prevent infinite loop
@@ -1803,6 +1812,11 @@ void Cfg::findInterferences(ConnectionGraph &cg) {
         }
         updateWorkListRev(currBB, workList, workSet);
     }
+    for (BasicBlock *bb : m_listBB) {
+        bb->LiveIn.clear();
+        bb->LiveInBits.toLocationSet(liveNumbering, bb->LiveIn);
+        bb->LiveInBits.clear();
+    }
 }
 
 void Cfg::appendBBs(std::list<BasicBlock *> &worklist, std::set<BasicBlock *> &workset) {
@@ -473,13 +473,14 @@ bool DataFlow::renameBlockVars(UserProc *proc, int n, bool clearStacks /* = fals
             bool suitable = canRename(a, proc);
             if (suitable) {
                 // Push i onto Stacks[a]
-                // Note: we clone a because otherwise it could be an expression that gets deleted through various
+                // Note: we copy a because otherwise it could be an expression that gets deleted through various
                 // modifications. This is necessary because we do several passes of this algorithm to sort out the
-                // memory expressions
+                // memory expressions. Where a can be shared (e.g. a register) the shared copy is used, so the keys
+                // are not cloned again for every pass and every proc
                 if(Stacks.find(a)!=Stacks.end()) // expression exists, no need for clone ?
                     Stacks[a].push_back(S);
                 else
-                    Stacks[a->clone()].push_back(S);
+                    Stacks[a->hashCons()].push_back(S);
                 // Replace definition of 'a' with definition of a_i in S (we don't do this)
             }
             // FIXME: MVE: do we need this awful hack?
@@ -488,7 +489,7 @@ bool DataFlow::renameBlockVars(UserProc *proc, int n, bool clearStacks /* = fals
                 assert(a1);
                 // Stacks already has a definition for a (as just the bare local)
                 if (suitable) {
-                    Stacks[a1->clone()].push_back(S);
+                    Stacks[a1->hashCons()].push_back(S);
                 }
             }
         }
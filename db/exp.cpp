@@ -12,6 +12,9 @@
 #include <map>       // In decideType()
 #include <sstream>   // Need gcc 3.0 or better
 #include <cstring>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 #include "types.h"
 #include "statement.h"
 #include "cfg.h"
@@ -181,6 +184,7 @@ void Unary::setSubExp1(Exp *e) {
     if (subExp1 != nullptr) {
         ; // delete subExp1;
     }
+    changing();
     subExp1 = e;
     assert(subExp1);
 }
@@ -188,6 +192,7 @@ void Binary::setSubExp2(Exp *e) {
     if (subExp2 != nullptr) {
         ; // delete subExp2;
     }
+    changing();
     subExp2 = e;
     assert(subExp1 && subExp2);
 }
@@ -195,6 +200,7 @@ void Ternary::setSubExp3(Exp *e) {
     if (subExp3 != nullptr) {
         ; // delete subExp3;
     }
+    changing();
     subExp3 = e;
     assert(subExp1 && subExp2 && subExp3);
 }
@@ -213,6 +219,7 @@ const Exp *Unary::getSubExp1() const {
 }
 Exp *&Unary::refSubExp1() {
     assert(subExp1);
+    simpGen = 0; // It can be changed through the reference
     return subExp1;
 }
 Exp *Binary::getSubExp2() {
@@ -225,6 +232,7 @@ const Exp *Binary::getSubExp2() const {
 }
 Exp *&Binary::refSubExp2() {
     assert(subExp1 && subExp2);
+    simpGen = 0; // It can be changed through the reference
     return subExp2;
 }
 Exp *Ternary::getSubExp3() {
@@ -237,6 +245,7 @@ const Exp *Ternary::getSubExp3() const {
 }
 Exp *&Ternary::refSubExp3() {
     assert(subExp1 && subExp2 && subExp3);
+    simpGen = 0; // It can be changed through the reference
     return subExp3;
 }
 
@@ -253,6 +262,7 @@ Exp *&Exp::refSubExp3() { return dummy; }
   ******************************************************************************/
 /// Swap the two subexpressions.
 void Binary::commute() {
+    changing();
     std::swap(subExp1,subExp2);
     assert(subExp1 && subExp2);
 }
@@ -436,76 +446,70 @@ bool TypeVal::operator==(const Exp &o) const {
     return *val == *((TypeVal &)o).val;
 }
 
+namespace {
+//! Three way comparison of two values that only have operator<
+template <class T> int threeWay(const T &a, const T &b) { return a < b ? -1 : (b < a ? 1 : 0); }
+//! As Exp::compare, but an expression shared by both sides is equal without being walked
+inline int compareSub(const Exp *a, const Exp *b) { return a == b ? 0 : a->compare(*b); }
+}
+
 /***************************************************************************/ /**
   *
-  * \brief        Virtual function to compare myself with another Exp
-  * \note            The test for a wildcard is only with this object, not the other object (o).
-  *                    So when searching and there could be wildcards, use search == *this not *this == search
+  * \brief        Virtual function to order myself with respect to another Exp. Each subexpression is compared once:
+  *               operator< used to compare a subexpression both ways before going on to the next one, which is
+  *               exponential in the depth of the expressions
   * \param        o - Ref to other Exp
-  * \returns            True if equal
+  * \returns      Negative if this is less than o, zero if neither is less than the other, positive otherwise
   ******************************************************************************/
-bool Const::operator<(const Exp &o) const {
-    if (op < o.getOper())
-        return true;
-    if (op > o.getOper())
-        return false;
+int Const::compare(const Exp &o) const {
+    if (op != o.getOper())
+        return op < o.getOper() ? -1 : 1;
+    const Const &c = (const Const &)o;
     if (conscript) {
-        if (conscript < ((Const &)o).conscript)
-            return true;
-        if (conscript > ((Const &)o).conscript)
-            return false;
-    } else if (((Const &)o).conscript)
-        return true;
+        if (conscript != c.conscript)
+            return conscript < c.conscript ? -1 : 1;
+    } else if (c.conscript)
+        return -1;
     switch (op) {
     case opIntConst:
-        return u.i < ((Const &)o).u.i;
+        return threeWay(u.i, c.u.i);
     case opFltConst:
-        return u.d < ((Const &)o).u.d;
+        return threeWay(u.d, c.u.d);
     case opStrConst:
-        return strin < ((Const &)o).strin;
+        return threeWay(strin, c.strin);
     default:
         LOG << "Operator< invalid operator " << operStrings[op] << "\n";
         assert(0);
     }
-    return false;
+    return 0;
 }
-bool Terminal::operator<(const Exp &o) const { return (op < o.getOper()); }
+int Terminal::compare(const Exp &o) const { return threeWay(op, o.getOper()); }
 
-bool Unary::operator<(const Exp &o) const {
-    if (op < o.getOper())
-        return true;
-    if (op > o.getOper())
-        return false;
-    return *subExp1 < *((Unary &)o).getSubExp1();
+int Unary::compare(const Exp &o) const {
+    if (op != o.getOper())
+        return op < o.getOper() ? -1 : 1;
+    return compareSub(subExp1, ((const Unary &)o).subExp1);
 }
 
-bool Binary::operator<(const Exp &o) const {
+int Binary::compare(const Exp &o) const {
     assert(subExp1 && subExp2);
-    if (op < o.getOper())
-        return true;
-    if (op > o.getOper())
-        return false;
-    if (*subExp1 < *((Binary &)o).getSubExp1())
-        return true;
-    if (*((Binary &)o).getSubExp1() < *subExp1)
-        return false;
-    return *subExp2 < *((Binary &)o).getSubExp2();
+    if (op != o.getOper())
+        return op < o.getOper() ? -1 : 1;
+    const Binary &b = (const Binary &)o;
+    if (int c = compareSub(subExp1, b.subExp1))
+        return c;
+    return compareSub(subExp2, b.subExp2);
 }
 
-bool Ternary::operator<(const Exp &o) const {
-    if (op < o.getOper())
-        return true;
-    if (op > o.getOper())
-        return false;
-    if (*subExp1 < *((Ternary &)o).getSubExp1())
-        return true;
-    if (*((Ternary &)o).getSubExp1() < *subExp1)
-        return false;
-    if (*subExp2 < *((Ternary &)o).getSubExp2())
-        return true;
-    if (*((Ternary &)o).getSubExp2() < *subExp2)
-        return false;
-    return *subExp3 < *((Ternary &)o).getSubExp3();
+int Ternary::compare(const Exp &o) const {
+    if (op != o.getOper())
+        return op < o.getOper() ? -1 : 1;
+    const Ternary &t = (const Ternary &)o;
+    if (int c = compareSub(subExp1, t.subExp1))
+        return c;
+    if (int c = compareSub(subExp2, t.subExp2))
+        return c;
+    return compareSub(subExp3, t.subExp3);
 }
 
 bool TypedExp::operator<<(const Exp &o) const { // Type insensitive
@@ -516,41 +520,141 @@ bool TypedExp::operator<<(const Exp &o) const { // Type insensitive
     return *subExp1 << *((Unary &)o).getSubExp1();
 }
 
-bool TypedExp::operator<(const Exp &o) const { // Type sensitive
-    if (op < o.getOper())
-        return true;
-    if (op > o.getOper())
-        return false;
-    if (*type < *((TypedExp &)o).type)
-        return true;
-    if (*((TypedExp &)o).type < *type)
-        return false;
-    return *subExp1 < *((Unary &)o).getSubExp1();
+int TypedExp::compare(const Exp &o) const { // Type sensitive
+    if (op != o.getOper())
+        return op < o.getOper() ? -1 : 1;
+    const TypedExp &t = (const TypedExp &)o;
+    if (int c = threeWay(*type, *t.type))
+        return c;
+    return compareSub(subExp1, t.subExp1);
+}
+
+int RefExp::compare(const Exp &o) const {
+    if (opSubscript != o.getOper())
+        return opSubscript < o.getOper() ? -1 : 1;
+    if (int c = compareSub(subExp1, ((const Unary &)o).getSubExp1()))
+        return c;
+    // Allow a wildcard def to match any
+    Instruction *odef = ((const RefExp &)o).def;
+    if (def == (Instruction *)-1 || odef == (Instruction *)-1)
+        return 0; // Equal
+    return threeWay(def, odef);
 }
 
-bool RefExp::operator<(const Exp &o) const {
-    if (opSubscript < o.getOper())
-        return true;
-    if (opSubscript > o.getOper())
-        return false;
-    if (*subExp1 < *((Unary &)o).getSubExp1())
-        return true;
-    if (*((Unary &)o).getSubExp1() < *subExp1)
-        return false;
-    // Allow a wildcard def to match any
-    if (def == (Instruction *)-1)
-        return false; // Not less (equal)
-    if (((RefExp &)o).def == (Instruction *)-1)
-        return false;
-    return def < ((RefExp &)o).def;
+int TypeVal::compare(const Exp &o) const {
+    if (opTypeVal != o.getOper())
+        return opTypeVal < o.getOper() ? -1 : 1;
+    return threeWay(*val, *((const TypeVal &)o).val);
 }
 
-bool TypeVal::operator<(const Exp &o) const {
-    if (opTypeVal < o.getOper())
-        return true;
-    if (opTypeVal > o.getOper())
+namespace {
+std::mutex consMutex;                            // Guards consTable
+std::unordered_multimap<uint32_t, Exp *> consTable; // Shared expressions, by their hash
+
+inline uint32_t mixHash(uint32_t h, uint32_t v) { return (h ^ v) * 0x01000193; } // One step of FNV-1a
+
+//! True if e has a shape that hashCons() can share
+bool canHashCons(const Exp *e) {
+    switch (e->getOper()) {
+    case opIntConst:
+    case opFltConst:
+    case opStrConst:
+        return ((const Const *)e)->getConscript() == 0;
+    case opRegOf:
+    case opMemOf: {
+        const Location *l = dynamic_cast<const Location *>(e);
+        return (l == nullptr || l->getProc() == nullptr) && canHashCons(e->getSubExp1());
+    }
+    case opPlus:
+    case opMinus:
+        return canHashCons(e->getSubExp1()) && canHashCons(e->getSubExp2());
+    case opSubscript:
+        return ((const RefExp *)e)->getDef() != (Instruction *)-1 && canHashCons(e->getSubExp1());
+    case opWild:
+    case opWildIntConst:
+    case opWildStrConst:
+    case opWildMemOf:
+    case opWildRegOf:
+    case opWildAddrOf:
+    case opTypeVal:
         return false;
-    return *val < *((TypeVal &)o).val;
+    default:
+        return e->getArity() == 0 && dynamic_cast<const Const *>(e) == nullptr; // Other terminals, e.g. %pc
+    }
+}
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief        Find or make the shared copy of this expression. Expressions are modified in place all over, so
+  *               only a few shapes are shared, and only on request: constants without conscripts, terminals,
+  *               registers and memory locations not tied to a proc, sums and differences of those, and their
+  *               subscripts (but not with the wildcard definition). Subexpressions are shared first, so the hash of
+  *               a shared expression is calculated from the hashes cached in its (shared) subexpressions.
+  * \returns      The shared copy, or a clone if this expression can't be shared
+  ******************************************************************************/
+Exp *Exp::hashCons() const {
+    if (isHashConsed())
+        return const_cast<Exp *>(this);
+    if (!canHashCons(this))
+        return clone();
+    Exp *sub1 = getArity() > 0 ? getSubExp1()->hashCons() : nullptr;
+    Exp *sub2 = getArity() > 1 ? getSubExp2()->hashCons() : nullptr;
+    uint32_t h = mixHash(0x811C9DC5, op);
+    if (sub1)
+        h = mixHash(h, sub1->consHash.value);
+    if (sub2)
+        h = mixHash(h, sub2->consHash.value);
+    switch (op) {
+    case opIntConst:
+        h = mixHash(h, ((const Const *)this)->getInt());
+        break;
+    case opFltConst: {
+        double d = ((const Const *)this)->getFlt();
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        h = mixHash(mixHash(h, uint32_t(bits)), uint32_t(bits >> 32));
+        break;
+    }
+    case opStrConst:
+        h = mixHash(h, qHash(((const Const *)this)->getStr()));
+        break;
+    case opSubscript:
+        h = mixHash(h, qHash((quintptr)((const RefExp *)this)->getDef()));
+        break;
+    default:
+        break;
+    }
+    h |= 1; // Zero means not shared
+
+    std::lock_guard<std::mutex> guard(consMutex);
+    ProcArena::Scope heap(nullptr); // Shared expressions outlive any one proc
+    auto range = consTable.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it)
+        if (it->second->compare(*this) == 0)
+            return it->second;
+    Exp *res;
+    switch (op) {
+    case opRegOf:
+    case opMemOf:
+        res = new Location(op, sub1, nullptr);
+        break;
+    case opPlus:
+    case opMinus:
+        res = new Binary(op, sub1, sub2);
+        break;
+    case opSubscript:
+        res = new RefExp(sub1, ((const RefExp *)this)->getDef());
+        break;
+    default:
+        res = clone();
+        if (res->isIntConst() || res->isFltConst() || res->isStrConst())
+            ((Const *)res)->setType(nullptr); // Constants shared between contexts don't carry a type
+        break;
+    }
+    res->consHash.value = h;
+    consTable.emplace(h, res);
+    return res;
 }
 
 /***************************************************************************/ /**
@@ -1915,24 +2019,30 @@ void Exp::doSearchChildren(const Exp & search, std::list<Exp **> & li, bool once
     return; // Const and Terminal do not override this
 }
 void Unary::doSearchChildren(const Exp &search, std::list<Exp **> &li, bool once) {
+    size_t found = li.size();
     if (op != opInitValueOf) // don't search child
         doSearch(search, subExp1, li, once);
+    if (li.size() != found)
+        simpGen = 0; // The matches may be replaced through li
 }
 void Binary::doSearchChildren(const Exp &search, std::list<Exp **> &li, bool once) {
     assert(subExp1 && subExp2);
+    size_t found = li.size();
     doSearch(search, subExp1, li, once);
-    if (once && li.size())
-        return;
-    doSearch(search, subExp2, li, once);
+    if (!once || li.empty())
+        doSearch(search, subExp2, li, once);
+    if (li.size() != found)
+        simpGen = 0; // The matches may be replaced through li
 }
 void Ternary::doSearchChildren(const Exp &search, std::list<Exp **> &li, bool once) {
+    size_t found = li.size();
     doSearch(search, subExp1, li, once);
-    if (once && li.size())
-        return;
-    doSearch(search, subExp2, li, once);
-    if (once && li.size())
-        return;
-    doSearch(search, subExp3, li, once);
+    if (!once || li.empty())
+        doSearch(search, subExp2, li, once);
+    if (!once || li.empty())
+        doSearch(search, subExp3, li, once);
+    if (li.size() != found)
+        simpGen = 0; // The matches may be replaced through li
 }
 
 /***************************************************************************/ /**
@@ -2103,22 +2213,22 @@ void Exp::partitionTerms(std::list<Exp *> &positives, std::list<Exp *> &negative
 Exp *Unary::simplifyArith() {
     if (op == opMemOf || op == opRegOf || op == opAddrOf || op == opSubscript) {
         // assume we want to simplify the subexpression
-        subExp1 = subExp1->simplifyArith();
+        setChild(subExp1, subExp1->simplifyArith());
     }
     return this; // Else, do nothing
 }
 
 Exp *Ternary::simplifyArith() {
-    subExp1 = subExp1->simplifyArith();
-    subExp2 = subExp2->simplifyArith();
-    subExp3 = subExp3->simplifyArith();
+    setChild(subExp1, subExp1->simplifyArith());
+    setChild(subExp2, subExp2->simplifyArith());
+    setChild(subExp3, subExp3->simplifyArith());
     return this;
 }
 
 Exp *Binary::simplifyArith() {
     assert(subExp1 && subExp2);
-    subExp1 = subExp1->simplifyArith(); // FIXME: does this make sense?
-    subExp2 = subExp2->simplifyArith(); // FIXME: ditto
+    setChild(subExp1, subExp1->simplifyArith()); // FIXME: does this make sense?
+    setChild(subExp2, subExp2->simplifyArith()); // FIXME: ditto
     if ((op != opPlus) && (op != opMinus))
         return this;
 
@@ -2216,6 +2326,57 @@ Exp *Exp::Accumulate(std::list<Exp *> exprs) {
     return res;
 }
 
+namespace {
+// Each call of simplify() that does any work starts a new generation; see Exp::simpGen
+std::atomic<uint64_t> simplifyGeneration(0);
+}
+
+void Exp::setSimplified(uint64_t gen) {
+    if (isHashConsed())
+        return; // Shared, so never written
+    Exp *subs[] = {getSubExp1(), getSubExp2(), getSubExp3()};
+    for (Exp *sub : subs)
+        if (sub)
+            sub->setSimplified(gen);
+    // Keeping an earlier stamp lets other expressions that share this part still see it as unchanged
+    if (!shallowSimplified())
+        simpGen = gen;
+}
+
+bool Exp::shallowSimplified() const {
+    if (simpGen == 0)
+        return false;
+    // A subexpression that was changed, or simplified again on its own, since this was simplified may no longer be
+    // in normal form as part of this
+    const Exp *subs[] = {getSubExp1(), getSubExp2(), getSubExp3()};
+    for (const Exp *sub : subs)
+        if (sub && !childUnchanged(sub))
+            return false;
+    return true;
+}
+
+bool Exp::isSimplified() const {
+    if (!shallowSimplified())
+        return false;
+    // Something may have been changed in place further down, through a pointer to a part of this kept from before
+    const Exp *subs[] = {getSubExp1(), getSubExp2(), getSubExp3()};
+    for (const Exp *sub : subs)
+        if (sub && !sub->isHashConsed() && !sub->isSimplified())
+            return false;
+    return true;
+}
+
+bool Exp::clearStaleStamps() {
+    bool simplified = shallowSimplified();
+    Exp *subs[] = {getSubExp1(), getSubExp2(), getSubExp3()};
+    for (Exp *sub : subs)
+        if (sub && !sub->isHashConsed() && !sub->clearStaleStamps())
+            simplified = false;
+    if (!simplified && simpGen != 0)
+        simpGen = 0; // Never true of a hash consed expression, which is never written
+    return simplified;
+}
+
     /***************************************************************************/ /**
       *
       * \brief        Apply various simplifications such as constant folding. Also canonicalise by putting iteger
@@ -2233,6 +2394,9 @@ Exp *Exp::Accumulate(std::list<Exp *> exprs) {
       ******************************************************************************/
 #define DEBUG_SIMP 0                                                              // Set to 1 to print every change
 Exp *Exp::simplify() {
+    // The one walk over the whole expression: after it, polySimplify() can trust each part's own stamp
+    if (clearStaleStamps())
+        return this; // Already in normal form
 #if DEBUG_SIMP
     Exp *save = clone();
 #endif
@@ -2254,6 +2418,8 @@ Exp *Exp::simplify() {
 // The below is still important. E.g. want to canonicalise sums, so we know that a + K + b is the same as a + b + K
 // No! This slows everything down, and it's slow enough as it is. Call only where needed:
 // res = res->simplifyArith();
+    // Remember that the result is in normal form, so that it is skipped until part of it changes
+    res->setSimplified(++simplifyGeneration);
 #if DEBUG_SIMP
     if (!(*res == *save))
         std::cout << "simplified " << save << "  to  " << res << "\n";
@@ -2270,6 +2436,9 @@ Exp *Exp::simplify() {
   * \returns            Ptr to the simplified expression
   ******************************************************************************/
 Exp *Unary::polySimplify(bool &bMod) {
+    if (shallowSimplified())
+        return this; // Nothing has changed since it was last simplified
+    simpGen = 0;
     Exp *res = this;
     subExp1 = subExp1->polySimplify(bMod);
 
@@ -2426,6 +2595,9 @@ Exp * convertFromOffsetToCompound(Exp *parent,std::shared_ptr<CompoundType> &c,i
 }
 Exp *Binary::polySimplify(bool &bMod) {
     assert(subExp1 && subExp2);
+    if (shallowSimplified())
+        return this; // Nothing has changed since it was last simplified
+    simpGen = 0;
 
     Exp *res = this;
 
@@ -3111,6 +3283,9 @@ Exp *Binary::polySimplify(bool &bMod) {
 }
 
 Exp *Ternary::polySimplify(bool &bMod) {
+    if (shallowSimplified())
+        return this; // Nothing has changed since it was last simplified
+    simpGen = 0;
     Exp *res = this;
 
     subExp1 = subExp1->polySimplify(bMod);
@@ -3228,6 +3403,9 @@ Exp *Ternary::polySimplify(bool &bMod) {
 }
 
 Exp *TypedExp::polySimplify(bool &bMod) {
+    if (shallowSimplified())
+        return this; // Nothing has changed since it was last simplified
+    simpGen = 0;
     Exp *res = this;
 
     if (subExp1->getOper() == opRegOf) {
@@ -3242,6 +3420,9 @@ Exp *TypedExp::polySimplify(bool &bMod) {
 }
 
 Exp *RefExp::polySimplify(bool &bMod) {
+    if (shallowSimplified())
+        return this; // Nothing has changed since it was last simplified
+    simpGen = 0;
     Exp *res = this;
 
     Exp *tmp = subExp1->polySimplify(bMod);
@@ -3289,7 +3470,7 @@ Exp *Unary::simplifyAddr() {
     }
     if (op != opAddrOf) {
         // Not a[ anything ]. Recurse
-        subExp1 = subExp1->simplifyAddr();
+        setChild(subExp1, subExp1->simplifyAddr());
         return this;
     }
     if (subExp1->getOper() == opMemOf) {
@@ -3309,22 +3490,22 @@ Exp *Unary::simplifyAddr() {
     }
 
     // a[ something else ]. Still recurse, just in case
-    subExp1 = subExp1->simplifyAddr();
+    setChild(subExp1, subExp1->simplifyAddr());
     return this;
 }
 
 Exp *Binary::simplifyAddr() {
     assert(subExp1 && subExp2);
 
-    subExp1 = subExp1->simplifyAddr();
-    subExp2 = subExp2->simplifyAddr();
+    setChild(subExp1, subExp1->simplifyAddr());
+    setChild(subExp2, subExp2->simplifyAddr());
     return this;
 }
 
 Exp *Ternary::simplifyAddr() {
-    subExp1 = subExp1->simplifyAddr();
-    subExp2 = subExp2->simplifyAddr();
-    subExp3 = subExp3->simplifyAddr();
+    setChild(subExp1, subExp1->simplifyAddr());
+    setChild(subExp2, subExp2->simplifyAddr());
+    setChild(subExp3, subExp3->simplifyAddr());
     return this;
 }
 
@@ -3441,12 +3622,14 @@ Exp *Exp::fixSuccessor() {
   * \returns            Fixed expression
   ******************************************************************************/
 Exp *Exp::killFill() {
-    static Ternary srch1(opZfill, new Terminal(opWild), new Terminal(opWild), new Terminal(opWild));
-    static Ternary srch2(opSgnEx, new Terminal(opWild), new Terminal(opWild), new Terminal(opWild));
+    static Ternary *srch1 = ProcArena::onHeap(
+        [] { return new Ternary(opZfill, new Terminal(opWild), new Terminal(opWild), new Terminal(opWild)); });
+    static Ternary *srch2 = ProcArena::onHeap(
+        [] { return new Ternary(opSgnEx, new Terminal(opWild), new Terminal(opWild), new Terminal(opWild)); });
     Exp *res = this;
     std::list<Exp **> result;
-    doSearch(srch1, res, result, false);
-    doSearch(srch2, res, result, false);
+    doSearch(*srch1, res, result, false);
+    doSearch(*srch2, res, result, false);
     std::list<Exp **>::iterator it;
     for (it = result.begin(); it != result.end(); it++) {
         // Kill the sign extend bits
@@ -3496,10 +3679,10 @@ Exp *Exp::fromSSAleft(UserProc *proc, Instruction *d) {
 
 // A helper class for comparing Exp*'s sensibly
 bool lessExpStar::operator()(const Exp *x, const Exp *y) const {
-    return (*x < *y); // Compare the actual Exps
+    return x != y && x->compare(*y) < 0; // Compare the actual Exps, unless they are the same one
 }
 bool lessExpShared::operator()(const std::shared_ptr<Exp> &x, const std::shared_ptr<Exp> &y) const {
-    return (*x < *y); // Compare the actual Exps
+    return x != y && x->compare(*y) < 0; // Compare the actual Exps, unless they are the same one
 }
 
 bool lessTI::operator()(const Exp *x, const Exp *y) const {
@@ -3839,6 +4022,8 @@ Exp *Binary::genConstraints(Exp *result) {
 }
 
 Exp *Location::polySimplify(bool &bMod) {
+    if (shallowSimplified())
+        return this; // Nothing has changed since it was last simplified
     Exp *res = Unary::polySimplify(bMod);
 
     if (res->getOper() == opMemOf && res->getSubExp1()->getOper() == opAddrOf) {
@@ -3871,15 +4056,15 @@ void Location::getDefinitions(LocationSet &defs) {
 QString Const::getFuncName() const { return u.pp->getName(); }
 
 Exp *Unary::simplifyConstraint() {
-    subExp1 = subExp1->simplifyConstraint();
+    setChild(subExp1, subExp1->simplifyConstraint());
     return this;
 }
 
 Exp *Binary::simplifyConstraint() {
     assert(subExp1 && subExp2);
 
-    subExp1 = subExp1->simplifyConstraint();
-    subExp2 = subExp2->simplifyConstraint();
+    setChild(subExp1, subExp1->simplifyConstraint());
+    setChild(subExp2, subExp2->simplifyConstraint());
     switch (op) {
     case opEquals: {
         if (subExp1->isTypeVal() && subExp2->isTypeVal()) {
@@ -4024,7 +4209,7 @@ Exp *Unary::accept(ExpModifier *v) {
     bool recur;
     Unary *ret = (Unary *)v->preVisit(this, recur);
     if (recur)
-        subExp1 = subExp1->accept(v);
+        setChild(subExp1, subExp1->accept(v));
     return v->postVisit(ret);
 }
 Exp *Binary::accept(ExpModifier *v) {
@@ -4033,9 +4218,9 @@ Exp *Binary::accept(ExpModifier *v) {
     bool recur;
     Exp *ret = v->preVisit(this, recur);
     if (recur)
-        subExp1 = subExp1->accept(v);
+        setChild(subExp1, subExp1->accept(v));
     if (recur)
-        subExp2 = subExp2->accept(v);
+        setChild(subExp2, subExp2->accept(v));
     Binary *bret = dynamic_cast<Binary *>(ret);
     Unary *uret = dynamic_cast<Unary *>(ret);
     if(bret)
@@ -4049,11 +4234,11 @@ Exp *Ternary::accept(ExpModifier *v) {
     bool recur;
     Ternary *ret = (Ternary *)v->preVisit(this, recur);
     if (recur)
-        subExp1 = subExp1->accept(v);
+        setChild(subExp1, subExp1->accept(v));
     if (recur)
-        subExp2 = subExp2->accept(v);
+        setChild(subExp2, subExp2->accept(v));
     if (recur)
-        subExp3 = subExp3->accept(v);
+        setChild(subExp3, subExp3->accept(v));
     return v->postVisit(ret);
 }
 
@@ -4063,7 +4248,7 @@ Exp *Location::accept(ExpModifier *v) {
     bool recur;
     Exp *ret = v->preVisit(this, recur);
     if (recur)
-        subExp1 = subExp1->accept(v);
+        setChild(subExp1, subExp1->accept(v));
     Location * loc_ret = dynamic_cast<Location *>(ret);
     if(loc_ret)
         return v->postVisit(loc_ret);
@@ -4078,7 +4263,7 @@ Exp *RefExp::accept(ExpModifier *v) {
     bool recur;
     RefExp *ret = (RefExp *)v->preVisit(this, recur);
     if (recur)
-        subExp1 = subExp1->accept(v);
+        setChild(subExp1, subExp1->accept(v));
     return v->postVisit(ret);
 }
 
@@ -4086,7 +4271,7 @@ Exp *FlagDef::accept(ExpModifier *v) {
     bool recur;
     FlagDef *ret = (FlagDef *)v->preVisit(this, recur);
     if (recur)
-        subExp1 = subExp1->accept(v);
+        setChild(subExp1, subExp1->accept(v));
     return v->postVisit(ret);
 }
 
@@ -4094,7 +4279,7 @@ Exp *TypedExp::accept(ExpModifier *v) {
     bool recur;
     TypedExp *ret = (TypedExp *)v->preVisit(this, recur);
     if (recur)
-        subExp1 = subExp1->accept(v);
+        setChild(subExp1, subExp1->accept(v));
     return v->postVisit(ret);
 }
 
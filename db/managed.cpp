@@ -14,6 +14,8 @@
 
 #include <sstream>
 #include <cstring>
+#include <algorithm>
+#include <bitset>
 
 #include "types.h"
 #include "managed.h"
@@ -690,99 +692,247 @@ void LocationSet::diff(LocationSet *o) {
         LOG_STREAM() << "\n";
 }
 
-//    class ConnectionGraph
+//
+// LocationNumbering methods
+//
 
-void ConnectionGraph::add(Exp *a, Exp *b) {
-    iterator ff = emap.find(a);
-    while (ff != emap.end() && *ff->first == *a) {
-        if (*ff->second == *b)
-            return; // Don't add a second entry
-        ++ff;
+int LocationNumbering::number(Exp *loc) {
+    auto ff = numbers.find(loc);
+    if (ff != numbers.end())
+        return ff->second;
+    int base = -1;
+    if (loc->isSubscript()) {
+        assert(((RefExp *)loc)->getDef() != (Instruction *)-1); // A wildcard would be equal to all the other refs
+        base = number(loc->getSubExp1());
+    }
+    int n = (int)locations.size();
+    Exp *copy = loc->clone();
+    numbers[copy] = n;
+    locations.push_back(copy);
+    bases.push_back(base);
+    refsOf.emplace_back();
+    if (base != -1) {
+        std::vector<int> &refs = refsOf[base];
+        lessExpStar less;
+        refs.insert(std::upper_bound(refs.begin(), refs.end(), n,
+                                     [&](int a, int b) { return less(locations[a], locations[b]); }),
+                    n);
     }
-    std::pair<Exp *, Exp *> pr;
-    pr.first = a;
-    pr.second = b;
-    emap.insert(pr);
+    return n;
 }
 
-std::vector<Exp *> ConnectionGraph::allConnected(Exp *a) {
-    std::vector<Exp *> res;
-    const_iterator ff = emap.find(a);
-    while (ff != emap.end() && *ff->first == *a) {
-        res.push_back(ff->second);
-        ++ff;
-    }
+int LocationNumbering::find(Exp *loc) const {
+    auto ff = numbers.find(loc);
+    return ff == numbers.end() ? -1 : ff->second;
+}
+
+//! Delete a location cloned by number(); a clone shares no subexpressions, but Exp destructors leave them alone
+static void deleteClone(Exp *e) {
+    Exp *subs[] = {e->getSubExp1(), e->getSubExp2(), e->getSubExp3()};
+    for (Exp *sub : subs)
+        if (sub)
+            deleteClone(sub);
+    delete e;
+}
+
+void LocationNumbering::clear() {
+    for (Exp *loc : locations)
+        deleteClone(loc);
+    numbers.clear();
+    locations.clear();
+    bases.clear();
+    refsOf.clear();
+}
+
+//
+// LocationBitSet methods
+//
+
+int LocationBitSet::lowestBit(uint64_t w) { return (int)std::bitset<64>((w & (~w + 1)) - 1).count(); }
+
+void LocationBitSet::makeUnion(const LocationBitSet &other) {
+    if (other.words.size() > words.size())
+        words.resize(other.words.size());
+    for (size_t i = 0; i < other.words.size(); ++i)
+        words[i] |= other.words[i];
+}
+
+void LocationBitSet::makeDiff(const LocationBitSet &other) {
+    for (size_t i = 0; i < words.size() && i < other.words.size(); ++i)
+        words[i] &= ~other.words[i];
+}
+
+void LocationBitSet::makeIsect(const LocationBitSet &other) {
+    if (words.size() > other.words.size())
+        words.resize(other.words.size());
+    for (size_t i = 0; i < words.size(); ++i)
+        words[i] &= other.words[i];
+}
+
+bool LocationBitSet::isSubSetOf(const LocationBitSet &other) const {
+    for (size_t i = 0; i < words.size(); ++i)
+        if (words[i] & ~(i < other.words.size() ? other.words[i] : 0))
+            return false;
+    return true;
+}
+
+bool LocationBitSet::operator==(const LocationBitSet &o) const {
+    const std::vector<uint64_t> &shorter = words.size() < o.words.size() ? words : o.words;
+    const std::vector<uint64_t> &longer = words.size() < o.words.size() ? o.words : words;
+    if (!std::equal(shorter.begin(), shorter.end(), longer.begin()))
+        return false;
+    // Trailing zero words don't matter
+    return std::all_of(longer.begin() + shorter.size(), longer.end(), [](uint64_t w) { return w == 0; });
+}
+
+size_t LocationBitSet::size() const {
+    size_t res = 0;
+    for (uint64_t w : words)
+        res += std::bitset<64>(w).count();
     return res;
 }
+
+void LocationBitSet::toLocationSet(const LocationNumbering &nums, LocationSet &ls) const {
+    forEach([&](int n) { ls.insert(nums.location(n)->clone()); });
+}
+
+bool LocationBitSet::findDifferentRef(const LocationNumbering &nums, int e, int &dr) const {
+    int base = nums.baseOf(e);
+    if (base == -1)
+        return false;
+    for (int r : nums.refsOfBase(base)) {
+        // As in LocationSet, refs that are equal (e.g. x{-} and x{0}) are not different
+        if (r != e && exists(r) && !(*nums.location(r) == *nums.location(e))) {
+            dr = r;
+            return true;
+        }
+    }
+    return false;
+}
+
+//    class ConnectionGraph
+
+int ConnectionGraph::find(const Exp *e) const {
+    auto ff = index.find(const_cast<Exp *>(e));
+    return ff == index.end() ? -1 : ff->second;
+}
+
+int ConnectionGraph::number(Exp *e) {
+    auto ff = index.find(e);
+    if (ff != index.end())
+        return ff->second;
+    int n = (int)vars.size();
+    index[e] = n;
+    vars.push_back(e);
+    adj.emplace_back();
+    // Adding row n keeps the earlier rows where they are
+    size_t numBits = size_t(n + 1) * (n + 2);
+    matrix.resize((numBits + 63) / 64);
+    return n;
+}
+
+//! Bit for the connection from -> to: element (max, min) of the matrix, first bit if from is the larger number
+size_t ConnectionGraph::bitOf(int from, int to) const {
+    size_t hi = std::max(from, to), lo = std::min(from, to);
+    return 2 * (hi * (hi + 1) / 2 + lo) + (size_t(from) == hi ? 0 : 1);
+}
+
+void ConnectionGraph::addEdge(int from, int to) {
+    size_t bit = bitOf(from, to);
+    uint64_t mask = uint64_t(1) << (bit % 64);
+    if (matrix[bit / 64] & mask)
+        return; // Don't add a second entry
+    matrix[bit / 64] |= mask;
+    adj[from].push_back(to);
+}
+
+void ConnectionGraph::add(Exp *a, Exp *b) {
+    int na = number(a);
+    addEdge(na, number(b));
+}
+
 void ConnectionGraph::connect(Exp *a, Exp *b) {
     // if a is connected to c,d and e, 'b' should also be connected to c,d and e
-    std::vector<Exp *> a_connections = allConnected(a);
-    std::vector<Exp *> b_connections = allConnected(b);
-    add(a, b);
-    for(Exp * e : b_connections) {
-        add(a,e);
-    }
-    add(b, a);
-    for(Exp * e : a_connections) {
-        add(e,b);
-    }
+    int na = number(a), nb = number(b);
+    std::vector<int> a_connections = allConnected(na);
+    std::vector<int> b_connections = allConnected(nb);
+    addEdge(na, nb);
+    for (int e : b_connections)
+        addEdge(na, e);
+    addEdge(nb, na);
+    for (int e : a_connections)
+        addEdge(e, nb);
 }
+
 //! Return a count of locations connected to \a e
 int ConnectionGraph::count(Exp *e) const {
-    const_iterator ff = emap.find(e);
-    int n = 0;
-    while (ff != emap.end() && *ff->first == *e) {
-        ++n;
-        ++ff;
-    }
-    return n;
+    int n = find(e);
+    return n == -1 ? 0 : (int)adj[n].size();
 }
+
 //! Return true if a is connected to b
 bool ConnectionGraph::isConnected(Exp *a, const Exp &b) const {
-    const_iterator ff = emap.find(a);
-    while (ff != emap.end() && *ff->first == *a) {
-        if (*ff->second == b)
-            return true; // Found the connection
-        ++ff;
-    }
-    return false;
+    int na = find(a), nb = find(&b);
+    return na != -1 && nb != -1 && hasEdge(na, nb);
 }
 
 // Modify the map so that a <-> b becomes a <-> c
 //! Update the map that used to be a <-> b, now it is a <-> c
 void ConnectionGraph::update(Exp *a, Exp *b, Exp *c) {
-    // find a->b
-    iterator ff = emap.find(a);
-    while (ff != emap.end() && *ff->first == *a) {
-        if (*ff->second == *b) {
-            ff->second = c; // Now a->c
-            break;
-        }
-        ++ff;
-    }
-    // find b -> a
-    ff = emap.find(b);
-    while (ff != emap.end() && *ff->first == *b) {
-        if (*ff->second == *a) {
-            emap.erase(ff);
-            add(c, a); // Now c->a
-            break;
+    int na = find(a), nb = find(b);
+    if (na == -1 || nb == -1)
+        return;
+    int nc = number(c);
+    // a -> b becomes a -> c, in the same place
+    if (hasEdge(na, nb)) {
+        size_t bit = bitOf(na, nb);
+        matrix[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+        std::vector<int> &as = adj[na];
+        auto ab = std::find(as.begin(), as.end(), nb);
+        if (hasEdge(na, nc))
+            as.erase(ab);
+        else {
+            *ab = nc;
+            bit = bitOf(na, nc);
+            matrix[bit / 64] |= uint64_t(1) << (bit % 64);
         }
-        ++ff;
     }
+    // b -> a is removed, and c -> a added
+    if (hasEdge(nb, na)) {
+        size_t bit = bitOf(nb, na);
+        matrix[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+        std::vector<int> &bs = adj[nb];
+        bs.erase(std::find(bs.begin(), bs.end(), na));
+        addEdge(nc, na);
+    }
+}
+
+void ConnectionGraph::clear() {
+    index.clear();
+    vars.clear();
+    adj.clear();
+    matrix.clear();
+}
+
+ConnectionGraph::const_iterator::const_iterator(const ConnectionGraph *g,
+                                                std::map<Exp *, int, lessExpStar>::const_iterator v)
+    : graph(g), var(v), pos(0) {
+    settle();
 }
 
-// Remove the mapping at *aa, and return a valid iterator for looping
-ConnectionGraph::iterator ConnectionGraph::remove(iterator aa) {
-    assert(aa != emap.end());
-    Exp *b = aa->second;
-    emap.erase(aa++);
-    iterator bb = emap.find(b);
-    assert(bb != emap.end());
-    if (bb == aa)
-        ++aa;
-    emap.erase(bb);
-    return aa;
+void ConnectionGraph::const_iterator::settle() {
+    while (var != graph->index.end() && pos >= graph->adj[var->second].size()) {
+        ++var;
+        pos = 0;
+    }
+    if (var != graph->index.end())
+        cur = value_type(graph->vars[var->second], graph->vars[graph->adj[var->second][pos]]);
+}
+
+ConnectionGraph::const_iterator &ConnectionGraph::const_iterator::operator++() {
+    ++pos;
+    settle();
+    return *this;
 }
 
 // For debugging
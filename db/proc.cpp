@@ -543,6 +543,18 @@ UserProc::UserProc(Module *mod, const QString &name, ADDRESS uNative)
       cfg(new Cfg()), status(PROC_UNDECODED), cycleGrp(nullptr), theReturnStatement(nullptr), DFGcount(0) {
     cfg->setProc(this); // Initialise cfg.myProc
     localTable.setProc(this);
+    if (Boomerang::get()->procArenas && prog)
+        arena = prog->newProcArena();
+}
+
+QString UserProc::arenaStats() const {
+    if (arena == nullptr)
+        return "no arena";
+    return QString("%1 objects allocated (%2 bytes in %3 slabs), %4 freed")
+        .arg(arena->allocations())
+        .arg(arena->bytesAllocated())
+        .arg(arena->slabCount())
+        .arg(arena->frees());
 }
 
 UserProc::~UserProc() { deleteCFG(); }
@@ -1072,6 +1084,7 @@ void UserProc::insertStatementAfter(Instruction *s, Instruction *a) {
   *
   ******************************************************************************/
 std::shared_ptr<ProcSet> UserProc::decompile(ProcList *path, int &indent) {
+    ProcArena::Scope arenaScope(arena); // Callees decompiled from here use their own arenas
     Boomerang::get()->alertConsidering(path->empty() ? nullptr : path->back(), this);
     alignStream(LOG_STREAM(),++indent) << (status >= PROC_VISITED ? "re" : "") << "considering "
               << getName() << "\n";
@@ -2460,14 +2473,16 @@ void UserProc::processFloatConstants() {
     StatementList stmts;
     getStatements(stmts);
 
-    static Ternary match(opFsize, Terminal::get(opWild), Terminal::get(opWild), Location::memOf(Terminal::get(opWild)));
+    static Ternary *match = ProcArena::onHeap([] {
+        return new Ternary(opFsize, Terminal::get(opWild), Terminal::get(opWild), Location::memOf(Terminal::get(opWild)));
+    });
 
     StatementList::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++) {
         Instruction *s = *it;
 
         std::list<Exp *> results;
-        s->searchAll(match, results);
+        s->searchAll(*match, results);
         for (auto &result : results) {
             Ternary *fsize = (Ternary *)result;
             if (fsize->getSubExp3()->getOper() == opMemOf &&
@@ -2588,9 +2603,10 @@ Exp *UserProc::getSymbolExp(Exp *le, SharedType ty, bool lastPass) {
 
 // Not used with DFA Type Analysis; the equivalent thing happens in mapLocalsAndParams() now
 void UserProc::mapExpressionsToLocals(bool lastPass) {
-    static Exp *sp_location = Location::regOf(0);
+    static Exp *sp_location = ProcArena::onHeap([] { return Location::regOf(0); });
     // parse("[*] + sp{0}")
-    static Binary nn(opPlus, Terminal::get(opWild), RefExp::get(sp_location, nullptr));
+    static Binary *nn = ProcArena::onHeap(
+        [] { return new Binary(opPlus, Terminal::get(opWild), RefExp::get(sp_location, nullptr)); });
     StatementList stmts;
     getStatements(stmts);
 
@@ -2655,7 +2671,7 @@ void UserProc::mapExpressionsToLocals(bool lastPass) {
     for (it = stmts.begin(); it != stmts.end(); it++) {
         Instruction *s = *it;
         std::list<Exp *> results;
-        s->searchAll(nn, results);
+        s->searchAll(*nn, results);
         for (auto &result : results) {
             Exp *wild = (result)->getSubExp1();
             (result)->setSubExp1((result)->getSubExp2());
@@ -2668,15 +2684,17 @@ void UserProc::mapExpressionsToLocals(bool lastPass) {
     // l = m[(sp{0} + WILD1) - K2]
     static Const sp_const(0);
     static Location sp_loc(opRegOf, &sp_const, nullptr);
-    static Location query_f(
-        opMemOf, Binary::get(opMinus, Binary::get(opPlus, RefExp::get(&sp_loc, nullptr), Terminal::get(opWild)),
-                             Terminal::get(opWildIntConst)),
-        nullptr);
+    static Location *query_f = ProcArena::onHeap([] {
+        return new Location(
+            opMemOf, Binary::get(opMinus, Binary::get(opPlus, RefExp::get(&sp_loc, nullptr), Terminal::get(opWild)),
+                                 Terminal::get(opWildIntConst)),
+            nullptr);
+    });
     for (it = stmts.begin(); it != stmts.end(); it++) {
         Instruction *s = *it;
         std::list<Exp *> results;
         sp_const.setInt(sp);
-        s->searchAll(query_f, results);
+        s->searchAll(*query_f, results);
         for (Exp *result : results) {
             // arr = m[sp{0} - K2]
             Exp *arr = Location::memOf(Binary::get(opMinus, RefExp::get(Location::regOf(sp), nullptr),
@@ -3128,6 +3146,7 @@ void UserProc::removeUnusedLocals() {
 //
 
 void UserProc::fromSSAform() {
+    ProcArena::Scope arenaScope(arena);
     Boomerang::get()->alertDecompiling(this);
 
     if (VERBOSE)
@@ -110,11 +110,19 @@ void Prog::setFrontEnd(FrontEnd *_pFE) {
 }
 
 Prog::~Prog() {
-    pLoaderPlugin->deleteLater();
+    releaseLoader();
     delete DefaultFrontend;
     for (Module *m : ModuleList) {
         delete m;
     }
+    // Only now that no proc is left can the IR allocated in their arenas go
+    procArenas.clear();
+}
+
+ProcArena *Prog::newProcArena() {
+    std::lock_guard<std::recursive_mutex> guard(procsMutex);
+    procArenas.emplace_back(new ProcArena);
+    return procArenas.back().get();
 }
 //! Assign a name to this program
 void Prog::setName(const char *name) {
@@ -394,12 +402,22 @@ void Prog::print(QTextStream &out) {
 }
 
 //! clear the prog object \note deletes everything!
+//! Let go of the loader: a loader kept by the BinaryFileFactory for later loads only unloads its file
+void Prog::releaseLoader() {
+    if (pLoaderPlugin == nullptr)
+        return;
+    if (BinaryFileFactory::isResident(pLoaderPlugin))
+        pLoaderIface->UnLoad();
+    else
+        pLoaderPlugin->deleteLater();
+}
+
 void Prog::clear() {
     m_name = "";
     for (Module * module : ModuleList)
         delete module;
     ModuleList.clear();
-    pLoaderPlugin->deleteLater();
+    releaseLoader();
     pLoaderPlugin = nullptr;
     delete DefaultFrontend;
     DefaultFrontend = nullptr;
@@ -420,6 +438,7 @@ Function *Prog::setNewProc(ADDRESS uAddr) {
     // this test fails when decoding sparc, why?  Please investigate - trent
     // Likely because it is in the Procedure Linkage Table (.plt), which for Sparc is in the data section
     // assert(uAddr >= limitTextLow && uAddr < limitTextHigh);
+    std::lock_guard<std::recursive_mutex> guard(procsMutex);
     // Check if we already have this proc
     Function *pProc = findProc(uAddr);
     if (pProc == (Function *)-1) // Already decoded and deleted?
@@ -595,6 +614,7 @@ BOOL CALLBACK addSymbol(dbghelp::PSYMBOL_INFO pSymInfo, ULONG SymbolSize, PVOID
   * \note this does not destroy the removed function.
   ******************************************************************************/
 void Prog::removeProc(const QString &name) {
+    std::lock_guard<std::recursive_mutex> guard(procsMutex);
     Function *f = findProc(name);
     if(f && f!=(Function *)-1) {
         f->removeFromParent();
@@ -632,6 +652,7 @@ int Prog::getNumProcs(bool user_only) {
   * \returns Pointer to the Proc object, or 0 if none, or -1 if deleted
   ******************************************************************************/
 Function *Prog::findProc(ADDRESS uAddr) const {
+    std::lock_guard<std::recursive_mutex> guard(procsMutex);
     for(Module *m : ModuleList)
     {
         Function *r = m->getFunction(uAddr);
@@ -647,6 +668,7 @@ Function *Prog::findProc(ADDRESS uAddr) const {
   * \returns Pointer to the Proc object, or 0 if none, or -1 if deleted
   ******************************************************************************/
 Function *Prog::findProc(const QString &name) const {
+    std::lock_guard<std::recursive_mutex> guard(procsMutex);
     for(Module *m : ModuleList) {
         Function *f = m->getFunction(name);
         if(f)
@@ -657,6 +679,7 @@ Function *Prog::findProc(const QString &name) const {
 
 //! lookup a library procedure by name; create if does not exist
 LibProc *Prog::getLibraryProc(const QString &nam) {
+    std::lock_guard<std::recursive_mutex> guard(procsMutex);
     Function *p = findProc(nam);
     if (p && p->isLib())
         return (LibProc *)p;
@@ -694,7 +717,9 @@ void Prog::dumpGlobals() {
 }
 //! Get a named global variable if possible, looking up the loader's symbol table if necessary
 ADDRESS Prog::getGlobalAddr(const QString &nam) {
+    std::unique_lock<std::mutex> guard(globalsMutex);
     Global *glob = getGlobal(nam);
+    guard.unlock();
     if (glob)
         return glob->getAddress();
     auto symbol = BinarySymbols->find(nam);
@@ -836,16 +861,16 @@ void Prog::setGlobalType(const QString &nam, SharedType ty) {
 // if knownString, it is already known to be a char*
 //! get a string constant at a give address if appropriate
 const char *Prog::getStringConstant(ADDRESS uaddr, bool knownString /* = false */) {
-    const IBinarySection *si = Image->getSectionInfoByAddr(uaddr);
-    // Too many compilers put constants, including string constants, into read/write sections
-    // if (si && si->bReadOnly)
-    if (si && !si->isAddressBss(uaddr)) {
+    if (!knownString) {
+        // Only an address inside one of the NUL terminated strings found at load time can be a string constant
+        const StringConstant *str = Image->findString(uaddr);
+        if (str == nullptr)
+            return nullptr;
+        const char *p = (const char *)Image->readSpan(uaddr, (str->addr + str->length - uaddr).m_value + 1);
+        if (p == nullptr)
+            return nullptr;
         // At this stage, only support ascii, null terminated, non unicode strings.
         // At least 4 of the first 6 chars should be printable ascii
-        char *p = (char *)(uaddr + si->hostAddr() - si->sourceAddr()).m_value;
-        if (knownString)
-            // No need to guess... this is hopefully a known string
-            return p;
         int printable = 0;
         char last = 0;
         for (int i = 0; i < 6; i++) {
@@ -861,7 +886,14 @@ const char *Prog::getStringConstant(ADDRESS uaddr, bool knownString /* = false *
         // Just a hack while type propagations are not yet ready
         if (last == '\n' && printable >= 2)
             return p;
+        return nullptr;
     }
+    const IBinarySection *si = Image->getSectionInfoByAddr(uaddr);
+    // Too many compilers put constants, including string constants, into read/write sections
+    // if (si && si->bReadOnly)
+    if (si && !si->isAddressBss(uaddr))
+        // No need to guess... this is hopefully a known string
+        return (char *)(uaddr + si->hostAddr() - si->sourceAddr()).m_value;
     return nullptr;
 }
 
@@ -1034,6 +1066,8 @@ const QString &Prog::GetDynamicProcName(ADDRESS uNative) {
 }
 
 void Prog::decodeEverythingUndecoded() {
+    if (Boomerang::get()->numDecodeThreads > 1)
+        DefaultFrontend->decodeInParallel(Boomerang::get()->numDecodeThreads);
     for(Module *module : ModuleList) {
         for (Function *pp : *module) {
             UserProc *up = (UserProc *)pp;
@@ -1115,6 +1149,15 @@ void Prog::decompile() {
 
     // removeUnusedLocals(); Note: is now in UserProc::generateCode()
     removeUnusedGlobals();
+
+    if (boom->procArenas && VERBOSE) {
+        for (Module *module : ModuleList) {
+            for (Function *pp : *module) {
+                if (!pp->isLib())
+                    LOG << pp->getName() << ": " << ((UserProc *)pp)->arenaStats() << "\n";
+            }
+        }
+    }
 }
 //! As the name suggests, removes globals unused in the decompiled code.
 void Prog::removeUnusedGlobals() {
@@ -1652,6 +1695,7 @@ Exp *Prog::addReloc(Exp *e, ADDRESS lc) {
     const IBinarySymbol *bin_sym = BinarySymbols->find(c_addr);
     if (bin_sym != nullptr) {
         unsigned int sz = bin_sym->getSize(); // TODO: fix the case of missing symbol table interface
+        std::lock_guard<std::mutex> guard(globalsMutex);
         if (getGlobal(bin_sym->getName()) == nullptr) {
             Global *global = new Global(SizeType::get(sz * 8), c_addr, bin_sym->getName(),this);
             globals.insert(global);
@@ -1663,14 +1707,11 @@ Exp *Prog::addReloc(Exp *e, ADDRESS lc) {
             e = new Const(str);
         else {
             // check for accesses into the middle of symbols
-            for (IBinarySymbol *it : *BinarySymbols) {
-                unsigned int sz = it->getSize();
-                if (it->getLocation() < c_addr && (it->getLocation() + sz) > c_addr) {
-                    int off = (c->getAddr() - it->getLocation()).m_value;
-                    e = Binary::get(opPlus, new Unary(opAddrOf, Location::global(it->getName(), nullptr)),
-                                    new Const(off));
-                    break;
-                }
+            const IBinarySymbol *container = BinarySymbols->findContainingSymbol(c_addr);
+            if (container != nullptr) {
+                int off = (c_addr - container->getLocation()).m_value;
+                e = Binary::get(opPlus, new Unary(opAddrOf, Location::global(container->getName(), nullptr)),
+                                new Const(off));
             }
         }
     }
@@ -1679,11 +1720,8 @@ Exp *Prog::addReloc(Exp *e, ADDRESS lc) {
 
 
 bool Prog::isStringConstant(ADDRESS a) {
-    const SectionInfo *si = static_cast<const SectionInfo *>(Image->getSectionInfoByAddr(a));
-    if(!si)
-        return false;
-    QVariant qv = si->attributeInRange("StringsSection",a,a+1);
-    return !qv.isNull();
+    const IBinarySection *si = Image->getSectionInfoByAddr(a);
+    return si != nullptr && si->hasAttribute(ATTR_StringsSection, a);
 }
 
 bool Prog::isCFStringConstant(ADDRESS a) { return isStringConstant(a); }
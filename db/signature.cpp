@@ -1762,8 +1762,10 @@ bool Signature::isAddrOfStackLocal(Prog *prog, Exp *e) {
     OPER op = e->getOper();
     if (op == opAddrOf)
         return isStackLocal(prog, e->getSubExp1());
-    // e must be sp -/+ K or just sp
-    static Exp *sp = Location::regOf(getStackRegister(prog));
+    // e must be sp -/+ K or just sp. Not a static: the stack register depends on prog
+    Const spNum(getStackRegister(prog));
+    Location spLoc(opRegOf, &spNum, nullptr);
+    Exp *sp = &spLoc;
     if (op != opMinus && op != opPlus) {
         // Matches if e is sp or sp{0} or sp{-}
         return (*e == *sp ||
@@ -1793,7 +1795,7 @@ bool CallingConvention::StdC::SparcSignature::isAddrOfStackLocal(Prog *prog, Exp
     if (op == opAddrOf)
         return isStackLocal(prog, e->getSubExp1());
     // e must be sp -/+ K or just sp
-    static Exp *sp = Location::regOf(14);
+    static Exp *sp = ProcArena::onHeap([] { return Location::regOf(14); });
     if (op != opMinus && op != opPlus) {
         // Matches if e is sp or sp{0} or sp{-}
         return (*e == *sp ||
@@ -0,0 +1,555 @@
+/*
+ * Copyright (C) 2016, The Boomerang team
+ *
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL
+ * WARRANTIES.
+ *
+ */
+
+/***************************************************************************/ /**
+  * \file       sslcache.cpp
+  * \brief   Binary cache of a fully expanded RTLInstDict, so that a run does not have to re-parse and re-expand
+  *          the .ssl file every time.
+  *
+  * The cache file starts with a small header (magic, format version, hash of the .ssl file contents); a cache whose
+  * header does not match is simply ignored. The file is mapped, not read, when it is loaded. Cache files live in the
+  * user's cache directory (see RTLInstDict::cacheFileName), never in the source or install tree.
+  * Only the subset of expressions, statements and types the SSL parser produces can be written; if the dictionary
+  * contains anything else, no cache is written and the .ssl file keeps being parsed.
+  ******************************************************************************/
+
+#include "rtl.h"
+#include "boomerang.h"
+#include "exp.h"
+#include "statement.h"
+#include "type.h"
+#include "log.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QDataStream>
+#include <QtCore/QCryptographicHash>
+
+static const quint32 SSL_CACHE_MAGIC = 0x4c535342; // "BSSL"
+static const quint32 SSL_CACHE_VERSION = 1;        //!< Bump whenever the layout below changes
+
+namespace {
+enum ExpTag : quint8 { TAG_NULL, TAG_CONST, TAG_TERMINAL, TAG_UNARY, TAG_BINARY, TAG_TERNARY, TAG_TYPED, TAG_FLAGDEF,
+                       TAG_LOCATION };
+const quint8 NO_TYPE = 0xFF;
+}
+
+static bool writeRTL(QDataStream &ds, const RTL *rtl);
+static RTL *readRTL(QDataStream &ds);
+
+static bool writeType(QDataStream &ds, const SharedType &ty) {
+    if (!ty) {
+        ds << NO_TYPE;
+        return true;
+    }
+    ds << quint8(ty->getId());
+    switch (ty->getId()) {
+    case eVoid:
+    case eBoolean:
+    case eChar:
+        return true;
+    case eInteger:
+        ds << quint32(ty->getSize()) << qint32(ty->as<IntegerType>()->getSignedness());
+        return true;
+    case eFloat:
+    case eSize:
+        ds << quint32(ty->getSize());
+        return true;
+    default:
+        return false; // Never produced by the SSL parser
+    }
+}
+
+static SharedType readType(QDataStream &ds) {
+    quint8 id;
+    quint32 size;
+    qint32 sign;
+    ds >> id;
+    switch (id) {
+    case eVoid:
+        return VoidType::get();
+    case eBoolean:
+        return BooleanType::get();
+    case eChar:
+        return CharType::get();
+    case eInteger:
+        ds >> size >> sign;
+        return IntegerType::get(size, sign);
+    case eFloat:
+        ds >> size;
+        return FloatType::get(size);
+    case eSize:
+        ds >> size;
+        return SizeType::get(size);
+    default:
+        return nullptr;
+    }
+}
+
+static bool writeExp(QDataStream &ds, const Exp *e) {
+    if (e == nullptr) {
+        ds << quint8(TAG_NULL);
+        return true;
+    }
+    OPER op = e->getOper();
+    // Most derived classes first
+    if (const Const *c = dynamic_cast<const Const *>(e)) {
+        ds << quint8(TAG_CONST) << qint32(op);
+        switch (op) {
+        case opIntConst:
+        case opLongConst:
+            ds << quint64(c->getLong());
+            break;
+        case opFltConst:
+            ds << c->getFlt();
+            break;
+        case opStrConst:
+            ds << c->getStr();
+            break;
+        default:
+            return false;
+        }
+        ds << qint32(((Const *)c)->getConscript());
+        return writeType(ds, c->getType());
+    }
+    if (dynamic_cast<const TypeVal *>(e) || dynamic_cast<const RefExp *>(e))
+        return false;
+    if (dynamic_cast<const Terminal *>(e)) {
+        ds << quint8(TAG_TERMINAL) << qint32(op);
+        return true;
+    }
+    if (const TypedExp *t = dynamic_cast<const TypedExp *>(e)) {
+        ds << quint8(TAG_TYPED);
+        return writeType(ds, t->getType()) && writeExp(ds, t->getSubExp1());
+    }
+    if (const FlagDef *f = dynamic_cast<const FlagDef *>(e)) {
+        ds << quint8(TAG_FLAGDEF);
+        return writeExp(ds, f->getSubExp1()) && writeRTL(ds, f->getRtl().get());
+    }
+    if (dynamic_cast<const Location *>(e)) {
+        ds << quint8(TAG_LOCATION) << qint32(op);
+        return writeExp(ds, e->getSubExp1());
+    }
+    if (dynamic_cast<const Ternary *>(e)) {
+        ds << quint8(TAG_TERNARY) << qint32(op);
+        return writeExp(ds, e->getSubExp1()) && writeExp(ds, e->getSubExp2()) && writeExp(ds, e->getSubExp3());
+    }
+    if (dynamic_cast<const Binary *>(e)) {
+        ds << quint8(TAG_BINARY) << qint32(op);
+        return writeExp(ds, e->getSubExp1()) && writeExp(ds, e->getSubExp2());
+    }
+    if (dynamic_cast<const Unary *>(e)) {
+        ds << quint8(TAG_UNARY) << qint32(op);
+        return writeExp(ds, e->getSubExp1());
+    }
+    return false;
+}
+
+static Exp *readExp(QDataStream &ds) {
+    quint8 tag;
+    qint32 op = opNil;
+    ds >> tag;
+    if (tag != TAG_NULL && tag != TAG_TYPED && tag != TAG_FLAGDEF)
+        ds >> op;
+    switch (tag) {
+    case TAG_CONST: {
+        Const *c;
+        if (op == opStrConst) {
+            QString str;
+            ds >> str;
+            c = new Const(str);
+        } else if (op == opFltConst) {
+            double d;
+            ds >> d;
+            c = new Const(d);
+        } else {
+            quint64 bits;
+            ds >> bits;
+            c = new Const(QWord(bits)); // Restores all bits of the union, whichever member was used
+            c->setOper((OPER)op);
+        }
+        qint32 conscript;
+        ds >> conscript;
+        c->setConscript(conscript);
+        c->setType(readType(ds));
+        return c;
+    }
+    case TAG_TERMINAL:
+        return new Terminal((OPER)op);
+    case TAG_TYPED: {
+        SharedType ty = readType(ds);
+        return new TypedExp(ty, readExp(ds));
+    }
+    case TAG_FLAGDEF: {
+        Exp *params = readExp(ds);
+        return new FlagDef(params, SharedRTL(readRTL(ds)));
+    }
+    case TAG_LOCATION:
+        return new Location((OPER)op, readExp(ds), nullptr);
+    case TAG_TERNARY: {
+        Exp *e1 = readExp(ds);
+        Exp *e2 = readExp(ds);
+        return new Ternary((OPER)op, e1, e2, readExp(ds));
+    }
+    case TAG_BINARY: {
+        Exp *e1 = readExp(ds);
+        return Binary::get((OPER)op, e1, readExp(ds));
+    }
+    case TAG_UNARY:
+        return new Unary((OPER)op, readExp(ds));
+    default:
+        return nullptr;
+    }
+}
+
+//! Only plain (optionally guarded) assignments appear in SSL semantics
+static bool writeStmt(QDataStream &ds, Instruction *s) {
+    if (s == nullptr || !s->isAssign())
+        return false;
+    Assign *asgn = (Assign *)s;
+    return writeType(ds, asgn->getType()) && writeExp(ds, asgn->getLeft()) && writeExp(ds, asgn->getRight()) &&
+           writeExp(ds, asgn->getGuard());
+}
+
+static Instruction *readStmt(QDataStream &ds) {
+    SharedType ty = readType(ds);
+    Exp *lhs = readExp(ds);
+    Exp *rhs = readExp(ds);
+    Exp *guard = readExp(ds);
+    return new Assign(ty, lhs, rhs, guard);
+}
+
+static bool writeStmtList(QDataStream &ds, const std::list<Instruction *> &stmts) {
+    ds << quint32(stmts.size());
+    for (Instruction *s : stmts)
+        if (!writeStmt(ds, s))
+            return false;
+    return true;
+}
+
+static void readStmtList(QDataStream &ds, std::list<Instruction *> &stmts) {
+    quint32 count;
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++)
+        stmts.push_back(readStmt(ds));
+}
+
+static bool writeRTL(QDataStream &ds, const RTL *rtl) {
+    ds << bool(rtl != nullptr);
+    if (rtl == nullptr)
+        return true;
+    ds << quint64(const_cast<RTL *>(rtl)->getAddress().m_value);
+    return writeStmtList(ds, *rtl);
+}
+
+static RTL *readRTL(QDataStream &ds) {
+    bool present;
+    quint64 addr;
+    ds >> present;
+    if (!present)
+        return nullptr;
+    ds >> addr;
+    RTL *rtl = new RTL(ADDRESS::g(addr));
+    readStmtList(ds, *rtl);
+    return rtl;
+}
+
+static void writeStrings(QDataStream &ds, const std::list<QString> &strs) {
+    ds << quint32(strs.size());
+    for (const QString &s : strs)
+        ds << s;
+}
+
+static void readStrings(QDataStream &ds, std::list<QString> &strs) {
+    quint32 count;
+    QString s;
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        ds >> s;
+        strs.push_back(s);
+    }
+}
+
+static void writeRegister(QDataStream &ds, const Register &reg) {
+    ds << reg.g_name() << qint32(reg.g_size()) << qint32(reg.g_mappedIndex()) << qint32(reg.g_mappedOffset())
+       << reg.isFloat();
+}
+
+static void readRegister(QDataStream &ds, Register &reg) {
+    QString name;
+    qint32 size, mappedIndex, mappedOffset;
+    bool flt;
+    ds >> name >> size >> mappedIndex >> mappedOffset >> flt;
+    reg.s_name(name);
+    reg.s_size(size);
+    reg.s_address(nullptr);
+    reg.s_mappedIndex(mappedIndex);
+    reg.s_mappedOffset(mappedOffset);
+    reg.s_float(flt);
+}
+
+/***************************************************************************/ /**
+  * \brief   Hash of the contents of an .ssl file; this is what a cache file is keyed by.
+  * \param   SSLFileName - the .ssl file
+  * \returns the hash, or an empty array if the file can't be read
+  ******************************************************************************/
+QByteArray RTLInstDict::sslFileHash(const QString &SSLFileName) {
+    QFile f(SSLFileName);
+    if (!f.open(QFile::ReadOnly))
+        return QByteArray();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&f);
+    return hash.result();
+}
+
+/***************************************************************************/ /**
+  * \brief   Name of the cache file for an .ssl file: one per .ssl contents, in the user's cache directory rather than
+  *          next to the .ssl file, which may be read-only or part of the source tree.
+  * \param   sslHash - hash of the .ssl file, see sslFileHash
+  * \returns the file name, or an empty string if there is no hash or no cache directory
+  ******************************************************************************/
+QString RTLInstDict::cacheFileName(const QByteArray &sslHash) {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (sslHash.isEmpty() || dir.isEmpty())
+        return QString();
+    return dir + "/ssl/" + QString::fromLatin1(sslHash.toHex()) + ".cache";
+}
+
+/***************************************************************************/ /**
+  * \brief   Write the (already read and compiled) dictionary to a cache file.
+  * \param   fileName - the cache file to create or replace
+  * \param   sslHash - hash of the .ssl file this dictionary was read from, see sslFileHash
+  * \returns true if the cache file was written
+  ******************************************************************************/
+bool RTLInstDict::writeCache(const QString &fileName, const QByteArray &sslHash) {
+    if (!DefMap.empty())
+        return false; // Not filled in by the parser; holds opaque pointers anyway
+    QByteArray data;
+    QDataStream ds(&data, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_5_0);
+    ds << SSL_CACHE_MAGIC << SSL_CACHE_VERSION << sslHash;
+
+    ds << bigEndian;
+    ds << quint32(RegMap.size());
+    for (const auto &elem : RegMap)
+        ds << elem.first << qint32(elem.second);
+    ds << quint32(DetRegMap.size());
+    for (const auto &elem : DetRegMap) {
+        ds << qint32(elem.first);
+        writeRegister(ds, elem.second);
+    }
+    ds << quint32(SpecialRegMap.size());
+    for (const auto &elem : SpecialRegMap) {
+        ds << elem.first;
+        writeRegister(ds, elem.second);
+    }
+    ds << quint32(ParamSet.size());
+    for (const QString &name : ParamSet)
+        ds << name;
+
+    ds << quint32(DetParamMap.size());
+    for (auto it = DetParamMap.begin(); it != DetParamMap.end(); ++it) {
+        const ParamEntry &param(it.value());
+        ds << it.key();
+        writeStrings(ds, param.params);
+        writeStrings(ds, param.funcParams);
+        ds << bool(param.asgn != nullptr);
+        if (param.asgn && !writeStmt(ds, param.asgn))
+            return false;
+        ds << param.lhs << qint32(param.kind) << qint32(param.mark);
+        if (!writeType(ds, param.regType))
+            return false;
+        ds << quint32(param.regIdx.size());
+        for (int idx : param.regIdx)
+            ds << qint32(idx);
+    }
+
+    ds << quint32(FlagFuncs.size());
+    for (const auto &elem : FlagFuncs) {
+        ds << elem.first;
+        if (!writeExp(ds, elem.second))
+            return false;
+    }
+    ds << quint32(AliasMap.size());
+    for (const auto &elem : AliasMap) {
+        ds << qint32(elem.first);
+        if (!writeExp(ds, elem.second))
+            return false;
+    }
+    ds << quint32(fastMap.size());
+    for (const auto &elem : fastMap)
+        ds << elem.first << elem.second;
+
+    ds << quint32(idict.size());
+    for (auto &elem : idict) {
+        TableEntry &entry(elem.second);
+        ds << elem.first;
+        writeStrings(ds, entry.params);
+        ds << qint32(entry.flags);
+        if (!writeRTL(ds, &entry.rtl))
+            return false;
+        ds << entry.isCompiled;
+        if (!entry.isCompiled)
+            continue;
+        if (!writeRTL(ds, &entry.compiled))
+            return false;
+        ds << quint32(entry.slotted.size());
+        for (bool b : entry.slotted)
+            ds << b;
+        ds << entry.latePostVars;
+    }
+    if (!writeRTL(ds, fetchExecCycle.get()))
+        return false;
+
+    // Written to a temporary and renamed, so that concurrent runs never see a partial cache
+    if (!QDir().mkpath(QFileInfo(fileName).absolutePath()))
+        return false;
+    QSaveFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    f.write(data);
+    return f.commit();
+}
+
+/***************************************************************************/ /**
+  * \brief   Replace the contents of this dictionary with those of a cache file written by writeCache.
+  * \param   fileName - the cache file
+  * \param   sslHash - hash of the .ssl file the caller wants the dictionary of, see sslFileHash
+  * \returns true if the cache was valid for sslHash and has been loaded; if false, the dictionary is left empty
+  ******************************************************************************/
+bool RTLInstDict::readCache(const QString &fileName, const QByteArray &sslHash) {
+    reset();
+    QFile f(fileName);
+    if (sslHash.isEmpty() || !f.open(QFile::ReadOnly) || f.size() == 0)
+        return false;
+    uchar *mapped = f.map(0, f.size());
+    if (mapped == nullptr)
+        return false;
+    QByteArray data = QByteArray::fromRawData((const char *)mapped, f.size());
+    QDataStream ds(data);
+    ds.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version;
+    QByteArray hash;
+    ds >> magic >> version >> hash;
+    if (magic != SSL_CACHE_MAGIC || version != SSL_CACHE_VERSION || hash != sslHash)
+        return false;
+
+    quint32 count;
+    ds >> bigEndian;
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        QString name;
+        qint32 idx;
+        ds >> name >> idx;
+        RegMap[name] = idx;
+    }
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        qint32 idx;
+        ds >> idx;
+        readRegister(ds, DetRegMap[idx]);
+    }
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        QString name;
+        ds >> name;
+        readRegister(ds, SpecialRegMap[name]);
+    }
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        QString name;
+        ds >> name;
+        ParamSet.insert(name);
+    }
+
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        QString name;
+        bool hasAsgn;
+        qint32 kind, mark;
+        ds >> name;
+        ParamEntry &param(DetParamMap[name]);
+        readStrings(ds, param.params);
+        readStrings(ds, param.funcParams);
+        ds >> hasAsgn;
+        param.asgn = hasAsgn ? readStmt(ds) : nullptr;
+        ds >> param.lhs >> kind >> mark;
+        param.kind = (ParamKind)kind;
+        param.mark = mark;
+        param.regType = readType(ds);
+        quint32 numIdx;
+        ds >> numIdx;
+        for (quint32 j = 0; j < numIdx && ds.status() == QDataStream::Ok; j++) {
+            qint32 idx;
+            ds >> idx;
+            param.regIdx.insert(idx);
+        }
+    }
+
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        QString name;
+        ds >> name;
+        FlagFuncs[name] = readExp(ds);
+    }
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        qint32 idx;
+        ds >> idx;
+        AliasMap[idx] = readExp(ds);
+    }
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        QString from, to;
+        ds >> from >> to;
+        fastMap[from] = to;
+    }
+
+    ds >> count;
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; i++) {
+        QString name;
+        qint32 flags;
+        ds >> name;
+        TableEntry &entry(idict.emplace_hint(idict.end(), name, TableEntry())->second);
+        readStrings(ds, entry.params);
+        ds >> flags;
+        entry.flags = flags;
+        std::unique_ptr<RTL> rtl(readRTL(ds));
+        if (rtl)
+            entry.rtl.splice(entry.rtl.end(), *rtl);
+        ds >> entry.isCompiled;
+        if (entry.isCompiled) {
+            rtl.reset(readRTL(ds));
+            if (rtl)
+                entry.compiled.splice(entry.compiled.end(), *rtl);
+            quint32 numStmts;
+            ds >> numStmts;
+            for (quint32 j = 0; j < numStmts && ds.status() == QDataStream::Ok; j++) {
+                bool b;
+                ds >> b;
+                entry.slotted.push_back(b);
+            }
+            ds >> entry.latePostVars;
+        }
+        entry.opcodeId = OpcodeTable.size();
+        OpcodeTable.push_back(&entry);
+    }
+    fetchExecCycle = SharedRTL(readRTL(ds));
+
+    if (ds.status() != QDataStream::Ok) {
+        LOG_STREAM() << "Warning: SSL cache " << fileName << " is damaged, ignoring it\n";
+        reset();
+        return false;
+    }
+    return true;
+}
@@ -43,7 +43,12 @@
 /***************************************************************************/ /**
   * \brief        Constructor
   ******************************************************************************/
-TableEntry::TableEntry() { flags = 0; }
+TableEntry::TableEntry() {
+    flags = 0;
+    latePostVars = false;
+    isCompiled = false;
+    opcodeId = -1;
+}
 
 /***************************************************************************/ /**
   * \brief Constructor
@@ -54,6 +59,9 @@ TableEntry::TableEntry() { flags = 0; }
 TableEntry::TableEntry(std::list<QString> &p, RTL &r) : rtl(r) {
     std::copy(p.begin(), p.end(), std::back_inserter(params));
     flags = 0;
+    latePostVars = false;
+    isCompiled = false;
+    opcodeId = -1;
 }
 
 /***************************************************************************/ /**
@@ -78,6 +86,11 @@ void TableEntry::setRTL(RTL &r) { rtl = r; }
 TableEntry &TableEntry::operator=(const TableEntry &other) {
     params = other.params;
     rtl = other.rtl;
+    compiled = other.compiled;
+    slotted = other.slotted;
+    latePostVars = other.latePostVars;
+    isCompiled = other.isCompiled;
+    opcodeId = other.opcodeId;
     return *this;
 }
 
@@ -95,6 +108,7 @@ int TableEntry::appendRTL(std::list<QString> &p, RTL &r) {
         ;
     if (match) {
         rtl.appendListStmt(r);
+        isCompiled = false; // The precompiled form (if any) is stale now
         return 0;
     }
     return -1;
@@ -136,6 +150,19 @@ bool RTLInstDict::readSSLFile(const QString &SSLFileName) {
     // Clear all state
     reset();
 
+    // A cache written by an earlier run for the same .ssl contents saves parsing and expanding it again
+    bool useCache = !Boomerang::get()->noSSLCache;
+    QByteArray sslHash;
+    QString cacheName;
+    if (useCache) {
+        sslHash = sslFileHash(SSLFileName);
+        cacheName = cacheFileName(sslHash);
+        if (!cacheName.isEmpty() && readCache(cacheName, sslHash)) {
+            dumpIfDebugging();
+            return true;
+        }
+    }
+
     // Attempt to Parse the SSL file
     SSLParser theParser(qPrintable(SSLFileName),
 #ifdef DEBUG_SSLPARSER
@@ -152,15 +179,24 @@ bool RTLInstDict::readSSLFile(const QString &SSLFileName) {
     theParser.yyparse(*this);
 
     fixupParams();
+    compileTemplates();
 
+    // Failing to write the cache (e.g. no writable cache directory) only costs the next run a parse
+    if (useCache && !cacheName.isEmpty() && !writeCache(cacheName, sslHash))
+        LOG_VERBOSE(1) << "not caching SSL dictionary for " << SSLFileName << "\n";
+
+    dumpIfDebugging();
+    return true;
+}
+
+//! Print the expanded dictionary if decoder debugging is on
+void RTLInstDict::dumpIfDebugging() {
     if (Boomerang::get()->debugDecoder) {
         QTextStream q_cout(stdout);
         q_cout << "\n=======Expanded RTL template dictionary=======\n";
         print(q_cout);
         q_cout << "\n==============================================\n\n";
     }
-
-    return true;
 }
 
 /***************************************************************************/ /**
@@ -318,6 +354,21 @@ std::pair<QString, unsigned> RTLInstDict::getSignature(const char *name) {
     return {hlpr, (it->second).params.size()};
 }
 
+/***************************************************************************/ /**
+  * \brief   Returns the dense opcode id of the given instruction, for use with instantiateRTL(int, ...). The name is
+  *          normalised the same way as in getSignature.
+  * \param   name - instruction name
+  * \returns the opcode id, or -1 if there is no such instruction in the dictionary
+  ******************************************************************************/
+int RTLInstDict::getOpcodeId(const char *name) const {
+    QString hlpr(name);
+    hlpr = hlpr.replace(".", "").toUpper();
+    auto it = idict.find(hlpr);
+    if (it == idict.end())
+        return -1;
+    return it->second.opcodeId;
+}
+
 /***************************************************************************/ /**
   * \brief         Scan the Exp* pointed to by exp; if its top level operator indicates even a partial type, then set
   *                        the expression's type, and return true
@@ -347,7 +398,7 @@ bool RTLInstDict::partialType(Exp *exp, Type &ty) {
   * \returns   the instantiated list of Exps
   ******************************************************************************/
 std::list<Instruction *> *RTLInstDict::instantiateRTL(const QString &name, ADDRESS natPC,
-                                                    const std::vector<Exp *> &actuals) {
+                                                    const std::vector<Exp *> &actuals) const {
     QTextStream q_cerr(stderr);
     // If -f is in force, use the fast (but not as precise) name instead
     QString lname = name;
@@ -364,9 +415,22 @@ std::list<Instruction *> *RTLInstDict::instantiateRTL(const QString &name, ADDRE
         q_cerr << "ERROR: unknown instruction " << lname << " at " << natPC << ", ignoring.\n";
         return nullptr;
     }
-    TableEntry &entry(dict_entry->second);
+    const TableEntry &entry(dict_entry->second);
+
+    return instantiateRTL(entry, natPC, actuals);
+}
 
-    return instantiateRTL(entry.rtl, natPC, entry.params, actuals);
+/***************************************************************************/ /**
+  * \brief   As above, but for an instruction given by its opcode id (see getOpcodeId)
+  * \param   opcodeId - the instruction's opcode id
+  * \param   natPC - address at which the instruction is located
+  * \param   actuals - the actual values
+  * \returns the instantiated list of Exps
+  ******************************************************************************/
+std::list<Instruction *> *RTLInstDict::instantiateRTL(int opcodeId, ADDRESS natPC,
+                                                    const std::vector<Exp *> &actuals) const {
+    assert(opcodeId >= 0 && (size_t)opcodeId < OpcodeTable.size());
+    return instantiateRTL(*OpcodeTable[opcodeId], natPC, actuals);
 }
 
 /***************************************************************************/ /**
@@ -378,8 +442,9 @@ std::list<Instruction *> *RTLInstDict::instantiateRTL(const QString &name, ADDRE
   * \param   actuals - the actual parameter values
   * \returns the instantiated list of Exps
   ******************************************************************************/
-std::list<Instruction *> *RTLInstDict::instantiateRTL(RTL &rtl, ADDRESS natPC, std::list<QString> &params,
-                                                    const std::vector<Exp *> &actuals) {
+std::list<Instruction *> *RTLInstDict::instantiateRTL(const RTL &rtl, ADDRESS natPC,
+                                                    const std::list<QString> &params,
+                                                    const std::vector<Exp *> &actuals) const {
     Q_UNUSED(natPC);
     assert(params.size() == actuals.size());
 
@@ -416,6 +481,191 @@ std::list<Instruction *> *RTLInstDict::instantiateRTL(RTL &rtl, ADDRESS natPC, s
     return newList;
 }
 
+/***************************************************************************/ /**
+  * \brief   Returns the slot number if e is a precompiled parameter slot (a param whose name is an integer
+  *          constant, see RTLInstDict::compileTemplate), or -1 otherwise.
+  ******************************************************************************/
+static int slotIndex(Exp *e) {
+    if (e->isParam() && e->getSubExp1()->isIntConst())
+        return ((Const *)e->getSubExp1())->getInt();
+    return -1;
+}
+
+//! True if e contains at least one parameter slot
+static bool containsSlot(Exp *e) {
+    if (e == nullptr)
+        return false;
+    if (slotIndex(e) != -1)
+        return true;
+    switch (e->getArity()) {
+    case 3:
+        if (containsSlot(e->getSubExp3()))
+            return true;
+    // fallthrough
+    case 2:
+        if (containsSlot(e->getSubExp2()))
+            return true;
+    // fallthrough
+    case 1:
+        return containsSlot(e->getSubExp1());
+    }
+    return false;
+}
+
+//! Replace every slot in e with a clone of the corresponding actual. Returns the (possibly new) top expression.
+static Exp *fillSlots(Exp *e, const std::vector<Exp *> &actuals) {
+    if (e == nullptr)
+        return nullptr;
+    int idx = slotIndex(e);
+    if (idx != -1)
+        return actuals[idx]->clone();
+    switch (e->getArity()) {
+    case 3:
+        e->refSubExp3() = fillSlots(e->getSubExp3(), actuals);
+    // fallthrough
+    case 2:
+        e->refSubExp2() = fillSlots(e->getSubExp2(), actuals);
+    // fallthrough
+    case 1:
+        e->refSubExp1() = fillSlots(e->getSubExp1(), actuals);
+    }
+    return e;
+}
+
+//! True if statement s (of a compiled template) refers to any slot. Only Assigns appear in SSL templates; anything
+//! else is conservatively treated as slotted.
+static bool stmtHasSlots(Instruction *s) {
+    if (!s->isAssign())
+        return true;
+    Assign *asgn = (Assign *)s;
+    return containsSlot(asgn->getLeft()) || containsSlot(asgn->getRight()) || containsSlot(asgn->getGuard());
+}
+
+static void fillStmtSlots(Instruction *s, const std::vector<Exp *> &actuals) {
+    if (s->isAssign()) {
+        Assign *asgn = (Assign *)s;
+        asgn->setLeft(fillSlots(asgn->getLeft(), actuals));
+        asgn->setRight(fillSlots(asgn->getRight(), actuals));
+        asgn->setGuard(fillSlots(asgn->getGuard(), actuals));
+        return;
+    }
+    for (unsigned i = 0; i < actuals.size(); i++) {
+        Location slot(opParam, Const::get(int(i)), nullptr);
+        s->searchAndReplace(slot, actuals[i]);
+    }
+}
+
+/***************************************************************************/ /**
+  * \brief   Precompile every template in the dictionary (see compileTemplate), and give each entry a dense
+  *          opcode id so the decoders can get at it without any string handling.
+  ******************************************************************************/
+void RTLInstDict::compileTemplates() {
+    OpcodeTable.clear();
+    for (auto &elem : idict) {
+        compileTemplate(elem.second);
+        elem.second.opcodeId = OpcodeTable.size();
+        OpcodeTable.push_back(&elem.second);
+    }
+}
+
+/***************************************************************************/ /**
+  * \brief   Build the precompiled form of a single dictionary entry.
+  *
+  * Each formal parameter is renamed to a slot, i.e. a param whose name is the integer index of the formal, so
+  * instantiation can drop the actuals straight into place in a single walk of the cloned statements. Work that does
+  * not depend on the actuals (fixSuccessor, simplify of statements without slots, and post-variable elimination when
+  * no slot can alias a post-variable's base) is done here, once.
+  * \param   entry - the dictionary entry to compile
+  ******************************************************************************/
+void RTLInstDict::compileTemplate(TableEntry &entry) {
+    std::list<Instruction *> stmts;
+    entry.rtl.deepCopyList(stmts);
+
+    int idx = 0;
+    for (const QString &name : entry.params) {
+        Location formal(opParam, Const::get(name), nullptr);
+        Exp *slot = Location::get(opParam, Const::get(idx++), nullptr);
+        for (Instruction *s : stmts)
+            s->searchAndReplace(formal, slot);
+    }
+
+    bool anySlots = false;
+    bool anyPostVars = false;
+    entry.slotted.clear();
+    for (Instruction *s : stmts) {
+        bool has = stmtHasSlots(s);
+        entry.slotted.push_back(has);
+        anySlots |= has;
+        if (s->isAssign() && ((Assign *)s)->getLeft() && ((Assign *)s)->getLeft()->isPostVar())
+            anyPostVars = true;
+    }
+    // Whether a post-variable's base is used can depend on what the actuals turn out to be (e.g. m[%esp'] := modrm
+    // with modrm being %esp), so in that case the elimination has to wait until the slots are filled.
+    entry.latePostVars = anySlots && anyPostVars;
+    if (!entry.latePostVars) {
+        auto has = entry.slotted.begin();
+        for (Instruction *s : stmts) {
+            if (!*has++)
+                s->fixSuccessor();
+        }
+        if (anyPostVars) {
+            transformPostVars(stmts, true);
+            entry.slotted.resize(stmts.size(), false);
+        }
+        has = entry.slotted.begin();
+        for (Instruction *s : stmts) {
+            if (!*has++)
+                s->simplify();
+        }
+    }
+
+    qDeleteAll(entry.compiled);
+    entry.compiled.clear();
+    entry.compiled.insert(entry.compiled.end(), stmts.begin(), stmts.end());
+    entry.isCompiled = true;
+}
+
+/***************************************************************************/ /**
+  * \brief   Instantiate a precompiled dictionary entry with the given actuals. Gives the same result as
+  *          instantiating entry.rtl with the generic overload, but only pays for the parts of the template that
+  *          actually depend on the operands.
+  * \param   entry - the dictionary entry
+  * \param   natPC - address at which the instruction is located
+  * \param   actuals - the actual parameter values
+  * \returns the instantiated list of Exps
+  ******************************************************************************/
+std::list<Instruction *> *RTLInstDict::instantiateRTL(const TableEntry &entry, ADDRESS natPC,
+                                                    const std::vector<Exp *> &actuals) const {
+    if (!entry.isCompiled)
+        return instantiateRTL(entry.rtl, natPC, entry.params, actuals);
+    assert(entry.params.size() == actuals.size());
+
+    std::list<Instruction *> *newList = new std::list<Instruction *>();
+    auto has = entry.slotted.begin();
+    for (Instruction *tmpl : entry.compiled) {
+        Instruction *ss = tmpl->clone();
+        bool slotted = *has++;
+        if (slotted)
+            fillStmtSlots(ss, actuals);
+        if (slotted || entry.latePostVars)
+            ss->fixSuccessor();
+        if (Boomerang::get()->debugDecoder) {
+            QTextStream q_cout(stdout);
+            q_cout << "            " << ss << "\n";
+        }
+        if (slotted && !entry.latePostVars)
+            ss->simplify();
+        newList->push_back(ss);
+    }
+
+    if (entry.latePostVars) {
+        transformPostVars(*newList, true);
+        for (Instruction *ss : *newList)
+            ss->simplify();
+    }
+    return newList;
+}
+
 /* Small struct for transformPostVars */
 class transPost {
   public:
@@ -446,7 +696,7 @@ class transPost {
   * \param optimise - try to remove temporary registers
   ******************************************************************************/
 
-void RTLInstDict::transformPostVars(std::list<Instruction *> &rts, bool optimise) {
+void RTLInstDict::transformPostVars(std::list<Instruction *> &rts, bool optimise) const {
 
     // Map from var (could be any expression really) to details
     std::map<Exp *, transPost, lessExpStar> vars;
@@ -599,5 +849,6 @@ void RTLInstDict::reset() {
     AliasMap.clear();
     fastMap.clear();
     idict.clear();
+    OpcodeTable.clear();
     fetchExecCycle = nullptr;
 }
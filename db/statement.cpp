@@ -1867,8 +1867,10 @@ bool CallStatement::isReturnAfterCall() { return returnAfterCall; }
   ******************************************************************************/
 Instruction * CallStatement::clone() const {
     CallStatement *ret = new CallStatement();
-    ret->pDest = pDest->clone();
+    ret->pDest = pDest ? pDest->clone() : nullptr; // Calls to library procs made by the front end have no pDest
     ret->m_isComputed = m_isComputed;
+    ret->procDest = procDest;
+    ret->returnAfterCall = returnAfterCall;
     StatementList::const_iterator ss;
     for (ss = arguments.begin(); ss != arguments.end(); ++ss)
         ret->arguments.append((*ss)->clone());
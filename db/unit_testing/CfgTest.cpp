@@ -15,6 +15,8 @@
 #include "log.h"
 #include "boomerang.h"
 #include "basicblock.h"
+#include "managed.h"
+#include "statement.h"
 
 #include <QDir>
 #include <QProcessEnvironment>
@@ -23,6 +25,7 @@
 #define FRONTIER_PENTIUM baseDir.absoluteFilePath("tests/inputs/pentium/frontier")
 #define SEMI_PENTIUM baseDir.absoluteFilePath("tests/inputs/pentium/semi")
 #define IFTHEN_PENTIUM baseDir.absoluteFilePath("tests/inputs/pentium/ifthen")
+#define FROMSSA2_PENTIUM baseDir.absoluteFilePath("tests/inputs/pentium/fromssa2")
 static bool logset = false;
 static QString TEST_BASE;
 static QDir baseDir;
@@ -318,4 +321,122 @@ void CfgTest::testRenameVars() {
 
     delete pFE;
 }
+/***************************************************************************/ /**
+  * \fn        CfgTest::testLocationBitSet
+  * OVERVIEW:        Test the bit vector location sets used for liveness
+  ******************************************************************************/
+void CfgTest::testLocationBitSet() {
+    Assign *s1 = new Assign, *s2 = new Assign, *s3 = new Assign;
+    LocationNumbering nums;
+    int r24_1 = nums.number(RefExp::get(Location::regOf(24), s1));
+    int r24_2 = nums.number(RefExp::get(Location::regOf(24), s2));
+    int r25_1 = nums.number(RefExp::get(Location::regOf(25), s1));
+    // Equal locations get the same number; the bases are numbered too
+    QCOMPARE(nums.number(RefExp::get(Location::regOf(24), s1)), r24_1);
+    QCOMPARE(nums.find(Location::regOf(24)), nums.baseOf(r24_2));
+    QCOMPARE(nums.find(RefExp::get(Location::regOf(24), s3)), -1);
+    QCOMPARE(nums.size(), size_t(5));
+
+    LocationBitSet a, b;
+    a.insert(r24_1);
+    b.insert(r24_2);
+    b.insert(r25_1);
+    int dr = -1;
+    QVERIFY(!a.findDifferentRef(nums, r24_1, dr));
+    QVERIFY(a.findDifferentRef(nums, r24_2, dr));
+    QCOMPARE(dr, r24_1);
+    QVERIFY(!b.findDifferentRef(nums, r25_1, dr));
+
+    a.makeUnion(b);
+    QCOMPARE(a.size(), size_t(3));
+    QVERIFY(b.isSubSetOf(a));
+    QVERIFY(!a.isSubSetOf(b));
+    a.makeDiff(b);
+    QCOMPARE(a.size(), size_t(1));
+    QVERIFY(a.exists(r24_1));
+    // Numbers beyond the first word, and trailing empty words
+    LocationBitSet c;
+    c.insert(200);
+    c.insert(r24_1);
+    QVERIFY(!(c == a));
+    c.remove(200);
+    QVERIFY(c == a);
+    c.makeIsect(b);
+    QVERIFY(c.empty());
+
+    LocationSet ls;
+    b.toLocationSet(nums, ls);
+    QCOMPARE(ls.size(), size_t(2));
+    QVERIFY(ls.exists(RefExp::get(Location::regOf(25), s1)));
+}
+
+/***************************************************************************/ /**
+  * \fn        CfgTest::testConnectionGraph
+  * OVERVIEW:        Test the interference graph used when translating out of SSA form
+  ******************************************************************************/
+void CfgTest::testConnectionGraph() {
+    Assign *s1 = new Assign, *s2 = new Assign, *s3 = new Assign;
+    Exp *a = RefExp::get(Location::regOf(24), s1);
+    Exp *b = RefExp::get(Location::regOf(24), s2);
+    Exp *c = RefExp::get(Location::regOf(25), s3);
+    ConnectionGraph ig;
+    ig.connect(a, b);
+    ig.connect(b, c);
+    // Equal locations are the same vertex, and connections are not duplicated
+    ig.connect(RefExp::get(Location::regOf(24), s1), b);
+    QCOMPARE(ig.numLocations(), size_t(3));
+    QVERIFY(ig.isConnected(a, *b));
+    QVERIFY(ig.isConnected(b, *a));
+    QVERIFY(ig.isConnected(b, *c));
+    QVERIFY(ig.isConnected(a, *c)); // a takes b's connections
+    QVERIFY(!ig.isConnected(c, *a));
+    QVERIFY(!ig.isConnected(a, *Location::regOf(26)));
+    QCOMPARE(ig.count(a), 2);
+    QCOMPARE(ig.count(b), 2);
+    QCOMPARE(ig.count(c), 1);
+    // Enumerated in lessExpStar order of the first location
+    int n = 0;
+    Exp *prev = nullptr;
+    for (const auto &pr : ig) {
+        QVERIFY(prev == nullptr || !(*pr.first < *prev));
+        prev = pr.first;
+        ++n;
+    }
+    QCOMPARE(n, 5);
+
+    ig.update(b, c, a);
+    QVERIFY(!ig.isConnected(b, *c));
+    QVERIFY(!ig.isConnected(c, *b));
+    QVERIFY(ig.isConnected(a, *b));
+    QCOMPARE(ig.count(b), 1);
+}
+
+/***************************************************************************/ /**
+  * \fn        CfgTest::testFromSSAformTwice
+  * OVERVIEW:        The renamings made by fromSSAform must survive the liveness numbering being cleared, which
+  *                  happens when the interferences are found again
+  ******************************************************************************/
+void CfgTest::testFromSSAformTwice() {
+    Prog *prog = Boomerang::get()->loadAndDecode(FROMSSA2_PENTIUM);
+    QVERIFY(prog != nullptr);
+    prog->decompile(); // Ends with fromSSAform
+    UserProc *proc = (UserProc *)prog->findProc("main");
+    QVERIFY(proc != nullptr && !proc->isLib());
+
+    QString before;
+    QTextStream beforeStream(&before);
+    proc->printSymbolMap(beforeStream);
+    beforeStream.flush();
+    QVERIFY(before.contains(" maps to "));
+
+    proc->fromSSAform(); // Clears the numbering the first call left behind
+    QString after;
+    QTextStream afterStream(&after);
+    proc->printSymbolMap(afterStream);
+    afterStream.flush();
+    for (const QString &line : before.split('\n', QString::SkipEmptyParts))
+        QVERIFY2(after.contains(line), qPrintable(line));
+    delete prog;
+}
+
 QTEST_MAIN(CfgTest)
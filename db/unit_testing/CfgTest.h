@@ -12,4 +12,7 @@ class CfgTest : public QObject {
     void testPlacePhi();
     void testPlacePhi2();
     void testRenameVars();
+    void testLocationBitSet();
+    void testConnectionGraph();
+    void testFromSSAformTwice();
 };
@@ -620,6 +620,66 @@ void ExpTest::testSimplifyBinary() {
     delete e;
 }
 
+/***************************************************************************/ /**
+  * FUNCTION:        ExpTest::testSimplifyMemo
+  * OVERVIEW:        Test that simplified expressions are remembered until they are changed
+  *============================================================================*/
+void ExpTest::testSimplifyMemo() {
+    // (r24 + 0) + r25
+    Exp *e = new Binary(opPlus, new Binary(opPlus, Location::regOf(24), new Const(0)), Location::regOf(25));
+    CPPUNIT_ASSERT(!e->isSimplified());
+    Exp *s = e->simplify();
+    Exp *expected = new Binary(opPlus, Location::regOf(24), Location::regOf(25));
+    CPPUNIT_ASSERT(*s == *expected);
+    CPPUNIT_ASSERT(s->isSimplified());
+    CPPUNIT_ASSERT(s->getSubExp1()->isSimplified());
+    CPPUNIT_ASSERT(s->simplify() == s);
+
+    // Changing a subexpression in place, however deep, means the whole must be simplified again
+    Exp *m = Location::memOf(new Binary(opPlus, Location::regOf(28), new Const(4)))->simplify();
+    CPPUNIT_ASSERT(m->isSimplified());
+    ((Const *)m->getSubExp1()->getSubExp2())->setInt(0);
+    CPPUNIT_ASSERT(!m->isSimplified());
+    CPPUNIT_ASSERT(m->getSubExp1()->getSubExp1()->isSimplified()); // r28 is unchanged
+    m = m->simplify();
+    CPPUNIT_ASSERT(*m == *Location::memOf(Location::regOf(28)));
+
+    m = Location::memOf(new Binary(opPlus, Location::regOf(28), new Const(4)))->simplify();
+    m->getSubExp1()->setSubExp2(new Const(0));
+    CPPUNIT_ASSERT(!m->isSimplified());
+    CPPUNIT_ASSERT(*m->simplify() == *Location::memOf(Location::regOf(28)));
+
+    // A change deeper down is seen through the expressions a modifier rewrites on the way to it
+    Exp *deep = Location::memOf(new Binary(opPlus, Location::regOf(28), new Const(4)))->simplify();
+    CPPUNIT_ASSERT(deep->isSimplified());
+    bool changed;
+    deep = deep->searchReplaceAll(Const(4), new Const(0), changed);
+    CPPUNIT_ASSERT(changed);
+    CPPUNIT_ASSERT(!deep->isSimplified());
+    CPPUNIT_ASSERT(*deep->simplify() == *Location::memOf(Location::regOf(28)));
+
+    s->setSubExp2(new Const(0));
+    CPPUNIT_ASSERT(!s->isSimplified());
+    CPPUNIT_ASSERT(*s->simplify() == *Location::regOf(24));
+
+    // Replacing a subexpression through search and replace
+    s = expected->clone()->simplify();
+    bool change;
+    s = s->searchReplaceAll(*Location::regOf(25), new Const(0), change);
+    CPPUNIT_ASSERT(change);
+    CPPUNIT_ASSERT(!s->isSimplified());
+    CPPUNIT_ASSERT(*s->simplify() == *Location::regOf(24));
+
+    // A subexpression simplified again on its own may have changed since the whole was simplified
+    s = expected->clone()->simplify();
+    Exp *sub = s->getSubExp2();
+    sub->setSubExp1(new Const(26));
+    CPPUNIT_ASSERT(!s->isSimplified());
+    CPPUNIT_ASSERT(sub->simplify() == sub);
+    CPPUNIT_ASSERT(!s->isSimplified());
+    CPPUNIT_ASSERT(s->simplify()->isSimplified());
+}
+
 /***************************************************************************/ /**
   * FUNCTION:        ExpTest::testSimplifyBinary
   * OVERVIEW:        Test the simplifyArith function
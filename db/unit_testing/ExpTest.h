@@ -29,6 +29,7 @@ class ExpTest : public CPPUNIT_NS::TestFixture {
     CPPUNIT_TEST(testSimplifyArith);
     CPPUNIT_TEST(testSimplifyUnary);
     CPPUNIT_TEST(testSimplifyBinary);
+    CPPUNIT_TEST(testSimplifyMemo);
     CPPUNIT_TEST(testSimplifyAddr);
     CPPUNIT_TEST(testSimpConstr);
     CPPUNIT_TEST(testLess);
@@ -86,6 +87,7 @@ class ExpTest : public CPPUNIT_NS::TestFixture {
     void testSimplifyArith();
     void testSimplifyUnary();
     void testSimplifyBinary();
+    void testSimplifyMemo();
     void testSimplifyAddr();
     void testSimpConstr();
 
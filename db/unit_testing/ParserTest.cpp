@@ -5,15 +5,18 @@
   ******************************************************************************/
 #include "ParserTest.h"
 #include "sslparser.h"
+#include "statement.h"
 #include "log.h"
 #include "boomerang.h"
 
 #include <QtCore/QDir>
 #include <QtCore/QProcessEnvironment>
 #include <QtCore/QDebug>
+#include <QtCore/QTemporaryDir>
 
 
 #define SPARC_SSL Boomerang::get()->getProgPath() + "frontend/machine/sparc/sparc.ssl"
+#define PENTIUM_SSL Boomerang::get()->getProgPath() + "frontend/machine/pentium/pentium.ssl"
 static bool logset = false;
 static QString TEST_BASE;
 static QDir baseDir;
@@ -64,4 +67,63 @@ void ParserTest::testExp() {
     QCOMPARE(res,"   0 " + s);
 }
 
+/***************************************************************************/ /**
+  * \fn        ParserTest::testCompiledTemplates
+  * OVERVIEW:        Test that instantiating a precompiled template gives the same statements as substituting the
+  *                  formals into the original template
+  ******************************************************************************/
+void ParserTest::testCompiledTemplates() {
+    RTLInstDict d;
+    QVERIFY(d.readSSLFile(PENTIUM_SSL));
+    for (auto &elem : d.idict) {
+        TableEntry &entry(elem.second);
+        QVERIFY(entry.isCompiled);
+        // r28 is %esp, so this also covers operands aliasing the base of a post-variable
+        std::vector<Exp *> actuals;
+        for (unsigned i = 0; i < entry.params.size(); i++)
+            actuals.push_back(Location::regOf(28));
+        std::list<Instruction *> *expected = d.instantiateRTL(entry.rtl, ADDRESS::g(0x1000), entry.params, actuals);
+        std::list<Instruction *> *actual = d.instantiateRTL(entry, ADDRESS::g(0x1000), actuals);
+        QString exp_str, act_str;
+        QTextStream exp_ost(&exp_str), act_ost(&act_str);
+        for (Instruction *s : *expected)
+            exp_ost << s << "\n";
+        for (Instruction *s : *actual)
+            act_ost << s << "\n";
+        QCOMPARE(act_str, exp_str);
+    }
+}
+
+/***************************************************************************/ /**
+  * \fn        ParserTest::testSSLCache
+  * OVERVIEW:        Test that a dictionary read back from its binary cache is the same as the parsed one, and that a
+  *                  cache for different .ssl contents is rejected
+  ******************************************************************************/
+void ParserTest::testSSLCache() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString cacheName = dir.path() + "/sparc.ssl.cache";
+    Boomerang::get()->noSSLCache = true;
+    RTLInstDict parsed;
+    QVERIFY(parsed.readSSLFile(SPARC_SSL));
+    Boomerang::get()->noSSLCache = false;
+    QByteArray hash = RTLInstDict::sslFileHash(SPARC_SSL);
+    QVERIFY(!hash.isEmpty());
+    QVERIFY(parsed.writeCache(cacheName, hash));
+
+    RTLInstDict cached;
+    QVERIFY(cached.readCache(cacheName, hash));
+    QString parsed_str, cached_str;
+    QTextStream parsed_ost(&parsed_str), cached_ost(&cached_str);
+    parsed.print(parsed_ost);
+    cached.print(cached_ost);
+    QCOMPARE(cached_str, parsed_str);
+    QCOMPARE(cached.bigEndian, parsed.bigEndian);
+    QCOMPARE(cached.OpcodeTable.size(), parsed.OpcodeTable.size());
+    QCOMPARE(cached.getOpcodeId("ADD"), parsed.getOpcodeId("ADD"));
+
+    QVERIFY(!cached.readCache(cacheName, RTLInstDict::sslFileHash(PENTIUM_SSL)));
+    QVERIFY(cached.idict.empty());
+}
+
 QTEST_MAIN(ParserTest)
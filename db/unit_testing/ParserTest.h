@@ -5,5 +5,7 @@ class ParserTest : public QObject {
   private slots:
     void testRead();
     void testExp();
+    void testCompiledTemplates();
+    void testSSLCache();
     void initTestCase();
 };
@@ -16,6 +16,7 @@
 #include "visitor.h"
 #include "log.h"
 #include "boomerang.h"
+#include "arena.h"
 
 #include <sstream>
 
@@ -293,4 +294,84 @@ void RtlTest::testSetConscripts() {
     QCOMPARE(actual,expected);
 }
 
+/***************************************************************************/ /**
+  * \fn        RtlTest::testHashCons
+  * OVERVIEW:        Test sharing expressions with Exp::hashCons, and that ordering them is unchanged
+  ******************************************************************************/
+void RtlTest::testHashCons() {
+    Assign *s1 = new Assign, *s2 = new Assign;
+    // m[r28{1} - 4]
+    Exp *a = Location::memOf(new Binary(opMinus, new RefExp(Location::regOf(28), s1), new Const(4)));
+    Exp *b = a->clone();
+    Exp *ca = a->hashCons();
+    QVERIFY(ca != a);
+    QVERIFY(ca->isHashConsed());
+    QVERIFY(!a->isHashConsed());
+    QVERIFY(*ca == *a);
+    QCOMPARE(b->hashCons(), ca);
+    QCOMPARE(ca->hashCons(), ca);
+    // Subexpressions are shared too
+    QCOMPARE(ca->getSubExp1()->getSubExp1(), (new RefExp(Location::regOf(28), s1))->hashCons());
+    // A different definition is a different expression
+    Exp *c = Location::memOf(new Binary(opMinus, new RefExp(Location::regOf(28), s2), new Const(4)));
+    QVERIFY(c->hashCons() != ca);
+    // Clones of shared expressions can be changed
+    Exp *d = ca->clone();
+    QVERIFY(!d->isHashConsed());
+    ((Const *)d->getSubExp1()->getSubExp2())->setInt(8);
+    QVERIFY(!(*d == *ca));
+    // Wildcards and typed expressions are never shared
+    Exp *w = new RefExp(Location::regOf(28), (Instruction *)-1);
+    QVERIFY(!w->hashCons()->isHashConsed());
+    Exp *t = new TypedExp(IntegerType::get(32), Location::regOf(24));
+    QVERIFY(!t->hashCons()->isHashConsed());
+
+    // Order is the same with or without sharing
+    lessExpStar less;
+    QVERIFY(!less(ca, ca));
+    QCOMPARE(less(ca, c), less(a, c));
+    QCOMPARE(less(c, ca), less(c, a));
+    QVERIFY(less(a, d) != less(d, a));
+    QCOMPARE(less(ca, d), less(a, d));
+    // A wildcard definition compares equal to any other
+    QVERIFY(!less(w, new RefExp(Location::regOf(28), s1)));
+    QVERIFY(!less(new RefExp(Location::regOf(28), s1), w));
+}
+
+/***************************************************************************/ /**
+  * \fn        RtlTest::testProcArena
+  * OVERVIEW:        Test allocating expressions, statements and RTLs in a ProcArena
+  ******************************************************************************/
+void RtlTest::testProcArena() {
+    ProcArena *arena = new ProcArena;
+    Exp *heapExp = Location::regOf(24), *heapExp2;
+    RTL *rtl;
+    Assign *as;
+    {
+        ProcArena::Scope scope(arena);
+        as = new Assign(Location::regOf(24), new Binary(opPlus, Location::regOf(25), new Const(1)));
+        rtl = new RTL(ADDRESS::g(0x1000));
+        rtl->appendStmt(as);
+        {
+            ProcArena::Scope heap(nullptr);
+            Exp *e = new Const(2); // Not in the arena
+            delete e;
+        }
+        heapExp2 = ProcArena::onHeap([] { return Location::regOf(25); }); // Nor is this
+    }
+    // 2 Locations, the Binary and 2 Consts (one for r24, one for r25), and 1, the Assign and the RTL
+    QCOMPARE(arena->allocations(), size_t(8));
+    QCOMPARE(arena->frees(), size_t(0));
+    QVERIFY(arena->slabCount() >= 1);
+    QCOMPARE(rtl->getHlStmt(), (Instruction *)as);
+    QVERIFY(*as->getLeft() == *heapExp);
+    // Deleting arena memory is only counted; deleting heap memory still frees it
+    delete as->getRight();
+    delete heapExp;
+    delete heapExp2->getSubExp1();
+    delete heapExp2;
+    QCOMPARE(arena->frees(), size_t(1));
+    delete arena;
+}
+
 QTEST_MAIN(RtlTest)
@@ -6,5 +6,7 @@ class RtlTest : public QObject {
     void testClone();
     void testVisitor();
     void testSetConscripts();
+    void testHashCons();
+    void testProcArena();
     void initTestCase();
 };
@@ -3,6 +3,64 @@
 #include "boomerang.h"
 #include "log.h"
 #include "cfg.h"
+#include "IBinaryImage.h"
+
+namespace {
+const uint32_t MAX_BITMAP_SIZE = 1 << 28; // Beyond this text size, use the set for everything
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief   Empty the queue, and size the bitmap of queued addresses for the current text section.
+  *          Called before decoding a procedure; targets left behind by an abandoned (speculative) decode belong to
+  *          another procedure.
+  ******************************************************************************/
+void TargetQueue::clear() {
+    targets = decltype(targets)();
+    batch.clear();
+    batchPos = 0;
+    clearMarks();
+    IBinaryImage *image = Boomerang::get()->getImage();
+    if (image == nullptr)
+        return;
+    ADDRESS low = image->getLimitTextLow();
+    ADDRESS high = image->getLimitTextHigh();
+    if (low == textLow && high == textHigh)
+        return;
+    textLow = low;
+    textHigh = high;
+    if (high > low && (high - low).m_value < MAX_BITMAP_SIZE)
+        queued.assign((high - low).m_value, false);
+    else
+        queued.clear();
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief   Record that the address a has been queued
+  * \returns false if it had been queued already
+  ******************************************************************************/
+bool TargetQueue::markQueued(ADDRESS a) {
+    if (a >= textLow && (a - textLow).m_value < queued.size()) {
+        std::vector<bool>::reference bit = queued[(a - textLow).m_value];
+        if (bit)
+            return false;
+        bit = true;
+        marked.push_back(a);
+        return true;
+    }
+    return queuedOutside.insert(a).second;
+}
+
+void TargetQueue::clearMarks() {
+    for (ADDRESS a : marked)
+        queued[(a - textLow).m_value] = false;
+    marked.clear();
+    queuedOutside.clear();
+}
+
+//! If no label there at all, or if there is a BB, it's incomplete, then we can parse this address next
+bool TargetQueue::needsDecode(const Cfg &cfg, ADDRESS a) { return !cfg.existsBB(a) || cfg.isIncomplete(a); }
 
 /***************************************************************************/ /**
   *
@@ -19,9 +77,8 @@
 void TargetQueue::visit(Cfg *pCfg, ADDRESS uNewAddr, BasicBlock *&pNewBB) {
     // Find out if we've already parsed the destination
     bool bParsed = pCfg->label(uNewAddr, pNewBB);
-    // Add this address to the back of the local queue,
-    // if not already processed
-    if (!bParsed) {
+    // Add this address to the local queue, if not already processed or queued
+    if (!bParsed && markQueued(uNewAddr)) {
         targets.push(uNewAddr);
         if (Boomerang::get()->traceDecoder)
             LOG << ">" << uNewAddr << "\t";
@@ -36,6 +93,27 @@ void TargetQueue::visit(Cfg *pCfg, ADDRESS uNewAddr, BasicBlock *&pNewBB) {
   ******************************************************************************/
 void TargetQueue::initial(ADDRESS uAddr) { targets.push(uAddr); }
 
+/***************************************************************************/ /**
+  *
+  * \brief   Take a run of up to maxCount targets that still need decoding off the queue, lowest address first
+  * \note    Decoding one of them may decode (some of) the others, so the caller should check them again
+  * \param   cfg - the enclosing CFG
+  * \param   run - set to the targets taken
+  * \returns The number of targets taken; 0 if the queue is empty
+  ******************************************************************************/
+size_t TargetQueue::nextAddresses(const Cfg &cfg, std::vector<ADDRESS> &run, size_t maxCount) {
+    run.clear();
+    while (!targets.empty() && run.size() < maxCount) {
+        ADDRESS address = targets.top();
+        targets.pop();
+        if (Boomerang::get()->traceDecoder)
+            LOG << "<" << address << "\t";
+        if ((run.empty() || run.back() != address) && needsDecode(cfg, address))
+            run.push_back(address);
+    }
+    return run.size();
+}
+
 /***************************************************************************/ /**
   *
   * \brief   Return the next target from the queue of non-processed
@@ -45,16 +123,19 @@ void TargetQueue::initial(ADDRESS uAddr) { targets.push(uAddr); }
   *          (targets is empty)
   ******************************************************************************/
 ADDRESS TargetQueue::nextAddress(const Cfg &cfg) {
-    while (!targets.empty()) {
-        ADDRESS address = targets.front();
-        targets.pop();
-        if (Boomerang::get()->traceDecoder)
-            LOG << "<" << address << "\t";
-
-        // If no label there at all, or if there is a BB, it's incomplete, then we can parse this address next
-        if (!cfg.existsBB(address) || cfg.isIncomplete(address))
-            return address;
+    for (;;) {
+        while (batchPos < batch.size()) {
+            ADDRESS address = batch[batchPos++];
+            // It may have been decoded since, as part of an earlier target of the batch
+            if (needsDecode(cfg, address))
+                return address;
+        }
+        batchPos = 0;
+        if (nextAddresses(cfg, batch) == 0)
+            break;
     }
+    // Everything queued has been processed; the addresses can be queued again (e.g. for the next procedure)
+    clearMarks();
     return NO_ADDRESS;
 }
 
@@ -62,9 +143,11 @@ ADDRESS TargetQueue::nextAddress(const Cfg &cfg) {
  * Print (for debugging)
  */
 void TargetQueue::dump() {
-    std::queue<ADDRESS> copy(targets);
+    for (size_t i = batchPos; i < batch.size(); ++i)
+        LOG_STREAM() << batch[i] << ", ";
+    decltype(targets) copy(targets);
     while (!copy.empty()) {
-        ADDRESS a = copy.front();
+        ADDRESS a = copy.top();
         copy.pop();
         LOG_STREAM() << a << ", ";
     }
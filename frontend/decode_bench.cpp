@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2016, The Boomerang team
+ *
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL
+ * WARRANTIES.
+ *
+ */
+
+/***************************************************************************/ /**
+  * \file       decode_bench.cpp
+  * \brief   Decoder throughput benchmark.
+  *
+  * Loads every binary in tests/inputs/<arch>/ and decodes all the bytes of its code sections, one instruction
+  * after the other, with NJMCDecoder::decodeInstruction (and so RTLInstDict::instantiateRTL) only: no CFG is
+  * built and nothing is decompiled. One JSON object per line is written to stdout for each binary and a total
+  * for each architecture, e.g.
+  * {"arch":"pentium","binary":"hello","instructions":1234,"bytes":4096,"seconds":0.01,"instsPerSec":123400,
+  *  "bytesPerSec":409600,"allocsPerInst":21.5,"allocsCounted":"malloc","peakRssKb":20480}
+  * allocsCounted says what allocsPerInst counts: every malloc, calloc and realloc (with glibc), or only C++
+  * operator new elsewhere.
+  *
+  * Usage: decode_bench [-P <boomerang path>] [-i <inputs dir>] [-r <repeats>] [arch...]
+  ******************************************************************************/
+
+#include "boomerang.h"
+#include "prog.h"
+#include "frontend.h"
+#include "decoder.h"
+#include "rtl.h"
+#include "log.h"
+#include "BinaryFile.h"
+#include "IBinaryImage.h"
+#include "IBinarySection.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+void init_sslparser();
+void init_basicblock();
+
+// Count every allocation, to report allocations per decoded instruction
+static std::atomic<size_t> numAllocs(0);
+
+#ifdef __GLIBC__
+// Qt (QString, QArrayData) allocates with malloc, not operator new, so count the malloc family itself. The
+// definitions here take the place of the C library's for the whole process, Qt included; operator new calls malloc
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *p, size_t size);
+
+void *malloc(size_t size) {
+    ++numAllocs;
+    return __libc_malloc(size);
+}
+void *calloc(size_t n, size_t size) {
+    ++numAllocs;
+    return __libc_calloc(n, size);
+}
+void *realloc(void *p, size_t size) {
+    ++numAllocs;
+    return __libc_realloc(p, size);
+}
+}
+static const char *const allocsCounted = "malloc";
+#else
+// Elsewhere only C++ allocations are counted; malloc (and so most of Qt's allocation) is not
+void *operator new(size_t size) {
+    ++numAllocs;
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+static const char *const allocsCounted = "new";
+#endif
+
+namespace {
+struct BenchResult {
+    size_t instructions = 0;
+    size_t bytes = 0;
+    size_t allocs = 0;
+    double seconds = 0;
+
+    void add(const BenchResult &other) {
+        instructions += other.instructions;
+        bytes += other.bytes;
+        allocs += other.allocs;
+        seconds += other.seconds;
+    }
+};
+
+//! Peak resident set size of this process in kilobytes (0 if unknown)
+long peakRssKb() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
+
+void report(QTextStream &out, const QString &arch, const QString &binary, const BenchResult &res) {
+    QJsonObject obj;
+    obj["arch"] = arch;
+    obj["binary"] = binary;
+    obj["instructions"] = double(res.instructions);
+    obj["bytes"] = double(res.bytes);
+    obj["seconds"] = res.seconds;
+    obj["instsPerSec"] = res.seconds > 0 ? res.instructions / res.seconds : 0.;
+    obj["bytesPerSec"] = res.seconds > 0 ? res.bytes / res.seconds : 0.;
+    obj["allocsPerInst"] = res.instructions ? double(res.allocs) / res.instructions : 0.;
+    obj["allocsCounted"] = QLatin1String(allocsCounted);
+    obj["peakRssKb"] = double(peakRssKb());
+    out << QJsonDocument(obj).toJson(QJsonDocument::Compact) << "\n";
+    out.flush();
+}
+
+//! Decode all code bytes of the binary fname repeats times; returns false if it can't be loaded
+bool benchBinary(const QString &fname, int repeats, BenchResult &res) {
+    BinaryFileFactory bff;
+    QObject *pBF = bff.Load(fname);
+    if (pBF == nullptr)
+        return false;
+    Prog *prog = new Prog(fname);
+    FrontEnd *fe = FrontEnd::instantiate(pBF, prog, &bff);
+    if (fe == nullptr) {
+        delete prog;
+        return false;
+    }
+    prog->setFrontEnd(fe);
+    NJMCDecoder *decoder = fe->getDecoder();
+    // Where an instruction can't be decoded, carry on at the next possible instruction start
+    int step = (fe->getFrontEndId() == PLAT_PENTIUM || fe->getFrontEndId() == PLAT_ST20) ? 1 : 4;
+
+    IBinaryImage *image = Boomerang::get()->getImage();
+    DecodeResult inst;
+    for (int r = 0; r < repeats; ++r) {
+        for (const IBinarySection *sect : *image) {
+            if (!sect->isCode() || sect->size() == 0 || sect->hostAddr().isZero())
+                continue;
+            ptrdiff_t delta = (sect->hostAddr() - sect->sourceAddr()).m_value;
+            ADDRESS end = sect->sourceAddr() + sect->size();
+            size_t allocsBefore = numAllocs;
+            auto start = std::chrono::steady_clock::now();
+            for (ADDRESS pc = sect->sourceAddr(); pc < end;) {
+                decoder->decodeInstruction(pc, delta, inst);
+                if (inst.reDecode) {
+                    // Another pass over the same instruction (e.g. Pentium BSF/BSR), as FrontEnd::processProc makes
+                    delete inst.rtl;
+                    continue;
+                }
+                if (inst.valid && inst.numBytes > 0) {
+                    ++res.instructions;
+                    res.bytes += inst.numBytes;
+                    pc += inst.numBytes;
+                } else
+                    pc += step;
+                delete inst.rtl;
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            res.seconds += elapsed.count();
+            res.allocs += numAllocs - allocsBefore;
+        }
+    }
+    delete fe;
+    return true;
+}
+}
+
+int main(int argc, char *argv[]) {
+    init_sslparser();
+    init_basicblock();
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QString progPath = QCoreApplication::applicationDirPath();
+    QString inputs;
+    int repeats = 1;
+    QStringList archs;
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "-P" && i + 1 < args.size())
+            progPath = args[++i];
+        else if (args[i] == "-i" && i + 1 < args.size())
+            inputs = args[++i];
+        else if (args[i] == "-r" && i + 1 < args.size())
+            repeats = std::max(1, args[++i].toInt());
+        else if (args[i].startsWith('-')) {
+            err << "Usage: decode_bench [-P <boomerang path>] [-i <inputs dir>] [-r <repeats>] [arch...]\n";
+            return 1;
+        } else
+            archs << args[i];
+    }
+    if (inputs.isEmpty())
+        inputs = progPath + "/../tests/inputs";
+    if (archs.isEmpty())
+        archs << "pentium"
+              << "sparc"
+              << "ppc"
+              << "st20"
+              << "mips";
+
+    Boomerang *boom = Boomerang::get();
+    boom->setProgPath(progPath);
+    boom->setPluginPath(progPath);
+    boom->setLogger(new NullLogger());
+
+    for (const QString &arch : archs) {
+        QDir dir(inputs + "/" + arch);
+        if (!dir.exists()) {
+            err << "no inputs for " << arch << " in " << dir.absolutePath() << "\n";
+            continue;
+        }
+        BenchResult total;
+        for (const QFileInfo &fi : dir.entryInfoList(QDir::Files, QDir::Name)) {
+            BenchResult res;
+            if (!benchBinary(fi.absoluteFilePath(), repeats, res)) {
+                err << "could not load " << fi.absoluteFilePath() << "\n";
+                continue;
+            }
+            report(out, arch, fi.fileName(), res);
+            total.add(res);
+        }
+        report(out, arch, "*", total);
+    }
+    return 0;
+}
@@ -45,10 +45,17 @@
 #include <cstring>
 #include <cstdlib>
 #include <queue>
+#include <deque>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <cstdarg> // For varargs
 #include <sstream>
 
 using namespace std;
+
+
 /***************************************************************************/ /**
   *
   * \brief      Construct the FrontEnd object
@@ -122,6 +129,8 @@ void FrontEnd::AddSymbol(ADDRESS addr, const QString &nam) {
 }
 // destructor
 FrontEnd::~FrontEnd() {
+    for (auto &cached : decodeCache)
+        delete cached.second.rtl;
     if (pbff)
         pbff->UnLoad(); // Unload the BinaryFile library with dlclose() or FreeLibrary()
 }
@@ -329,6 +338,9 @@ void FrontEnd::decode(Prog *prg, ADDRESS a) {
         p->setDecoded();
 
     } else { // a == NO_ADDRESS
+        if (Boomerang::get()->numDecodeThreads > 1)
+            decodeInParallel(Boomerang::get()->numDecodeThreads);
+        // Sequential sweep; after a parallel decode it finds most instructions in the decode cache
         bool change = true;
         while (change) {
             change = false;
@@ -359,6 +371,156 @@ void FrontEnd::decode(Prog *prg, ADDRESS a) {
     Program->wellForm();
 }
 
+namespace {
+//! Work list of procedure entry addresses shared by the decoding threads. Each address is queued at most once.
+class ProcDecodeQueue {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<ADDRESS> pending;
+    std::set<ADDRESS> queued;
+    int busy = 0; // Number of procedures currently being decoded
+
+  public:
+    void push(ADDRESS entry) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!queued.insert(entry).second)
+            return;
+        pending.push_back(entry);
+        cond.notify_one();
+    }
+    //! Wait for a procedure to decode; returns NO_ADDRESS once nothing is pending and no thread can add more
+    ADDRESS pop() {
+        std::unique_lock<std::mutex> guard(mutex);
+        cond.wait(guard, [this] { return !pending.empty() || busy == 0; });
+        if (pending.empty())
+            return NO_ADDRESS;
+        ADDRESS entry = pending.front();
+        pending.pop_front();
+        ++busy;
+        return entry;
+    }
+    //! Called when a procedure returned by pop() is done and its callees have been pushed
+    void done() {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (--busy == 0 && pending.empty())
+            cond.notify_all();
+    }
+};
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief Decode the instructions of all undecoded user procedures, and (unless -nc was given) of the callees they
+  * discover, using \a numThreads threads, so that decodeCachedInstruction() finds them in the decode cache.
+  * Only the decoder runs in parallel: it is re-entrant and the decode cache is guarded. The threads create no
+  * procedures (see NJMCDecoder::DeferNewProcs); those for call destinations are created by the sequential sweep in
+  * decode() as it reaches each call, so the procedure list and the numbered names are the same as without -j.
+  * Building the CFGs (processProc) touches LibrarySignatures, refHints, the globals, symbols and the watchers, so it
+  * is left to that sweep too.
+  * \note The instructions of a procedure are found by following its fixed jumps and branches; computed jumps are
+  * left for processProc
+  * \param numThreads - number of worker threads
+  ******************************************************************************/
+void FrontEnd::decodeInParallel(int numThreads) {
+    ProcDecodeQueue work;
+    bool decodeChildren = !Boomerang::get()->noDecodeChildren;
+    {
+        std::lock_guard<std::recursive_mutex> guard(Program->getProcsMutex());
+        for (Module *m : *Program) {
+            for (Function *pProc : *m) {
+                if (!pProc->isLib() && !((UserProc *)pProc)->isDecoded())
+                    work.push(pProc->getNativeAddress());
+            }
+        }
+    }
+    auto worker = [this, &work, decodeChildren]() {
+        NJMCDecoder::DeferNewProcs deferProcs;
+        ADDRESS entry;
+        while ((entry = work.pop()) != NO_ADDRESS) {
+            std::vector<ADDRESS> callees;
+            decodeProcInstructions(entry, callees);
+            if (decodeChildren) {
+                for (ADDRESS dest : callees) {
+                    // Most callees have no procedure yet; leave out the ones that will be library procedures
+                    const IBinarySymbol *sym = BinarySymbols->find(dest);
+                    if (sym && (sym->isImportedFunction() || sym->isStaticFunction()))
+                        continue;
+                    Function *callee = Program->findProc(dest);
+                    if (callee == (Function *)-1 ||
+                        (callee != nullptr && (callee->isLib() || ((UserProc *)callee)->isDecoded())))
+                        continue;
+                    work.push(dest);
+                }
+            }
+            work.done();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i)
+        threads.emplace_back(worker);
+    for (std::thread &t : threads)
+        t.join();
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief Decode (into the decode cache) the instructions reachable from \a entry through fixed jumps and
+  * branches, without building a CFG. Used by the decoding threads of decodeInParallel().
+  * \param entry - native address of the procedure
+  * \param callees - receives the fixed destinations of the calls found
+  ******************************************************************************/
+void FrontEnd::decodeProcInstructions(ADDRESS entry, std::vector<ADDRESS> &callees) {
+    std::vector<ADDRESS> targets{entry};
+    std::set<ADDRESS> seen{entry};
+    auto addTarget = [&targets, &seen](ADDRESS a) {
+        if (a != NO_ADDRESS && seen.insert(a).second)
+            targets.push_back(a);
+    };
+    while (!targets.empty()) {
+        ADDRESS uAddr = targets.back();
+        targets.pop_back();
+        bool sequentialDecode = true;
+        while (sequentialDecode) {
+            DecodeResult inst;
+            inst.reset();
+            if (!decodeCachedInstruction(uAddr, inst) || inst.numBytes <= 0) {
+                delete inst.rtl;
+                break;
+            }
+            if (inst.rtl != nullptr) {
+                for (Instruction *s : *inst.rtl) {
+                    switch (s->getKind()) {
+                    case STMT_GOTO:
+                        addTarget(((GotoStatement *)s)->getFixedDest());
+                        sequentialDecode = false;
+                        break;
+                    case STMT_BRANCH:
+                        addTarget(((GotoStatement *)s)->getFixedDest());
+                        break;
+                    case STMT_CALL:
+                        if (((GotoStatement *)s)->getFixedDest() != NO_ADDRESS)
+                            callees.push_back(((GotoStatement *)s)->getFixedDest());
+                        break;
+                    case STMT_CASE:
+                    case STMT_RET:
+                        sequentialDecode = false;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+                delete inst.rtl;
+            }
+            if (inst.reDecode)
+                continue; // Finish the passes over this instruction, as processProc will
+            uAddr += inst.numBytes;
+            // Stop where another path has already been (or will be) decoded
+            if (sequentialDecode && !seen.insert(uAddr).second)
+                break;
+        }
+    }
+}
+
 //! \a a should be the address of an UserProc
 void FrontEnd::decodeOnly(Prog *prg, ADDRESS a) {
     assert(Program == prg);
@@ -377,17 +539,68 @@ void FrontEnd::decodeFragment(UserProc *proc, ADDRESS a) {
     processProc(a, proc, os, true);
 }
 
-DecodeResult &FrontEnd::decodeInstruction(ADDRESS pc) {
-    if (!Image || Image->getSectionInfoByAddr(pc) == nullptr) {
+/***************************************************************************/ /**
+  * \brief      Decode the instruction at the given address into a caller owned result
+  * \param      pc - native address of the instruction
+  * \param      result - receives the decoded instruction
+  * \returns    result.valid
+  ******************************************************************************/
+bool FrontEnd::decodeInstruction(ADDRESS pc, DecodeResult &result) {
+    const uint8_t *host = Image ? Image->readSpan(pc, 1) : nullptr;
+    if (host == nullptr) {
         LOG << "ERROR: attempted to decode outside any known section " << pc << "\n";
-        static DecodeResult invalid;
-        invalid.reset();
-        invalid.valid = false;
-        return invalid;
+        result.reset();
+        result.valid = false;
+        return false;
+    }
+    ptrdiff_t host_native_diff = (ADDRESS::host_ptr(host) - pc).m_value;
+    return decoder->decodeInstruction(pc, host_native_diff, result);
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief Decode the instruction at \a pc, reusing the result of an earlier decode of the same address.
+  * Procedures are re-decoded from scratch whenever analysis finds new code (e.g. a switch statement), so this
+  * saves running the decoder again over the instructions already seen. The caller owns result.rtl, which is a
+  * clone of the cached RTL. Instructions which need re-decoding at the same address (result.reDecode) are
+  * never cached.
+  * \param pc - native address of the instruction
+  * \param result - the decoded instruction
+  * \returns result.valid
+  ******************************************************************************/
+bool FrontEnd::decodeCachedInstruction(ADDRESS pc, DecodeResult &result) {
+    bool cached = false;
+    {
+        std::lock_guard<std::mutex> guard(decodeCacheMutex);
+        auto ff = decodeCache.find(pc);
+        if (ff != decodeCache.end() && ff->second.rtl != nullptr) {
+            result = ff->second;
+            result.rtl = ff->second.rtl->clone();
+            cached = true;
+        }
     }
-    const IBinarySection *pSect = Image->getSectionInfoByAddr(pc);
-    ptrdiff_t host_native_diff = (pSect->hostAddr() - pSect->sourceAddr()).m_value;
-    return decoder->decodeInstruction(pc, host_native_diff);
+    if (cached) {
+        // A call decoded by a thread of decodeInParallel() has no procedure yet. It is created here, where the
+        // sequential decode reaches the call, so procedures are created and numbered as they are without -j
+        if (result.callDest != NO_ADDRESS && !NJMCDecoder::DeferNewProcs::active()) {
+            Function *destProc = Program->setNewProc(result.callDest);
+            for (Instruction *s : *result.rtl)
+                if (s->getKind() == STMT_CALL && ((CallStatement *)s)->getFixedDest() == result.callDest)
+                    ((CallStatement *)s)->setDestProc(destProc);
+            result.callDest = NO_ADDRESS;
+        }
+        return result.valid;
+    }
+    if (!decodeInstruction(pc, result))
+        return false;
+    DecodeResult entry = result;
+    // The decoder result is modified by processProc, so keep a copy
+    entry.rtl = (result.reDecode || result.rtl == nullptr) ? nullptr : result.rtl->clone();
+    std::lock_guard<std::mutex> guard(decodeCacheMutex);
+    // An uncacheable entry stays uncacheable (e.g. the later passes of a Pentium BSF/BSR)
+    if (!decodeCache.emplace(pc, entry).second)
+        delete entry.rtl;
+    return true;
 }
 
 /***************************************************************************/ /**
@@ -495,8 +708,9 @@ bool FrontEnd::refersToImportedFunction(Exp *pDest)
   *  in the FrontEnd derived class, sometimes calling this function to do most of the work.
   * \returns          true for a good decode (no illegal instructions)
   ******************************************************************************/
-bool FrontEnd::processProc(ADDRESS uAddr, UserProc *pProc, QTextStream &/*os*/, bool /*frag*/ /* = false */,
+bool FrontEnd::processProc(ADDRESS uAddr, UserProc *pProc, QTextStream &/*os*/, bool frag /* = false */,
                            bool spec /* = false */) {
+    ProcArena::Scope arenaScope(pProc->getArena()); // The proc's RTLs and statements go in its arena
     BasicBlock *pBB; // Pointer to the current basic block
 
     // just in case you missed it
@@ -518,7 +732,10 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc *pProc, QTextStream &/*os*/,
         return false;
     assert(pCfg);
 
-    // Initialise the queue of control flow targets that have yet to be decoded.
+    // Initialise the queue of control flow targets that have yet to be decoded. A fragment (e.g. a switch arm) is
+    // decoded while its procedure is being decoded, and shares its queue
+    if (!frag)
+        targetQueue.clear();
     targetQueue.initial(uAddr);
 
     // Clear the pointer used by the caller prologue code to access the last call rtl of this procedure
@@ -541,8 +758,8 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc *pProc, QTextStream &/*os*/,
             if (Boomerang::get()->traceDecoder)
                 LOG << "*" << uAddr << "\t";
 
-            // Decode the inst at uAddr.
-            inst = decodeInstruction(uAddr);
+            // Decode the inst at uAddr (or reuse the RTL from a previous decode of this procedure)
+            decodeCachedInstruction(uAddr, inst);
             if(!inst.valid || inst.rtl->empty()) {
                 qDebug() << "Valid but undecoded instruction at " << QString::number(uAddr.m_value,16);
             }
@@ -585,9 +802,8 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc *pProc, QTextStream &/*os*/,
             // Check if this is an already decoded jump instruction (from a previous pass with propagation etc)
             // If so, we throw away the just decoded RTL (but we still may have needed to calculate the number
             // of bytes.. ick.)
-            std::map<ADDRESS, RTL *>::iterator ff = previouslyDecoded.find(uAddr);
-            if (ff != previouslyDecoded.end())
-                pRtl = ff->second;
+            if (RTL *prev = findDecodedRtl(uAddr))
+                pRtl = prev;
 
             if (pRtl == nullptr) {
                 // This can happen if an instruction is "cancelled", e.g. call to __main in a hppa program
@@ -800,7 +1016,8 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc *pProc, QTextStream &/*os*/,
                         // It should not be in the PLT either, but getLimitTextHigh() takes this into account
                         if (callAddr < Image->getLimitTextHigh()) {
                             // Decode it.
-                            DecodeResult decoded = decodeInstruction(callAddr);
+                            DecodeResult decoded;
+                            decodeInstruction(callAddr, decoded);
                             if (decoded.valid && !decoded.rtl->empty()) { // is the instruction decoded succesfully?
                                 // Yes, it is. Create a Statement from it.
                                 RTL *rtl = decoded.rtl;
@@ -1001,6 +1218,7 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc *pProc, QTextStream &/*os*/,
     //      w->alert_done(pProc, initAddr, lastAddr, nTotalBytes);
 
     // Add the callees to the set of CallStatements, and also to the Prog object
+    std::lock_guard<std::recursive_mutex> guard(Program->getProcsMutex());
     std::list<CallStatement *>::iterator it;
     for (it = callList.begin(); it != callList.end(); it++) {
         ADDRESS dest = (*it)->getFixedDest();
@@ -1040,7 +1258,8 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc *pProc, QTextStream &/*os*/,
   * \returns    a pointer to the decoded RTL
   ******************************************************************************/
 RTL *decodeRtl(ADDRESS address, int delta, NJMCDecoder *decoder) {
-    DecodeResult inst = decoder->decodeInstruction(address, delta);
+    DecodeResult inst;
+    decoder->decodeInstruction(address, delta, inst);
     RTL *rtl = inst.rtl;
     return rtl;
 }
@@ -74,14 +74,14 @@ int MIPSDecoder::decodeAssemblyInstruction(ADDRESS, int)
  *					 in the loaded object file)
  *				   proc - the enclosing procedure. This can be NULL for
  *					 those of us who are using this method in an interpreter
- * RETURNS:		   a DecodeResult structure containing all the information
+ *				   result - caller owned; receives all the information
  *					 gathered during decoding
+ * RETURNS:		   result.valid
  *********************************************************************************/
 
 // Stub from PPC...
-DecodeResult& MIPSDecoder::decodeInstruction(ADDRESS pc, int delta)
+bool MIPSDecoder::decodeInstruction(ADDRESS pc, int delta, DecodeResult &result)
 { 
-static DecodeResult result;
 ADDRESS hostPC = pc+delta;
 
 // Clear the result structure;
@@ -92,5 +92,5 @@ std::list<Statement*>* stmts = NULL;
 
 ADDRESS nextPC = NO_ADDRESS;
 
-return result;
+return result.valid;
 }
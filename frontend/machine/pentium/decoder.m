@@ -69,7 +69,7 @@
 // Function to generate statements for the BSF/BSR series (Bit Scan Forward/
 // Reverse)
 void genBSFR(ADDRESS pc, Exp* reg, Exp* modrm, int init, int size, OPER incdec,
-	int numBytes);
+	int numBytes, DecodeResult& result);
 
 /**********************************
  * PentiumDecoder methods.
@@ -96,10 +96,10 @@ void PentiumDecoder::unused(int x)
  *				   RTLDict - the dictionary of RTL templates used to instantiate the RTL for the instruction being
  *					decoded
  *				   proc - the enclosing procedure
- * RETURNS:		   a DecodeResult structure containing all the information gathered during decoding
+ *				   result - caller owned; receives all the information gathered during decoding
+ * RETURNS:		   result.valid
  *============================================================================*/
-static DecodeResult result;
-DecodeResult& PentiumDecoder::decodeInstruction (ADDRESS pc, int delta)
+bool PentiumDecoder::decodeInstruction (ADDRESS pc, int delta, DecodeResult& result)
 {
 	ADDRESS hostPC = pc + delta;
 
@@ -1362,23 +1362,23 @@ DecodeResult& PentiumDecoder::decodeInstruction (ADDRESS pc, int delta)
 	| BSRod(reg, Eaddr) =>
 		//stmts = instantiate(pc,  "BSRod", DIS_REG32, DIS_EADDR32);
 		// Bit Scan Forward: need helper function
-		genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, nextPC-hostPC);
-		return result;
+		genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, nextPC-hostPC, result);
+		return result.valid;
 
 	| BSRow(reg, Eaddr) =>
 		//stmts = instantiate(pc,  "BSRow", DIS_REG16, DIS_EADDR16);
-		genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, nextPC-hostPC);
-		return result;
+		genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, nextPC-hostPC, result);
+		return result.valid;
 
 	| BSFod(reg, Eaddr) =>
 		//stmts = instantiate(pc,  "BSFod", DIS_REG32, DIS_EADDR32);
-		genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, nextPC-hostPC);
-		return result;
+		genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, nextPC-hostPC, result);
+		return result.valid;
 
 	| BSFow(reg, Eaddr) =>
 		//stmts = instantiate(pc,  "BSFow", DIS_REG16, DIS_EADDR16);
-		genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, nextPC-hostPC);
-		return result;
+		genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, nextPC-hostPC, result);
+		return result.valid;
 
 	// Not "user" instructions:
 //	| BOUNDod(reg, Mem) =>
@@ -2121,13 +2121,13 @@ DecodeResult& PentiumDecoder::decodeInstruction (ADDRESS pc, int delta)
 		result.valid = false;		// Invalid instruction
 		result.rtl = NULL;
 		result.numBytes = 0;
-		return result;
+		return result.valid;
 	endmatch
 
 	if (result.rtl == 0)
 		result.rtl = new RTL(pc, stmts);
 	result.numBytes = nextPC - hostPC;
-	return result;
+	return result.valid;
 }
 
 /*==============================================================================
@@ -2339,11 +2339,13 @@ int PentiumDecoder::decodeAssemblyInstruction(ADDRESS, int)
  *				   size: sizeof(modrm) (in bits)
  *				   incdec: either opPlus for Forward scans, or opMinus for Reverse scans
  *				   numBytes: number of bytes this instruction
+ *				   result: the DecodeResult of the instruction being decoded
  * RETURNS:		   true if have to exit early (not in last state)
  *============================================================================*/
-static int BSFRstate = 0;		// State number for this state machine
+// State number for this state machine. Per thread, as each decoding thread re-decodes its own BSF/BSR instruction
+static thread_local int BSFRstate = 0;
 void genBSFR(ADDRESS pc, Exp* dest, Exp* modrm, int init, int size,
-  OPER incdec, int numBytes) {
+  OPER incdec, int numBytes, DecodeResult& result) {
 	// Note the horrible hack needed here. We need initialisation code, and an extra branch, so the %SKIP/%RPT won't
 	// work. We need to emit 6 statements, but these need to be in 3 RTLs, since the destination of a branch has to be
 	// to the start of an RTL.  So we use a state machine, and set numBytes to 0 for the first two times. That way, this
@@ -103,11 +103,11 @@ void unused(char* x) {}
  *					 in the loaded object file)
  *				   proc - the enclosing procedure. This can be NULL for
  *					 those of us who are using this method in an interpreter
- * RETURNS:		   a DecodeResult structure containing all the information
+ *				   result - caller owned; receives all the information
  *					 gathered during decoding
+ * RETURNS:		   result.valid
  *============================================================================*/
-DecodeResult& PPCDecoder::decodeInstruction (ADDRESS pc, int delta) { 
-	static DecodeResult result;
+bool PPCDecoder::decodeInstruction(ADDRESS pc, int delta, DecodeResult &result) { 
 	ADDRESS hostPC = pc+delta;
 
 	// Clear the result structure;
@@ -361,7 +361,7 @@ DecodeResult& PPCDecoder::decodeInstruction (ADDRESS pc, int delta) {
 	if (result.valid && result.rtl == 0)	// Don't override higher level res
 		result.rtl = new RTL(pc, stmts);
 
-	return result;
+	return result.valid;
 }
 
 
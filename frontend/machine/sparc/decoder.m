@@ -198,10 +198,10 @@ RTL* SparcDecoder::createBranchRtl(ADDRESS pc, std::list<Statement*>* stmts, con
  *					that the pc is at in the loaded object file)
  *				   proc - the enclosing procedure. This can be NULL for those of us who are using this method in an
  *					interpreter
- * RETURNS:		   a DecodeResult structure containing all the information gathered during decoding
+ *				   result - caller owned; receives all the information gathered during decoding
+ * RETURNS:		   result.valid
  *============================================================================*/
-DecodeResult& SparcDecoder::decodeInstruction (ADDRESS pc, int delta) { 
-	static DecodeResult result;
+bool SparcDecoder::decodeInstruction(ADDRESS pc, int delta, DecodeResult &result) { 
 	ADDRESS hostPC = pc+delta;
 
 	// Clear the result structure;
@@ -282,7 +282,7 @@ DecodeResult& SparcDecoder::decodeInstruction (ADDRESS pc, int delta) {
 			result.valid = false;
 			result.rtl = new RTL;
 			result.numBytes = 4;
-			return result;
+			return result.valid;
 		}
 		// Instantiate a GotoStatement for the unconditional branches, HLJconds for the rest.
 		// NOTE: NJMC toolkit cannot handle embedded else statements!
@@ -326,7 +326,7 @@ DecodeResult& SparcDecoder::decodeInstruction (ADDRESS pc, int delta) {
 			result.valid = false;
 			result.rtl = new RTL;
 			result.numBytes = 4;
-			return result;
+			return result.valid;
 		}
 		GotoStatement* jump = 0;
 		RTL* rtl = NULL;					// Init to NULL to suppress a warning
@@ -367,7 +367,7 @@ DecodeResult& SparcDecoder::decodeInstruction (ADDRESS pc, int delta) {
 			result.valid = false;
 			result.rtl = new RTL;
 			result.numBytes = 4;
-			return result;
+			return result.valid;
 		}
 		// Instantiate a GotoStatement for the unconditional branches, BranchStatement for the rest
 		// NOTE: NJMC toolkit cannot handle embedded plain else statements! (But OK with curly bracket before the else)
@@ -415,7 +415,7 @@ DecodeResult& SparcDecoder::decodeInstruction (ADDRESS pc, int delta) {
 			result.valid = false;
 			result.rtl = new RTL;
 			result.numBytes = 4;
-			return result;
+			return result.valid;
 		}
 		GotoStatement* jump = 0;
 		RTL* rtl = NULL;
@@ -649,7 +649,7 @@ DecodeResult& SparcDecoder::decodeInstruction (ADDRESS pc, int delta) {
 	if (result.valid && result.rtl == 0)	// Don't override higher level res
 		result.rtl = new RTL(pc, stmts);
 
-	return result;
+	return result.valid;
 }
 
 
@@ -48,10 +48,10 @@ void ST20Decoder::unused(int x)
 					the pc is at in the loaded object file)
  *				   RTLDict - the dictionary of RTL templates used to instantiate the RTL for the instruction being decoded
  *				   proc - the enclosing procedure
- * RETURNS:		   a DecodeResult structure containing all the information gathered during decoding
+ *				   result - caller owned; receives all the information gathered during decoding
+ * RETURNS:		   result.valid
  *============================================================================*/
-static	DecodeResult result;
-DecodeResult& ST20Decoder::decodeInstruction (ADDRESS pc, int delta) {
+bool ST20Decoder::decodeInstruction(ADDRESS pc, int delta, DecodeResult &result) {
 	result.reset();							// Clear the result structure (numBytes = 0 etc)
 	ADDRESS hostPC = pc + delta;
 	std::list<Statement*>* stmts = NULL; 	// The actual list of instantiated Statements
@@ -275,7 +275,7 @@ DecodeResult& ST20Decoder::decodeInstruction (ADDRESS pc, int delta) {
 				result.valid = false;		// Invalid instruction
 				result.rtl = NULL;
 				result.numBytes = 0;
-				return result;
+				return result.valid;
 			}
 
 
@@ -285,7 +285,7 @@ DecodeResult& ST20Decoder::decodeInstruction (ADDRESS pc, int delta) {
 
 	if (result.rtl == 0)
 		result.rtl = new RTL(pc, stmts);
-	return result;
+	return result.valid;
 }
 
 /*==============================================================================
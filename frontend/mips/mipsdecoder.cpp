@@ -61,13 +61,12 @@ int MIPSDecoder::decodeAssemblyInstruction(ADDRESS, ptrdiff_t) { return 0; }
   * \param   pc - the native address of the pc
   * \param   delta - the difference between the above address and the
   *              host address of the pc (i.e. the address that the pc is at in the loaded object file)
-  * \returns a DecodeResult structure containing all the information
-  *              gathered during decoding
+  * \param   result - caller owned; receives all the information gathered during decoding
+  * \returns result.valid
   *********************************************************************************/
-DecodeResult &MIPSDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
+bool MIPSDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta, DecodeResult &result) {
     Q_UNUSED(pc);
     Q_UNUSED(delta);
-    static DecodeResult result;
     // ADDRESS hostPC = pc+delta;
 
     // Clear the result structure;
@@ -78,5 +77,5 @@ DecodeResult &MIPSDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
     // ADDRESS nextPC = NO_ADDRESS;
     // Decoding goes here....
 
-    return result;
+    return result.valid;
 }
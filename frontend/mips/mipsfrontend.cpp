@@ -47,6 +47,7 @@ MIPSFrontEnd::~MIPSFrontEnd() {}
 std::vector<Exp *> &MIPSFrontEnd::getDefaultParams() {
     static std::vector<Exp *> params;
     if (params.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
         for (int r = 31; r >= 0; r--) {
             params.push_back(Location::regOf(r));
         }
@@ -57,6 +58,7 @@ std::vector<Exp *> &MIPSFrontEnd::getDefaultParams() {
 std::vector<Exp *> &MIPSFrontEnd::getDefaultReturns() {
     static std::vector<Exp *> returns;
     if (returns.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
         for (int r = 31; r >= 0; r--) {
             returns.push_back(Location::regOf(r));
         }
@@ -50,10 +50,13 @@ NJMCDecoder::NJMCDecoder(Prog *prg) : prog(prg),Image(Boomerang::get()->getImage
   * \returns an instantiated list of Exps
   ******************************************************************************/
 std::list<Instruction *> *NJMCDecoder::instantiate(ADDRESS pc, const char * format, ...) {
-    // Get the signature of the instruction and extract its parts
-    std::pair<QString, unsigned> sig = RTLDict.getSignature(format);
-    QString opcode = sig.first;
-    unsigned numOperands = sig.second;
+    int opcode = lookupOpcode(format);
+    if (opcode == -1) {
+        QTextStream q_cerr(stderr);
+        q_cerr << "ERROR: unknown instruction " << format << " at " << pc << ", ignoring.\n";
+        return nullptr;
+    }
+    unsigned numOperands = RTLDict.getNumOperands(opcode);
 
     // Put the operands into a vector
     std::vector<Exp *> actuals(numOperands);
@@ -87,6 +90,26 @@ std::list<Instruction *> *NJMCDecoder::instantiate(ADDRESS pc, const char * form
     return instance;
 }
 
+/***************************************************************************/ /**
+  * \brief   Map an instruction name, as passed to instantiate(), to its RTLDict opcode id.
+  *          Only the first use of a given name does the (string based) dictionary lookup; after that this is a
+  *          lookup on the address of the name.
+  * \note    name has to have static storage duration (a literal or a MATCH_name table entry)
+  * \param   name - instruction name
+  * \returns the opcode id, or -1 if the name is not in the dictionary
+  ******************************************************************************/
+int NJMCDecoder::lookupOpcode(const char *name) {
+    std::lock_guard<std::mutex> guard(opcodeIdsMutex);
+    auto it = opcodeIds.find(name);
+    if (it != opcodeIds.end())
+        return it->second;
+    int opcode = RTLDict.getOpcodeId(name);
+    if (opcode == -1)
+        LOG_STREAM() << "Error: no entry for `" << name << "' in RTL dictionary\n";
+    opcodeIds[name] = opcode;
+    return opcode;
+}
+
 /***************************************************************************/ /**
   * \brief   Similarly to NJMCDecoder::instantiate, given a parameter name and a list of Exp*'s representing
   * sub-parameters, return a fully substituted Exp for the whole expression
@@ -100,8 +123,10 @@ Exp *NJMCDecoder::instantiateNamedParam(char *name, ...) {
         LOG_STREAM() << "No entry for named parameter '" << name << "'\n";
         return nullptr;
     }
-    assert(RTLDict.DetParamMap.find(name) != RTLDict.DetParamMap.end());
-    ParamEntry &ent = RTLDict.DetParamMap[name];
+    // constFind: a non-const QMap lookup may detach, which is not safe while other threads decode
+    auto found = RTLDict.DetParamMap.constFind(name);
+    assert(found != RTLDict.DetParamMap.constEnd());
+    const ParamEntry &ent = found.value();
     if (ent.kind != PARAM_ASGN && ent.kind != PARAM_LAMBDA) {
         LOG_STREAM() << "Attempt to instantiate expressionless parameter '" << name << "'\n";
         return nullptr;
@@ -137,7 +162,10 @@ Exp * NJMCDecoder::substituteCallArgs(char *name, Exp * exp, ...) {
         LOG_STREAM() << "No entry for named parameter '" << name << "'\n";
         return exp;
     }
-    ParamEntry &ent = RTLDict.DetParamMap[name];
+    auto found = RTLDict.DetParamMap.constFind(name);
+    if (found == RTLDict.DetParamMap.constEnd())
+        return exp; // No late bound params to substitute
+    const ParamEntry &ent = found.value();
     /*if (ent.kind != PARAM_ASGN && ent.kind != PARAM_LAMBDA) {
                 LOG_STREAM() << "Attempt to instantiate expressionless parameter '" << name << "'\n";
                 return;
@@ -164,6 +192,36 @@ void DecodeResult::reset() {
     rtl = nullptr;
     reDecode = false;
     forceOutEdge = ADDRESS::g(0L);
+    callDest = NO_ADDRESS;
+}
+
+namespace {
+// Set while the thread holds a NJMCDecoder::DeferNewProcs
+thread_local bool deferNewProcs = false;
+}
+
+NJMCDecoder::DeferNewProcs::DeferNewProcs() : saved(deferNewProcs) { deferNewProcs = true; }
+
+NJMCDecoder::DeferNewProcs::~DeferNewProcs() { deferNewProcs = saved; }
+
+bool NJMCDecoder::DeferNewProcs::active() { return deferNewProcs; }
+
+/***************************************************************************/ /**
+  * \brief       The procedure for the destination of a decoded call, created if need be
+  * \param       dest - native address of the destination
+  * \param       result - the decoded instruction; gets dest in callDest if creating the procedure is left to the
+  *              caller (see DeferNewProcs)
+  * \returns     the procedure, or nullptr if it is deleted or was not created
+  ******************************************************************************/
+Function *NJMCDecoder::newCallProc(ADDRESS dest, DecodeResult &result) {
+    if (deferNewProcs) {
+        result.callDest = dest;
+        return nullptr;
+    }
+    Function *destProc = prog->setNewProc(dest);
+    if (destProc == (Function *)-1)
+        destProc = nullptr; // In case a deleted Proc
+    return destProc;
 }
 
 /***************************************************************************/ /**
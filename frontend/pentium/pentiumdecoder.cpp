@@ -50,11 +50,10 @@
 #define DIS_OFF (addReloc(new Const(off)))
 // Function to generate statements for the BSF/BSR series (Bit Scan Forward/
 // Reverse)
-void genBSFR(ADDRESS pc, Exp *reg, Exp *modrm, int init, int size, OPER incdec, int numBytes);
+void genBSFR(ADDRESS pc, Exp *reg, Exp *modrm, int init, int size, OPER incdec, int numBytes, DecodeResult &result);
 /**********************************
  * PentiumDecoder methods.
  **********************************/
-static DecodeResult result;
 /***************************************************************************/ /**
   * \brief   Decodes a machine instruction and returns an RTL instance. In most cases a single instruction is
   *              decoded. However, if a higher level construct that may consist of multiple instructions is matched,
@@ -63,9 +62,10 @@ static DecodeResult result;
   * \param   pc - the native address of the pc
   * \param   delta - the difference between the above address and the host address of the pc (i.e. the address
   *              that the pc is at in the loaded object file)
-  * \returns a DecodeResult structure containing all the information gathered during decoding
+  * \param   result - caller owned; receives all the information gathered during decoding
+  * \returns result.valid
   ******************************************************************************/
-DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
+bool PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta, DecodeResult &result) {
     ADDRESS hostPC = pc + delta;
     // Clear the result structure;
     result.reset();
@@ -3698,8 +3698,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
                                             //#line 1372 "frontend/machine/pentium/decoder.m"
                                             // stmts = instantiate(pc,  "BSFod", DIS_REG32, DIS_EADDR32);
                                             genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus,
-                                                    int((nextPC - hostPC).m_value));
-                                            return result;
+                                                    int((nextPC - hostPC).m_value), result);
+                                            return result.valid;
                                         } /*opt-block*/ /*opt-block+*/
                                         else
                                             goto MATCH_label_c968; /*opt-block+*/
@@ -3775,8 +3775,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
                                             // stmts = instantiate(pc,  "BSRod", DIS_REG32, DIS_EADDR32);
                                             // Bit Scan Forward: need helper function
                                             genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus,
-                                                    int((nextPC - hostPC).m_value));
-                                            return result;
+                                                    int((nextPC - hostPC).m_value), result);
+                                            return result.valid;
                                         } /*opt-block*/ /*opt-block+*/
                                         else
                                             goto MATCH_label_c972; /*opt-block+*/
@@ -10702,10 +10702,7 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
                                 // Set the destination
                                 call->setDest(nativeDest);
                                 stmts->push_back(call);
-                                Function *destProc = prog->setNewProc(nativeDest);
-                                if (destProc == (Function *)-1)
-                                    destProc = nullptr; // In case a deleted Proc
-                                call->setDestProc(destProc);
+                                call->setDestProc(newCallProc(nativeDest, result));
                             }
                             result.rtl = new RTL(pc, stmts);
                         }
@@ -14415,8 +14412,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
                                                         //#line 1377 "frontend/machine/pentium/decoder.m"
                                                         // stmts = instantiate(pc,  "BSFow", DIS_REG16, DIS_EADDR16);
                                                         genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus,
-                                                                int((nextPC - hostPC).m_value));
-                                                        return result;
+                                                                int((nextPC - hostPC).m_value), result);
+                                                        return result.valid;
                                                         // Not "user" instructions:
                                                         //    | BOUNDod(reg, Mem) =>
                                                         //        stmts = instantiate(pc,     "BOUNDod", DIS_REG32,
@@ -14513,8 +14510,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
                                                         nextPC = MATCH_p + 6;
                                                         // stmts = instantiate(pc,  "BSRow", DIS_REG16, DIS_EADDR16);
                                                         genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus,
-                                                                int((nextPC - hostPC).m_value));
-                                                        return result;
+                                                                int((nextPC - hostPC).m_value), result);
+                                                        return result.valid;
                                                     } /*opt-block*/ /*opt-block+*/
                                                     else
                                                         goto MATCH_label_c150; /*opt-block+*/
@@ -28335,7 +28332,7 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             result.valid = false; // Invalid instruction
             result.rtl = nullptr;
             result.numBytes = 0;
-            return result;
+            return result.valid;
         }
     MATCH_label_c65:
         (void)0; /*placeholder for label*/
@@ -29153,8 +29150,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 4;
             //#line 1377 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSFow", DIS_REG16, DIS_EADDR16);
-            genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
             // Not "user" instructions:
             //    | BOUNDod(reg, Mem) =>
             //        stmts = instantiate(pc,     "BOUNDod", DIS_REG32, DIS_MEM);
@@ -29180,8 +29177,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 5;
             //#line 1377 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSFow", DIS_REG16, DIS_EADDR16);
-            genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
             // Not "user" instructions:
             //    | BOUNDod(reg, Mem) =>
             //        stmts = instantiate(pc,     "BOUNDod", DIS_REG32, DIS_MEM);
@@ -29207,8 +29204,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 9;
             //#line 1377 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSFow", DIS_REG16, DIS_EADDR16);
-            genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
             // Not "user" instructions:
             //    | BOUNDod(reg, Mem) =>
             //        stmts = instantiate(pc,     "BOUNDod", DIS_REG32, DIS_MEM);
@@ -29234,8 +29231,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 8;
             //#line 1377 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSFow", DIS_REG16, DIS_EADDR16);
-            genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG16, DIS_EADDR16, -1, 16, opPlus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
             // Not "user" instructions:
             //    | BOUNDod(reg, Mem) =>
             //        stmts = instantiate(pc,     "BOUNDod", DIS_REG32, DIS_MEM);
@@ -29261,8 +29258,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 4;
             //#line 1367 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSRow", DIS_REG16, DIS_EADDR16);
-            genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
         }
     MATCH_label_c150:
         (void)0; /*placeholder for label*/
@@ -29272,8 +29269,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 5;
             //#line 1367 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSRow", DIS_REG16, DIS_EADDR16);
-            genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
         }
     MATCH_label_c151:
         (void)0; /*placeholder for label*/
@@ -29283,8 +29280,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 9;
             //#line 1367 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSRow", DIS_REG16, DIS_EADDR16);
-            genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
         }
     MATCH_label_c152:
         (void)0; /*placeholder for label*/
@@ -29293,8 +29290,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             unsigned reg = (MATCH_w_8_24 >> 3 & 0x7) /* reg_opcode at 24 */;
             nextPC = MATCH_p + 8;
             // stmts = instantiate(pc,  "BSRow", DIS_REG16, DIS_EADDR16);
-            genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG16, DIS_EADDR16, 16, 16, opMinus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
         }
     MATCH_label_c153:
         (void)0; /*placeholder for label*/
@@ -37433,8 +37430,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 3;
             //#line 1372 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSFod", DIS_REG32, DIS_EADDR32);
-            genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
         }
     MATCH_label_c968:
         (void)0; /*placeholder for label*/
@@ -37443,8 +37440,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             unsigned reg = (MATCH_w_8_16 >> 3 & 0x7) /* reg_opcode at 16 */;
             nextPC = MATCH_p + 4;
             // stmts = instantiate(pc,  "BSFod", DIS_REG32, DIS_EADDR32);
-            genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
         }
     MATCH_label_c969:
         (void)0; /*placeholder for label*/
@@ -37454,16 +37451,16 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 8;
             //#line 1372 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSFod", DIS_REG32, DIS_EADDR32);
-            genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
         }
     MATCH_label_c970 : {
         ADDRESS Eaddr = addressToPC(MATCH_p) + 2;
         unsigned reg = (MATCH_w_8_16 >> 3 & 0x7) /* reg_opcode at 16 */;
         nextPC = MATCH_p + 7;
         // stmts = instantiate(pc,  "BSFod", DIS_REG32, DIS_EADDR32);
-        genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, int((nextPC - hostPC).m_value));
-        return result;
+        genBSFR(pc, DIS_REG32, DIS_EADDR32, -1, 32, opPlus, int((nextPC - hostPC).m_value), result);
+        return result.valid;
     }
     MATCH_label_c971 : {
         ADDRESS Eaddr = addressToPC(MATCH_p) + 2;
@@ -37471,8 +37468,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
         nextPC = MATCH_p + 3;
         // stmts = instantiate(pc,  "BSRod", DIS_REG32, DIS_EADDR32);
         // Bit Scan Forward: need helper function
-        genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, int((nextPC - hostPC).m_value));
-        return result;
+        genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, int((nextPC - hostPC).m_value), result);
+        return result.valid;
     }
     MATCH_label_c972 : {
         ADDRESS Eaddr = addressToPC(MATCH_p) + 2;
@@ -37480,8 +37477,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
         nextPC = MATCH_p + 4;
         // stmts = instantiate(pc,  "BSRod", DIS_REG32, DIS_EADDR32);
         // Bit Scan Forward: need helper function
-        genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, int((nextPC - hostPC).m_value));
-        return result;
+        genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, int((nextPC - hostPC).m_value), result);
+        return result.valid;
     }
     MATCH_label_c973:
         (void)0; /*placeholder for label*/
@@ -37491,8 +37488,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             nextPC = MATCH_p + 8;
             // stmts = instantiate(pc,  "BSRod", DIS_REG32, DIS_EADDR32);
             // Bit Scan Forward: need helper function
-            genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
         }
     MATCH_label_c974:
         (void)0; /*placeholder for label*/
@@ -37503,8 +37500,8 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
             //#line 1361 "frontend/machine/pentium/decoder.m"
             // stmts = instantiate(pc,  "BSRod", DIS_REG32, DIS_EADDR32);
             // Bit Scan Forward: need helper function
-            genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, int((nextPC - hostPC).m_value));
-            return result;
+            genBSFR(pc, DIS_REG32, DIS_EADDR32, 32, 32, opMinus, int((nextPC - hostPC).m_value), result);
+            return result.valid;
         }
     MATCH_label_c975:
         (void)0; /*placeholder for label*/
@@ -40456,7 +40453,7 @@ DecodeResult &PentiumDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
         result.rtl = new RTL(pc, stmts);
     assert(nextPC >= hostPC);
     result.numBytes = int((nextPC - hostPC).m_value);
-    return result;
+    return result.valid;
 }
 /***************************************************************************/ /**
   * These are machine specific functions used to decode instruction operands into
@@ -40764,6 +40761,8 @@ DWord PentiumDecoder::getDword(intptr_t lc)
   * \brief       Constructor. The code won't work without this (not sure why the default constructor won't do...)
   *
   ******************************************************************************/
+thread_local ADDRESS PentiumDecoder::lastDwordLc = NO_ADDRESS;
+
 PentiumDecoder::PentiumDecoder(Prog *prog) : NJMCDecoder(prog) {
     QDir base_dir=Boomerang::get()->getProgDir();
     RTLDict.readSSLFile(base_dir.absoluteFilePath("frontend/machine/pentium/pentium.ssl"));
@@ -40785,10 +40784,12 @@ int PentiumDecoder::decodeAssemblyInstruction(ADDRESS, ptrdiff_t) { return 0; }
   * \param size: sizeof(modrm) (in bits)
   * \param incdec: either opPlus for Forward scans, or opMinus for Reverse scans
   * \param numBytes: number of bytes this instruction
+  * \param result: the DecodeResult of the instruction being decoded
   * \returns true if have to exit early (not in last state)
   ******************************************************************************/
-static int BSFRstate = 0;                                                     // State number for this state machine
-void genBSFR(ADDRESS pc, Exp *dest, Exp *modrm, int init, int size, OPER incdec, int numBytes) {
+// State number for this state machine. Per thread, as each decoding thread re-decodes its own BSF/BSR instruction
+static thread_local int BSFRstate = 0;
+void genBSFR(ADDRESS pc, Exp *dest, Exp *modrm, int init, int size, OPER incdec, int numBytes, DecodeResult &result) {
     // Note the horrible hack needed here. We need initialisation code, and an extra branch, so the %SKIP/%RPT won't
     // work. We need to emit 6 statements, but these need to be in 3 RTLs, since the destination of a branch has to be
     // to the start of an RTL.  So we use a state machine, and set numBytes to 0 for the first two times. That way, this
@@ -25,7 +25,7 @@ struct DecodeResult;
 class PentiumDecoder : public NJMCDecoder {
   public:
     PentiumDecoder(Prog *prog);
-    virtual DecodeResult &decodeInstruction(ADDRESS pc, ptrdiff_t delta);
+    virtual bool decodeInstruction(ADDRESS pc, ptrdiff_t delta, DecodeResult &result);
     virtual int decodeAssemblyInstruction(ADDRESS pc, ptrdiff_t delta);
 
   private:
@@ -46,7 +46,8 @@ class PentiumDecoder : public NJMCDecoder {
     SWord getWord(ADDRESS lc) { return getWord(lc.m_value); }
     DWord getDword(ADDRESS lc) { return getDword(lc.m_value); }
 
-    ADDRESS lastDwordLc;
+    //! Address of the last dword read by dis_Mem, for addReloc. Per thread, so that decoding is re-entrant
+    static thread_local ADDRESS lastDwordLc;
 };
 
 #endif
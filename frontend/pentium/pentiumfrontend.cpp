@@ -23,6 +23,7 @@
 #include "rtl.h"
 #include "decoder.h" // prototype for decodeInstruction()
 #include "pentiumdecoder.h"
+#include "pentiumsweep.h"
 #include "register.h"
 #include "type.h"
 #include "cfg.h"
@@ -192,6 +193,7 @@ bool PentiumFrontEnd::processProc(ADDRESS uAddr, UserProc *pProc, QTextStream &o
 std::vector<Exp *> &PentiumFrontEnd::getDefaultParams() {
     static std::vector<Exp *> params;
     if (params.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
         params.push_back(Location::regOf(24 /*eax*/));
         params.push_back(Location::regOf(25 /*ecx*/));
         params.push_back(Location::regOf(26 /*edx*/));
@@ -208,6 +210,7 @@ std::vector<Exp *> &PentiumFrontEnd::getDefaultParams() {
 std::vector<Exp *> &PentiumFrontEnd::getDefaultReturns() {
     static std::vector<Exp *> returns;
     if (returns.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
         returns.push_back(Location::regOf(24 /*eax*/));
         returns.push_back(Location::regOf(25 /*ecx*/));
         returns.push_back(Location::regOf(26 /*edx*/));
@@ -478,6 +481,21 @@ PentiumFrontEnd::~PentiumFrontEnd() {
     decoder = nullptr;
 }
 
+/***************************************************************************/ /**
+  * \brief    Create procs for the call targets and procedure prologues found by a linear sweep of the code
+  * sections. The sweep is split over the decoding threads (-j).
+  ******************************************************************************/
+void PentiumFrontEnd::sweepForProcs() {
+    PentiumSweep sweeper(Image);
+    SweepResult found = sweeper.sweepAll(Boomerang::get()->numDecodeThreads);
+    LOG_VERBOSE(1) << "linear sweep found " << found.callTargets.size() << " call targets, " << found.prologues.size()
+                   << " prologues and " << found.jumpTables.size() << " candidate switch tables\n";
+    for (ADDRESS a : found.callTargets)
+        Program->setNewProc(a);
+    for (ADDRESS a : found.prologues)
+        Program->setNewProc(a);
+}
+
 /***************************************************************************/ /**
   * \brief    Locate the starting address of "main" in the code section
   * \returns         Native pointer if found; NO_ADDRESS if not
@@ -504,7 +522,8 @@ ADDRESS PentiumFrontEnd::getMainEntryPoint(bool &gotMain) {
     // a push of eax and then the call to main.  Or a call to __libc_start_main
     ADDRESS dest;
     do {
-        DecodeResult inst = decodeInstruction(addr);
+        DecodeResult inst;
+        decodeInstruction(addr, inst);
         if (inst.rtl == nullptr)
             // Must have gotten out of step
             break;
@@ -515,11 +534,11 @@ ADDRESS PentiumFrontEnd::getMainEntryPoint(bool &gotMain) {
                     Symbols->find(((Const *)cs->getDest()->getSubExp1())->getAddr()) : nullptr;
         if (sym && sym->isImportedFunction() && sym->getName() == "GetModuleHandleA" ) {
             int oNumBytes = inst.numBytes;
-            inst = decodeInstruction(addr + oNumBytes);
+            decodeInstruction(addr + oNumBytes, inst);
             if (inst.valid && inst.rtl->size() == 2) {
                 Assign *a = dynamic_cast<Assign *>(inst.rtl->back()); // using back instead of rtl[1], since size()==2
                 if (a && *a->getRight() == *Location::regOf(24)) {
-                    inst = decodeInstruction(addr + oNumBytes + inst.numBytes);
+                    decodeInstruction(addr + oNumBytes + inst.numBytes, inst);
                     if (!inst.rtl->empty()) {
                         CallStatement *toMain = dynamic_cast<CallStatement *>(inst.rtl->back());
                         if (toMain && toMain->getFixedDest() != NO_ADDRESS) {
@@ -542,7 +561,7 @@ ADDRESS PentiumFrontEnd::getMainEntryPoint(bool &gotMain) {
                 // This is a gcc 3 pattern. The first parameter will be a pointer to main.
                 // Assume it's the 5 byte push immediately preceeding this instruction
                 // Note: the RTL changed recently from esp = esp-4; m[esp] = K tp m[esp-4] = K; esp = esp-4
-                inst = decodeInstruction(addr - 5);
+                decodeInstruction(addr - 5, inst);
                 assert(inst.valid);
                 assert(inst.rtl->size() == 2);
                 Assign *a = (Assign *)inst.rtl->front(); // Get m[esp-4] = K
@@ -844,8 +863,8 @@ bool PentiumFrontEnd::decodeSpecial_out(ADDRESS pc, DecodeResult &r) {
     r.type = NCT;
     r.reDecode = false;
     r.rtl = new RTL(pc);
-    Exp *dx = Location::regOf(decoder->getRTLDict().RegMap["%dx"]);
-    Exp *al = Location::regOf(decoder->getRTLDict().RegMap["%al"]);
+    Exp *dx = Location::regOf(decoder->getRTLDict().RegMap.at("%dx"));
+    Exp *al = Location::regOf(decoder->getRTLDict().RegMap.at("%al"));
     CallStatement *call = new CallStatement();
     call->setDestProc(Program->getLibraryProc("outp"));
     call->setArgumentExp(0, dx);
@@ -879,11 +898,10 @@ bool PentiumFrontEnd::decodeSpecial(ADDRESS pc, DecodeResult &r) {
     }
     return false;
 }
-DecodeResult &PentiumFrontEnd::decodeInstruction(ADDRESS pc) {
-    static DecodeResult r;
-    if (decodeSpecial(pc, r))
-        return r;
-    return FrontEnd::decodeInstruction(pc);
+bool PentiumFrontEnd::decodeInstruction(ADDRESS pc, DecodeResult &result) {
+    if (decodeSpecial(pc, result))
+        return result.valid;
+    return FrontEnd::decodeInstruction(pc, result);
 }
 
 // EXPERIMENTAL: can we find function pointers in arguments to calls this early?
@@ -28,6 +28,8 @@ class PentiumFrontEnd : public FrontEnd {
 
     virtual ADDRESS getMainEntryPoint(bool &gotMain);
 
+    virtual void sweepForProcs();
+
   private:
     /*
          * Process an F(n)STSW instruction.
@@ -69,7 +71,7 @@ class PentiumFrontEnd : public FrontEnd {
     bool decodeSpecial_invalid(ADDRESS pc, DecodeResult &r);
 
   protected:
-    virtual DecodeResult &decodeInstruction(ADDRESS pc);
+    virtual bool decodeInstruction(ADDRESS pc, DecodeResult &result);
     virtual void extraProcessCall(CallStatement *call, std::list<RTL *> *BB_rtls);
 };
 
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2016, The Boomerang team
+ *
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL
+ * WARRANTIES.
+ *
+ */
+
+/***************************************************************************/ /**
+  * \file       pentiumsweep.cpp
+  * \brief   Linear sweep of x86 code sections to find procedure starts ahead of decoding
+  ******************************************************************************/
+
+#include "pentiumsweep.h"
+#include "IBinaryImage.h"
+#include "IBinarySection.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+extern "C" {
+int microX86Dis(unsigned char *pCode); // From loader/microX86dis.c
+}
+
+namespace {
+const int MAX_INST_SIZE = 15;       // Longest x86 instruction
+const uint32_t MIN_SHARD_SIZE = 4096; // Don't bother splitting the code any finer than this
+const uint32_t MAX_SNAP = 256;      // How far a shard boundary may move to find padding
+
+inline bool isPadding(unsigned char c) { return c == 0xCC || c == 0x90; } // int3 or nop
+
+inline uint32_t read4(const unsigned char *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+}
+
+void SweepResult::merge(const SweepResult &other) {
+    callTargets.insert(other.callTargets.begin(), other.callTargets.end());
+    prologues.insert(other.prologues.begin(), other.prologues.end());
+    jumpTables.insert(other.jumpTables.begin(), other.jumpTables.end());
+}
+
+PentiumSweep::PentiumSweep(IBinaryImage *image) {
+    for (IBinarySection *sect : *image) {
+        if (!sect->isCode() || sect->size() == 0 || sect->hostAddr().isZero())
+            continue;
+        code.push_back({(const unsigned char *)sect->hostAddr().m_value, sect->sourceAddr(),
+                        sect->sourceAddr() + sect->size()});
+    }
+}
+
+const PentiumSweep::Section *PentiumSweep::findSection(ADDRESS a) const {
+    for (const Section &sect : code)
+        if (a >= sect.from && a < sect.to)
+            return &sect;
+    return nullptr;
+}
+
+/***************************************************************************/ /**
+  *
+  * \brief Sweep the instructions starting in [from, to) of section sect, adding what is found to result.
+  * Bytes that microX86Dis can't handle are skipped one at a time until the sweep is back in step.
+  ******************************************************************************/
+void PentiumSweep::sweepShard(const Section &sect, ADDRESS from, ADDRESS to, SweepResult &result) const {
+    unsigned char tail[2 * MAX_INST_SIZE];
+    uint32_t end = (sect.to - sect.from).m_value;
+    for (uint32_t i = (from - sect.from).m_value, last = (to - sect.from).m_value; i < last;) {
+        unsigned char *inst = const_cast<unsigned char *>(sect.host + i);
+        if (end - i < (uint32_t)MAX_INST_SIZE) {
+            // Near the end of the section; microX86Dis may read past it
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, inst, end - i);
+            inst = tail;
+        }
+        int size = microX86Dis(inst);
+        if (size <= 0 || size > MAX_INST_SIZE) {
+            ++i;
+            continue;
+        }
+        ADDRESS a = sect.from + i;
+        switch (inst[0]) {
+        case 0xE8: { // call rel32
+            ADDRESS dest = a + size + (int32_t)read4(inst + 1);
+            if (size == 5 && findSection(dest))
+                result.callTargets.insert(dest);
+            break;
+        }
+        case 0x55: // push ebp; mov ebp, esp (either encoding)
+            if (end - i >= 3 && ((inst[1] == 0x89 && inst[2] == 0xE5) || (inst[1] == 0x8B && inst[2] == 0xEC)))
+                result.prologues.insert(a);
+            break;
+        case 0xFF: // jmp [reg*4 + disp32]
+            if (size == 7 && inst[1] == 0x24 && (inst[2] & 0xC7) == 0x85)
+                result.jumpTables.insert(ADDRESS::g(read4(inst + 3)));
+            break;
+        }
+        i += size;
+    }
+}
+
+std::vector<std::pair<ADDRESS, ADDRESS>> PentiumSweep::shards(int numShards) const {
+    uint32_t total = 0;
+    for (const Section &sect : code)
+        total += (sect.to - sect.from).m_value;
+    uint32_t chunk = std::max(total / std::max(numShards, 1), MIN_SHARD_SIZE);
+    std::vector<std::pair<ADDRESS, ADDRESS>> res;
+    for (const Section &sect : code) {
+        uint32_t size = (sect.to - sect.from).m_value;
+        uint32_t from = 0;
+        while (from < size) {
+            uint32_t to = std::min(from + chunk, size);
+            // Move the boundary past the next run of (at least two) padding bytes, if there is one close by
+            for (uint32_t j = to; to < size && j + 1 < std::min(to + MAX_SNAP, size); ++j) {
+                if (isPadding(sect.host[j]) && isPadding(sect.host[j + 1])) {
+                    while (j < size && isPadding(sect.host[j]))
+                        ++j;
+                    to = j;
+                    break;
+                }
+            }
+            res.push_back(std::make_pair(sect.from + from, sect.from + to));
+            from = to;
+        }
+    }
+    return res;
+}
+
+SweepResult PentiumSweep::sweep(ADDRESS from, ADDRESS to) const {
+    SweepResult res;
+    const Section *sect = findSection(from);
+    if (sect)
+        sweepShard(*sect, from, std::min(to, sect->to), res);
+    return res;
+}
+
+SweepResult PentiumSweep::sweepAll(int numThreads) const {
+    SweepResult res;
+    if (numThreads <= 1) {
+        for (const Section &sect : code)
+            sweepShard(sect, sect.from, sect.to, res);
+        return res;
+    }
+    std::vector<std::pair<ADDRESS, ADDRESS>> work = shards(numThreads * 4);
+    std::atomic<size_t> next(0);
+    std::mutex resMutex;
+    auto worker = [&]() {
+        SweepResult mine;
+        for (size_t n; (n = next++) < work.size();)
+            sweepShard(*findSection(work[n].first), work[n].first, work[n].second, mine);
+        std::lock_guard<std::mutex> guard(resMutex);
+        res.merge(mine);
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i)
+        threads.emplace_back(worker);
+    for (std::thread &t : threads)
+        t.join();
+    return res;
+}
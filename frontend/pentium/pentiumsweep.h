@@ -0,0 +1,47 @@
+#ifndef PENTIUMSWEEP_H
+#define PENTIUMSWEEP_H
+
+#include "types.h"
+
+#include <set>
+#include <vector>
+
+class IBinaryImage;
+
+/***************************************************************************/ /**
+  * Addresses of interest found by a linear sweep of x86 code.
+  ******************************************************************************/
+struct SweepResult {
+    std::set<ADDRESS> callTargets; //!< Destinations of direct calls (call rel32) that lie in a code section
+    std::set<ADDRESS> prologues;   //!< Starts of "push ebp; mov ebp, esp" sequences
+    std::set<ADDRESS> jumpTables;  //!< Table addresses of "jmp [reg*4 + table]" (candidate switch tables)
+    void merge(const SweepResult &other);
+};
+
+/***************************************************************************/ /**
+  * PentiumSweep walks the executable sections of an image one instruction after the other, using only the
+  * instruction lengths given by microX86Dis, to find likely procedure starts before any semantic decoding is
+  * done. The code range is split into shards that can be swept by several threads; a shard boundary is moved
+  * to the end of a run of padding bytes when one is close by, so that each shard starts on an instruction.
+  * The results are heuristic: a linear sweep can be misled by data in the code sections.
+  ******************************************************************************/
+class PentiumSweep {
+    struct Section {
+        const unsigned char *host; //!< Host address of from
+        ADDRESS from, to;          //!< Native range [from, to)
+    };
+    std::vector<Section> code; // Executable sections
+    const Section *findSection(ADDRESS a) const;
+    void sweepShard(const Section &sect, ADDRESS from, ADDRESS to, SweepResult &result) const;
+
+  public:
+    PentiumSweep(IBinaryImage *image);
+    //! Split the code into roughly numShards shards of similar size; each shard lies inside one code section
+    std::vector<std::pair<ADDRESS, ADDRESS>> shards(int numShards) const;
+    //! Sweep the native range [from, to), which must lie inside one code section
+    SweepResult sweep(ADDRESS from, ADDRESS to) const;
+    //! Sweep all the code with numThreads threads
+    SweepResult sweepAll(int numThreads) const;
+};
+
+#endif // PENTIUMSWEEP_H
@@ -88,11 +88,11 @@ Exp *crBit(int bitNum); // Get an expression for a CR bit access
   * \param  delta - the difference between the above address and the
   *                 host address of the pc (i.e. the address that the pc is at
   *                 in the loaded object file)
-  * \returns            a DecodeResult structure containing all the information
-  *                     gathered during decoding
+  * \param  result - caller owned; receives all the information gathered
+  *                 during decoding
+  * \returns            result.valid
   ******************************************************************************/
-DecodeResult &PPCDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
-    static DecodeResult result;
+bool PPCDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta, DecodeResult &result) {
     ADDRESS hostPC = pc + delta;
 
     // Clear the result structure;
@@ -1004,12 +1004,7 @@ DecodeResult &PPCDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
 
                         result.rtl->appendStmt(newCall);
 
-                        Function *destProc = prog->setNewProc(reladdr - delta);
-
-                        if (destProc == (Function *)-1)
-                            destProc = nullptr;
-
-                        newCall->setDestProc(destProc);
+                        newCall->setDestProc(newCallProc(reladdr - delta, result));
                     }
 
                 } /*opt-block*/
@@ -8935,7 +8930,7 @@ DecodeResult &PPCDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
     if (result.valid && result.rtl == 0) // Don't override higher level res
         result.rtl = new RTL(pc, stmts);
 
-    return result;
+    return result.valid;
 }
 
 /***********************************************************************
@@ -49,6 +49,7 @@ PPCFrontEnd::~PPCFrontEnd() {}
 std::vector<Exp *> &PPCFrontEnd::getDefaultParams() {
     static std::vector<Exp *> params;
     if (params.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
         for (int r = 31; r >= 0; r--) {
             params.push_back(Location::regOf(r));
         }
@@ -59,6 +60,7 @@ std::vector<Exp *> &PPCFrontEnd::getDefaultParams() {
 std::vector<Exp *> &PPCFrontEnd::getDefaultReturns() {
     static std::vector<Exp *> returns;
     if (returns.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
         for (int r = 31; r >= 0; r--) {
             returns.push_back(Location::regOf(r));
         }
@@ -186,10 +186,10 @@ RTL *SparcDecoder::createBranchRtl(ADDRESS pc, std::list<Instruction *> *stmts,
   * \param pc - the native address of the pc
   * \param delta - the difference between the above address and the host address of the pc (i.e. the address
   *        that the pc is at in the loaded object file)
-  * \returns            a DecodeResult structure containing all the information gathered during decoding
+  * \param result - caller owned; receives all the information gathered during decoding
+  * \returns            result.valid
   ******************************************************************************/
-DecodeResult &SparcDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
-    static DecodeResult result;
+bool SparcDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta, DecodeResult &result) {
     ADDRESS hostPC = pc + delta;
     // Clear the result structure;
     result.reset();
@@ -382,7 +382,7 @@ DecodeResult &SparcDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
                                 result.valid = false;
                                 result.rtl = new RTL;
                                 result.numBytes = 4;
-                                return result;
+                                return result.valid;
                             }
 
                             GotoStatement *jump = 0;
@@ -523,10 +523,7 @@ DecodeResult &SparcDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
 
                 ADDRESS nativeDest = addr - delta;
                 newCall->setDest(nativeDest);
-                Function *destProc = prog->setNewProc(nativeDest);
-                if (destProc == (Function *)-1)
-                    destProc = nullptr;
-                newCall->setDestProc(destProc);
+                newCall->setDestProc(newCallProc(nativeDest, result));
                 result.rtl = new RTL(pc, stmts);
                 result.rtl->appendStmt(newCall);
                 result.type = SD;
@@ -1597,7 +1594,7 @@ DecodeResult &SparcDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
                 result.valid = false;
                 result.rtl = new RTL;
                 result.numBytes = 4;
-                return result;
+                return result.valid;
             }
 
             GotoStatement *jump = 0;
@@ -1664,7 +1661,7 @@ DecodeResult &SparcDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
                 result.valid = false;
                 result.rtl = new RTL;
                 result.numBytes = 4;
-                return result;
+                return result.valid;
             }
 
             // Instantiate a GotoStatement for the unconditional branches, BranchStatement for the rest
@@ -1733,7 +1730,7 @@ DecodeResult &SparcDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
                 result.valid = false;
                 result.rtl = new RTL;
                 result.numBytes = 4;
-                return result;
+                return result.valid;
             }
 
             // Instantiate a GotoStatement for the unconditional branches, HLJconds for the rest.
@@ -2077,7 +2074,7 @@ DecodeResult &SparcDecoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
     assert(result.numBytes > 0);
     if (result.valid && result.rtl == 0) // Don't override higher level res
         result.rtl = new RTL(pc, stmts);
-    return result;
+    return result.valid;
 }
 
 /***********************************************************************
@@ -37,7 +37,7 @@ public:
          * Decodes the machine instruction at pc and returns an RTL instance for
          * the instruction.
          */
-    virtual DecodeResult &decodeInstruction(ADDRESS pc, ptrdiff_t delta);
+    virtual bool decodeInstruction(ADDRESS pc, ptrdiff_t delta, DecodeResult &result);
 
     /*
          * Disassembles the machine instruction at pc and returns the number of
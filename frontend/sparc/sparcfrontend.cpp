@@ -677,6 +677,7 @@ bool SparcFrontEnd::case_SCDAN(ADDRESS &address, ptrdiff_t delta, ADDRESS hiAddr
 std::vector<Exp *> &SparcFrontEnd::getDefaultParams() {
     static std::vector<Exp *> params;
     if (params.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
         // init arguments and return set to be all 31 machine registers
         // Important: because o registers are save in i registers, and
         // i registers have higher register numbers (e.g. i1=r25, o1=r9)
@@ -694,6 +695,7 @@ std::vector<Exp *> &SparcFrontEnd::getDefaultParams() {
 std::vector<Exp *> &SparcFrontEnd::getDefaultReturns() {
     static std::vector<Exp *> returns;
     if (returns.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
         returns.push_back(Location::regOf(30));
         returns.push_back(Location::regOf(31));
         for (int r = 29; r > 0; r--) {
@@ -769,13 +771,12 @@ bool SparcFrontEnd::processProc(ADDRESS uAddr, UserProc *proc, QTextStream &os,
 
             // Check if this is an already decoded jump instruction (from a previous pass with propagation etc)
             // If so, we don't need to decode this instruction
-            std::map<ADDRESS, RTL *>::iterator ff = previouslyDecoded.find(uAddr);
-            if (ff != previouslyDecoded.end()) {
-                inst.rtl = ff->second;
+            if (RTL *prev = findDecodedRtl(uAddr)) {
+                inst.rtl = prev;
                 inst.valid = true;
                 inst.type = DD; // E.g. decode the delay slot instruction
             } else
-                inst = decodeInstruction(uAddr);
+                decodeCachedInstruction(uAddr, inst);
 
             // If invalid and we are speculating, just exit
             if (spec && !inst.valid)
@@ -888,7 +889,8 @@ bool SparcFrontEnd::processProc(ADDRESS uAddr, UserProc *proc, QTextStream &os,
 
             case SD: {
                 // This includes "call" and "ba". If a "call", it might be a move_call_move idiom, or a call to .stret4
-                DecodeResult delay_inst = decodeInstruction(uAddr + 4);
+                DecodeResult delay_inst;
+                decodeInstruction(uAddr + 4, delay_inst);
                 if (Boomerang::get()->traceDecoder)
                     LOG << "*" << uAddr + 4 << "\t\n";
                 if (last->getKind() == STMT_CALL) {
@@ -1024,7 +1026,7 @@ bool SparcFrontEnd::processProc(ADDRESS uAddr, UserProc *proc, QTextStream &os,
                 DecodeResult delay_inst;
                 if (inst.numBytes == 4) {
                     // Ordinary instruction. Look at the delay slot
-                    delay_inst = decodeInstruction(uAddr + 4);
+                    decodeInstruction(uAddr + 4, delay_inst);
                 } else {
                     // Must be a prologue or epilogue or something.
                     delay_inst = nop_inst;
@@ -1060,7 +1062,8 @@ bool SparcFrontEnd::processProc(ADDRESS uAddr, UserProc *proc, QTextStream &os,
                 // instruction just before the target; if so, we can branch to that and not need the orphan.  We do
                 // just a binary comparison; that may fail to make this optimisation if the instr has relative fields.
 
-                DecodeResult delay_inst = decodeInstruction(uAddr + 4);
+                DecodeResult delay_inst;
+                decodeInstruction(uAddr + 4, delay_inst);
                 RTL *delay_rtl = delay_inst.rtl;
 
                 // Display low level RTL representation if asked
@@ -1090,7 +1093,8 @@ bool SparcFrontEnd::processProc(ADDRESS uAddr, UserProc *proc, QTextStream &os,
             case SCDAN: {
                 // Execute the delay instruction if the branch is taken; skip (anull) the delay instruction if branch
                 // not taken.
-                DecodeResult delay_inst = decodeInstruction(uAddr + 4);
+                DecodeResult delay_inst;
+                decodeInstruction(uAddr + 4, delay_inst);
                 RTL *delay_rtl = delay_inst.rtl;
 
                 // Display RTL representation if asked
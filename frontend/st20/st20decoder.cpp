@@ -35,16 +35,16 @@
   ******************************************************************************/
 void ST20Decoder::unused(int /*x*/) {}
 
-static DecodeResult result;
 /***************************************************************************/ /**
   * \fn    ST20Decoder::decodeInstruction
   * \brief Decodes a machine instruction and returns an RTL instance. In all cases a single instruction is decoded.
   * \param pc - the native address of the pc
   * \param delta - the difference between the above address and the host address of the pc (i.e. the address that
            the pc is at in the loaded object file)
-  * \returns            a DecodeResult structure containing all the information gathered during decoding
+  * \param result - caller owned; receives all the information gathered during decoding
+  * \returns            result.valid
   ******************************************************************************/
-DecodeResult &ST20Decoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
+bool ST20Decoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta, DecodeResult &result) {
     result.reset(); // Clear the result structure (numBytes = 0 etc)
     ADDRESS hostPC = pc + delta;
     std::list<Instruction *> *stmts = nullptr; // The actual list of instantiated Statements
@@ -843,7 +843,7 @@ DecodeResult &ST20Decoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
 
                         result.numBytes = 0;
 
-                        return result;
+                        return result.valid;
                     }
 
                 } break;
@@ -863,7 +863,7 @@ DecodeResult &ST20Decoder::decodeInstruction(ADDRESS pc, ptrdiff_t delta) {
 
     if (result.rtl == 0)
         result.rtl = new RTL(pc, stmts);
-    return result;
+    return result.valid;
 }
 
 /***************************************************************************/ /**
@@ -32,7 +32,7 @@ class ST20Decoder : public NJMCDecoder {
          * Decodes the machine instruction at pc and returns an RTL instance for
          * the instruction.
          */
-    virtual DecodeResult &decodeInstruction(ADDRESS pc, ptrdiff_t delta);
+    virtual bool decodeInstruction(ADDRESS pc, ptrdiff_t delta, DecodeResult &result);
 
     /*
          * Disassembles the machine instruction at pc and returns the number of
@@ -50,6 +50,7 @@ ST20FrontEnd::~ST20FrontEnd() {}
 std::vector<Exp *> &ST20FrontEnd::getDefaultParams() {
     static std::vector<Exp *> params;
     if (params.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
 #if 0
         for (int r=0; r<=2; r++) {
             params.push_back(Location::regOf(r));
@@ -63,6 +64,7 @@ std::vector<Exp *> &ST20FrontEnd::getDefaultParams() {
 std::vector<Exp *> &ST20FrontEnd::getDefaultReturns() {
     static std::vector<Exp *> returns;
     if (returns.size() == 0) {
+        ProcArena::Scope heap(nullptr); // Kept for the life of the process, so not in any proc's arena
         returns.push_back(Location::regOf(0));
         returns.push_back(Location::regOf(3));
         //        returns.push_back(new Terminal(opPC));
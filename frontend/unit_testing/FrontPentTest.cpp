@@ -10,6 +10,7 @@
 #include "prog.h"
 #include "frontend.h"
 #include "pentiumfrontend.h"
+#include "pentiumsweep.h"
 #include "BinaryFile.h"
 #include "BinaryFileStub.h"
 #include "decoder.h"
@@ -20,6 +21,8 @@
 #include <QProcessEnvironment>
 #include <QDebug>
 
+#include <thread>
+
 #define HELLO_PENT baseDir.absoluteFilePath("tests/inputs/pentium/hello")
 #define BRANCH_PENT baseDir.absoluteFilePath("tests/inputs/pentium/branch")
 #define FEDORA2_TRUE baseDir.absoluteFilePath("tests/inputs/pentium/fedora2_true")
@@ -67,7 +70,8 @@ void FrontPentTest::test1() {
     QVERIFY(addr != NO_ADDRESS);
 
     // Decode first instruction
-    DecodeResult inst = pFE->decodeInstruction(addr);
+    DecodeResult inst;
+    pFE->decodeInstruction(addr, inst);
     inst.rtl->print(strm);
 
     expected = "08048328    0 *32* m[r28 - 4] := r29\n"
@@ -76,14 +80,14 @@ void FrontPentTest::test1() {
     actual.clear();
 
     addr += inst.numBytes;
-    inst = pFE->decodeInstruction(addr);
+    pFE->decodeInstruction(addr, inst);
     inst.rtl->print(strm);
     expected = QString("08048329    0 *32* r29 := r28\n");
     QCOMPARE(actual,expected);
     actual.clear();
 
     addr = 0x804833b;
-    inst = pFE->decodeInstruction(addr);
+    pFE->decodeInstruction(addr, inst);
     inst.rtl->print(strm);
     expected = QString("0804833b    0 *32* m[r28 - 4] := 0x80483fc\n"
                            "            0 *32* r28 := r28 - 4\n");
@@ -108,7 +112,7 @@ void FrontPentTest::test2() {
     FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
     prog->setFrontEnd(pFE);
 
-    inst = pFE->decodeInstruction(ADDRESS::g(0x8048345));
+    pFE->decodeInstruction(ADDRESS::g(0x8048345), inst);
     inst.rtl->print(strm);
     expected = QString("08048345    0 *32* tmp1 := r28\n"
                            "            0 *32* r28 := r28 + 16\n"
@@ -116,13 +120,13 @@ void FrontPentTest::test2() {
     QCOMPARE(actual,expected);
     actual.clear();
 
-    inst = pFE->decodeInstruction(ADDRESS::g(0x8048348));
+    pFE->decodeInstruction(ADDRESS::g(0x8048348), inst);
     inst.rtl->print(strm);
     expected = QString("08048348    0 *32* r24 := 0\n");
     QCOMPARE(actual,expected);
     actual.clear();
 
-    inst = pFE->decodeInstruction(ADDRESS::g(0x8048329));
+    pFE->decodeInstruction(ADDRESS::g(0x8048329), inst);
     inst.rtl->print(strm);
     expected = QString("08048329    0 *32* r29 := r28\n");
     QCOMPARE(actual,expected);
@@ -146,7 +150,7 @@ void FrontPentTest::test3() {
     FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
     prog->setFrontEnd(pFE);
 
-    inst = pFE->decodeInstruction(ADDRESS::n(0x804834d));
+    pFE->decodeInstruction(ADDRESS::n(0x804834d), inst);
     inst.rtl->print(strm);
     expected = QString("0804834d    0 *32* r28 := r29\n"
                            "            0 *32* r29 := m[r28]\n"
@@ -154,7 +158,7 @@ void FrontPentTest::test3() {
     QCOMPARE(actual,expected);
     actual.clear();
 
-    inst = pFE->decodeInstruction(ADDRESS::n(0x804834e));
+    pFE->decodeInstruction(ADDRESS::n(0x804834e), inst);
     inst.rtl->print(strm);
     expected = QString("0804834e    0 *32* %pc := m[r28]\n"
                            "            0 *32* r28 := r28 + 4\n"
@@ -184,7 +188,7 @@ void FrontPentTest::testBranch() {
     prog->setFrontEnd(pFE);
 
     // jne
-    inst = pFE->decodeInstruction(ADDRESS::n(0x8048979));
+    pFE->decodeInstruction(ADDRESS::n(0x8048979), inst);
     inst.rtl->print(strm);
     expected = QString("08048979    0 BRANCH 0x8048988, condition "
                            "not equals\n"
@@ -193,7 +197,7 @@ void FrontPentTest::testBranch() {
     actual.clear();
 
     // jg
-    inst = pFE->decodeInstruction(ADDRESS::n(0x80489c1));
+    pFE->decodeInstruction(ADDRESS::n(0x80489c1), inst);
     inst.rtl->print(strm);
     expected = QString("080489c1    0 BRANCH 0x80489d5, condition signed greater\n"
                            "High level: %flags\n");
@@ -201,7 +205,7 @@ void FrontPentTest::testBranch() {
     actual.clear();
 
     // jbe
-    inst = pFE->decodeInstruction(ADDRESS::n(0x8048a1b));
+    pFE->decodeInstruction(ADDRESS::n(0x8048a1b), inst);
     inst.rtl->print(strm);
     expected = QString("08048a1b    0 BRANCH 0x8048a2a, condition unsigned less or equals\n"
                            "High level: %flags\n");
@@ -257,4 +261,140 @@ void FrontPentTest::testFindMain() {
     bff.UnLoad();
     delete pFE;
 }
+/***************************************************************************/ /**
+  * FUNCTION:        FrontPentTest::testConcurrentDecode
+  * OVERVIEW:        Test that several threads sharing one front end decode the same as a single thread does
+  *============================================================================*/
+void FrontPentTest::testConcurrentDecode() {
+    BinaryFileFactory bff;
+    QObject *pBF = bff.Load(HELLO_PENT);
+    QVERIFY(pBF != 0);
+    Prog *prog = new Prog(HELLO_PENT);
+    FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
+    prog->setFrontEnd(pFE);
+    bool gotMain;
+    ADDRESS addr = pFE->getMainEntryPoint(gotMain);
+    QVERIFY(addr != NO_ADDRESS);
+
+    // Sequential reference: the first instructions of main
+    std::vector<ADDRESS> addrs;
+    QString expected;
+    QTextStream strm(&expected);
+    DecodeResult inst;
+    for (int i = 0; i < 16 && pFE->decodeInstruction(addr, inst); i++) {
+        addrs.push_back(addr);
+        inst.rtl->print(strm);
+        addr += inst.numBytes;
+    }
+
+    const int numThreads = 4;
+    std::vector<QString> actual(numThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++)
+        threads.emplace_back([&, t]() {
+            QTextStream os(&actual[t]);
+            DecodeResult result;
+            for (ADDRESS a : addrs) {
+                pFE->decodeInstruction(a, result);
+                result.rtl->print(os);
+            }
+        });
+    for (std::thread &th : threads)
+        th.join();
+    for (const QString &str : actual)
+        QCOMPARE(str, expected);
+    delete pFE;
+}
+
+//! Decode all of fname with numThreads threads; return the name and address of each proc, in the order of the
+//! program's proc list, each followed by its RTLs if it was decoded
+static QStringList decodeAll(const QString &fname, int numThreads) {
+    QStringList res;
+    BinaryFileFactory bff;
+    QObject *pBF = bff.Load(fname);
+    if (pBF == nullptr)
+        return res;
+    Prog *prog = new Prog(fname);
+    FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
+    prog->setFrontEnd(pFE);
+    bool gotMain;
+    ADDRESS addr = pFE->getMainEntryPoint(gotMain);
+    prog->setNewProc(addr);
+    Boomerang::get()->numDecodeThreads = numThreads;
+    pFE->decode(prog, NO_ADDRESS);
+    Boomerang::get()->numDecodeThreads = 1;
+    for (Module *m : *prog)
+        for (Function *f : *m) {
+            QString proc;
+            QTextStream os(&proc);
+            os << f->getName() << " at " << f->getNativeAddress() << "\n";
+            if (!f->isLib() && ((UserProc *)f)->isDecoded())
+                ((UserProc *)f)->print(os);
+            os.flush();
+            res << proc;
+        }
+    delete pFE;
+    return res;
+}
+
+void FrontPentTest::testParallelDecode() {
+    for (const QString &fname : {HELLO_PENT, FEDORA2_TRUE}) {
+        QStringList expected = decodeAll(fname, 1);
+        QVERIFY(!expected.empty());
+        QStringList actual = decodeAll(fname, 4);
+        QCOMPARE(actual.size(), expected.size());
+        for (int i = 0; i < expected.size(); ++i)
+            QCOMPARE(actual[i], expected[i]); // Same procs, in the same order, with the same names and RTLs
+    }
+}
+
+void FrontPentTest::testDecodeCache() {
+    BinaryFileFactory bff;
+    QObject *pBF = bff.Load(HELLO_PENT);
+    QVERIFY(pBF != 0);
+    Prog *prog = new Prog(HELLO_PENT);
+    FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
+    prog->setFrontEnd(pFE);
+    bool gotMain;
+    ADDRESS addr = pFE->getMainEntryPoint(gotMain);
+    QVERIFY(addr != NO_ADDRESS);
+
+    QString expected, actual;
+    QTextStream strm(&expected);
+    DecodeResult inst;
+    QVERIFY(pFE->decodeCachedInstruction(addr, inst));
+    inst.rtl->print(strm);
+    int numBytes = inst.numBytes;
+    RTL *first = inst.rtl;
+    // The second decode is served from the cache: same semantics, but a new RTL owned by the caller
+    QTextStream strm2(&actual);
+    QVERIFY(pFE->decodeCachedInstruction(addr, inst));
+    inst.rtl->print(strm2);
+    QVERIFY(inst.rtl != first);
+    QCOMPARE(inst.numBytes, numBytes);
+    QCOMPARE(actual, expected);
+    delete pFE;
+}
+
+void FrontPentTest::testSweep() {
+    BinaryFileFactory bff;
+    QObject *pBF = bff.Load(HELLO_PENT);
+    QVERIFY(pBF != 0);
+    Prog *prog = new Prog(HELLO_PENT);
+    FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
+    prog->setFrontEnd(pFE);
+    bool gotMain;
+    ADDRESS addr = pFE->getMainEntryPoint(gotMain);
+    QVERIFY(addr != NO_ADDRESS);
+
+    // main starts with push ebp; mov ebp, esp and calls printf
+    PentiumSweep sweeper(Boomerang::get()->getImage());
+    SweepResult found = sweeper.sweepAll(1);
+    QVERIFY(!found.callTargets.empty());
+    QVERIFY(found.prologues.count(addr) == 1);
+    SweepResult sharded = sweeper.sweepAll(4);
+    QVERIFY(sharded.prologues.count(addr) == 1);
+    delete pFE;
+}
+
 QTEST_MAIN(FrontPentTest)
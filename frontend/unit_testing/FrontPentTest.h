@@ -8,4 +8,8 @@ class FrontPentTest : public QObject {
     void test3();
     void testFindMain();
     void testBranch();
+    void testConcurrentDecode();
+    void testParallelDecode();
+    void testDecodeCache();
+    void testSweep();
 };
@@ -66,7 +66,8 @@ void FrontSparcTest::test1() {
     QVERIFY(addr != NO_ADDRESS);
 
     // Decode first instruction
-    DecodeResult inst = pFE->decodeInstruction(addr);
+    DecodeResult inst;
+    pFE->decodeInstruction(addr, inst);
     QVERIFY(inst.rtl != nullptr);
     inst.rtl->print(strm);
 
@@ -100,14 +101,14 @@ void FrontSparcTest::test1() {
     actual.clear();
 
     addr += inst.numBytes;
-    inst = pFE->decodeInstruction(addr);
+    pFE->decodeInstruction(addr, inst);
     inst.rtl->print(strm);
     expected = QString("00010688    0 *32* r8 := 0x10400\n");
     QCOMPARE(actual,expected);
     actual.clear();
 
     addr += inst.numBytes;
-    inst = pFE->decodeInstruction(addr);
+    pFE->decodeInstruction(addr, inst);
     inst.rtl->print(strm);
     expected = QString("0001068c    0 *32* r8 := r8 | 848\n");
     QCOMPARE(actual,expected);
@@ -131,7 +132,7 @@ void FrontSparcTest::test2() {
     FrontEnd *pFE = new SparcFrontEnd(pBF, prog, &bff);
     prog->setFrontEnd(pFE);
 
-    inst = pFE->decodeInstruction(ADDRESS::g(0x10690));
+    pFE->decodeInstruction(ADDRESS::g(0x10690), inst);
     inst.rtl->print(strm);
     // This call is to out of range of the program's text limits (to the Program Linkage Table (PLT), calling printf)
     // This is quite normal.
@@ -142,19 +143,19 @@ void FrontSparcTest::test2() {
     QCOMPARE(actual,expected);
     actual.clear();
 
-    inst = pFE->decodeInstruction(ADDRESS::g(0x10694));
+    pFE->decodeInstruction(ADDRESS::g(0x10694), inst);
     inst.rtl->print(strm);
     expected = QString("00010694\n");
     QCOMPARE(actual,expected);
     actual.clear();
 
-    inst = pFE->decodeInstruction(ADDRESS::g(0x10698));
+    pFE->decodeInstruction(ADDRESS::g(0x10698), inst);
     inst.rtl->print(strm);
     expected = QString("00010698    0 *32* r8 := 0\n");
     QCOMPARE(actual,expected);
     actual.clear();
 
-    inst = pFE->decodeInstruction(ADDRESS::g(0x1069c));
+    pFE->decodeInstruction(ADDRESS::g(0x1069c), inst);
     inst.rtl->print(strm);
     expected = QString("0001069c    0 *32* r24 := r8\n");
     QCOMPARE(actual,expected);
@@ -177,12 +178,12 @@ void FrontSparcTest::test3() {
     FrontEnd *pFE = new SparcFrontEnd(pBF, prog, &bff);
     prog->setFrontEnd(pFE);
 
-    inst = pFE->decodeInstruction(ADDRESS::g(0x106a0));
+    pFE->decodeInstruction(ADDRESS::g(0x106a0), inst);
     inst.rtl->print(strm);
     expected = QString("000106a0\n");
     QCOMPARE(actual,expected);
     actual.clear();
-    inst = pFE->decodeInstruction(ADDRESS::g(0x106a4));
+    pFE->decodeInstruction(ADDRESS::g(0x106a4), inst);
     inst.rtl->print(strm);
     expected = QString("000106a4    0 RET\n"
                            "              Modifieds: \n"
@@ -190,7 +191,7 @@ void FrontSparcTest::test3() {
     QCOMPARE(actual,expected);
     actual.clear();
 
-    inst = pFE->decodeInstruction(ADDRESS::g(0x106a8));
+    pFE->decodeInstruction(ADDRESS::g(0x106a8), inst);
     inst.rtl->print(strm);
     expected = QString("000106a8    0 *32* tmp := 0\n"
                            "            0 *32* r8 := r24\n"
@@ -240,7 +241,7 @@ void FrontSparcTest::testBranch() {
     prog->setFrontEnd(pFE);
 
     // bne
-    inst = pFE->decodeInstruction(ADDRESS::g(0x10ab0));
+    pFE->decodeInstruction(ADDRESS::g(0x10ab0), inst);
     inst.rtl->print(strm);
     expected = QString("00010ab0    0 BRANCH 0x10ac8, condition not equals\n"
                            "High level: %flags\n");
@@ -248,7 +249,7 @@ void FrontSparcTest::testBranch() {
     actual.clear();
 
     // bg
-    inst = pFE->decodeInstruction(ADDRESS::g(0x10af8));
+    pFE->decodeInstruction(ADDRESS::g(0x10af8), inst);
     inst.rtl->print(strm);
     expected = QString("00010af8    0 BRANCH 0x10b10, condition "
                            "signed greater\n"
@@ -257,7 +258,7 @@ void FrontSparcTest::testBranch() {
     actual.clear();
 
     // bleu
-    inst = pFE->decodeInstruction(ADDRESS::g(0x10b44));
+    pFE->decodeInstruction(ADDRESS::g(0x10b44), inst);
     inst.rtl->print(strm);
     expected = QString("00010b44    0 BRANCH 0x10b54, condition unsigned less or equals\n"
                            "High level: %flags\n");
@@ -27,10 +27,14 @@
 //#include "SymTab.h"    // Was used for relocaton stuff
 #include <QStringList>
 #include <QDebug>
+#include <QMap>
+#include <QPointer>
 #include <QString>
+#include <algorithm>
 #include <cassert>
 #include <list>
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -90,15 +94,67 @@ enum MACHINE {
     MACHINE_68K
 };
 
+//! One relocation of a loaded image
+struct RelocationInfo {
+    ADDRESS addr;    //!< Native address of the word being relocated
+    ADDRESS target;  //!< Value of the relocation's symbol, or NO_ADDRESS if there is none (or it is not known)
+    uint32_t type;   //!< Relocation type; format and machine dependent (e.g. R_386_32, IMAGE_REL_BASED_HIGHLOW)
+    uint32_t symbol; //!< Index of the relocation's symbol in the file's symbol table (0 if none)
+};
+
+/***************************************************************************/ /**
+  * \brief The relocations of a loaded image, ordered by address.
+  * Loaders add() each relocation while loading and call sort() once all have been added; lookups are then binary
+  * searches instead of walks over the file's relocation tables.
+  ******************************************************************************/
+class RelocationIndex {
+    std::vector<RelocationInfo> entries;
+
+public:
+    typedef std::vector<RelocationInfo>::const_iterator const_iterator;
+    void add(ADDRESS addr, uint32_t type, uint32_t symbol = 0, ADDRESS target = NO_ADDRESS) {
+        entries.push_back({addr, target, type, symbol});
+    }
+    void sort() {
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const RelocationInfo &a, const RelocationInfo &b) { return a.addr < b.addr; });
+        entries.shrink_to_fit();
+    }
+    void clear() { entries.clear(); }
+    //! The (first) relocation at native address addr, or nullptr if there is none
+    const RelocationInfo *find(ADDRESS addr) const {
+        auto it = std::lower_bound(entries.begin(), entries.end(), addr,
+                                   [](const RelocationInfo &r, ADDRESS a) { return r.addr < a; });
+        return (it != entries.end() && it->addr == addr) ? &*it : nullptr;
+    }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+};
+
 class BinaryFileFactory {
     // void *dlHandle; // TODO: consider replacing this with QPluginLoader instances to allow unloading ?
     QObject *getInstanceFor(const QString &sName);
+    QObject *getInstanceOf(const QString &libName);
+    static void resetImage();
     static QString m_base_path; //!< path from which the executable is being ran, used to find lib/ directory
+    //! The loader instance of each plugin library that can be reused. The libraries stay loaded, and the instance is
+    //! reused by every later load of the same format (a null entry means it was deleted; a new one is made)
+    static QMap<QString, QPointer<QObject>> m_plugins;
 
 public:
     static void setBasePath(const QString &path) { m_base_path = path; } //!< sets the base directory for plugin search
     QObject *Load(const QString &sName);
+    //! Load each file of \a files in turn and call \a process with it (nullptr if it could not be loaded), then
+    //! release the file. The loader instances are kept for the whole batch, so each file only costs its own load
+    void LoadBatch(const QStringList &files, const std::function<void(const QString &, QObject *)> &process);
+    //! Load each member of the archive \a sName in archive order, and call \a process with the member's name and
+    //! loader (nullptr if the member could not be loaded), then release the member. Members are loaded from the
+    //! archive's memory by the resident ELF loader. Returns false if the archive could not be read
+    bool LoadArchive(const QString &sName, const std::function<void(const QString &, QObject *)> &process);
     void UnLoad();
+    static bool isResident(const QObject *loader);
 };
 
 #define LoaderInterface_iid "org.boomerang.LoaderInterface"
@@ -128,13 +184,24 @@ public:
     virtual MACHINE getMachine() const = 0;   //!< Get the expected machine (e.g. MACHINE_PENTIUM)
     virtual QString getFilename() const = 0;
     virtual bool RealLoad(const QString &sName) = 0;
+    /// Load a file that is already in memory, such as a member of an archive; \a sName only names it. Returns
+    /// false if the load fails, or if the loader can't load from memory
+    virtual bool RealLoadFromMemory(const QString & /*sName*/, const char * /*data*/, size_t /*size*/) {
+        return false;
+    }
 
     /// Return the virtual address at which the binary expects to be loaded.
     /// For position independent / relocatable code this should be NO_ADDDRESS
     virtual ADDRESS getImageBase() = 0;
     virtual size_t getImageSize() = 0; //!< Return the total size of the loaded image
 
-    virtual bool IsRelocationAt(ADDRESS /*uNative*/) { return false; }
+    /// The relocations of the loaded image, or nullptr if the loader doesn't index them
+    virtual const RelocationIndex *getRelocations() const { return nullptr; }
+    /// True if a relocation applies to the word at native address uNative
+    virtual bool IsRelocationAt(ADDRESS uNative) {
+        const RelocationIndex *relocs = getRelocations();
+        return relocs != nullptr && relocs->find(uNative) != nullptr;
+    }
 
     virtual ADDRESS IsJumpToAnotherAddr(ADDRESS /*uNative*/) { return NO_ADDRESS; }
     virtual bool hasDebugInfo() { return false; }
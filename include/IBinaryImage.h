@@ -3,9 +3,19 @@
 
 #include "types.h"
 
+#include <vector>
+
 struct IBinarySection;
 class QString;
 
+//! A NUL terminated run of text in the loaded image's data sections, found by IBinaryImage::indexStrings
+struct StringConstant {
+    ADDRESS addr;          //!< Native address of the first character
+    uint32_t length;       //!< Number of characters, not counting the terminating NUL
+    uint8_t encoding;      //!< 0: 7 bit ASCII; 1: has 8 bit characters (Latin-1, UTF-8, ...)
+    bool inStringsSection; //!< In a range the loader marked as holding strings ("StringsSection" attribute)
+};
+
 class IBinaryImage {
 public:
     typedef std::vector<IBinarySection *>    SectionListType;
@@ -32,8 +42,22 @@ public:
     virtual float readNativeFloat4(ADDRESS nat) = 0;//!< Read 4 bytes as a float; considers endianness
     virtual double readNativeFloat8(ADDRESS nat) = 0;//!< Read 8 bytes as a float; considers endianness
     virtual void writeNative4(ADDRESS nat, uint32_t n)=0;
+    //! Host pointer to the \a size bytes at native address \a nat, which must all be in the loaded data of one
+    //! section; nullptr otherwise. Lets a caller (e.g. a decoder) read a span without a lookup per access
+    virtual const uint8_t *readSpan(ADDRESS nat, size_t size) const = 0;
 
     virtual bool isReadOnly(ADDRESS uEntry) =0; //!< returns true if the given address is in a read only section
+    //! Whether loaders should leave copying each section's contents in until it is first used (see
+    //! IBinarySection::setLazyContents); for huge images of which little is analysed
+    virtual void setLazySections(bool lazy) = 0;
+    virtual bool lazySections() const = 0;
+
+    //! Scan the loaded data and read only sections once for strings; called after the loader is done
+    virtual void indexStrings() = 0;
+    //! The string that contains \a a (which may point into its middle), or nullptr if there is none
+    virtual const StringConstant *findString(ADDRESS a) const = 0;
+    //! All the strings, ordered by address; made once, at load time unless some sections are loaded lazily
+    virtual const std::vector<StringConstant> &getStrings() const = 0;
     virtual iterator                begin()       =0;
     virtual const_iterator          begin() const =0;
     virtual iterator                end  ()       =0;
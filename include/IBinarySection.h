@@ -11,6 +11,16 @@
 class QVariant;
 class QString;
 
+//! Well known attributes of address ranges within a section. These are kept as bits, so that querying them
+//! neither allocates nor compares strings; any other attribute is a named QVariant (see setAttributeForRange)
+enum SectionAttribute : uint32_t {
+    ATTR_None = 0,
+    ATTR_StringsSection = 1 << 0, //!< Holds string constants (e.g. Mach-O __cstring, __cfstring)
+    ATTR_ReadOnly = 1 << 1,
+    ATTR_Code = 1 << 2,
+    ATTR_Data = 1 << 3,
+};
+
 struct IBinarySection {
     virtual ~IBinarySection() {}
     virtual ADDRESS     hostAddr() const = 0; //!< address of this section's data in the allocated memory
@@ -32,11 +42,23 @@ struct IBinarySection {
     virtual IBinarySection &setHostAddr(ADDRESS ) = 0;
     virtual IBinarySection &setEntrySize(uint32_t ) = 0;
     virtual IBinarySection &setEndian(uint8_t ) = 0;
+    //! Copy the section's contents (\a size bytes from \a src, which must stay valid until then) to hostAddr() only
+    //! when they are first used, rather than when loading. The rest of the section must already be zero
+    virtual IBinarySection &setLazyContents(const void *src, uint32_t size) = 0;
+    //! Make sure the section's contents are in memory. hostAddr() does this, so only code that reads the image
+    //! through pointers of its own (e.g. a loader) needs to call it
+    virtual void        materialise() const = 0;
+    virtual bool        isMaterialised() const = 0;
 
     virtual void        resize(uint32_t ) = 0;
     virtual void        addDefinedArea(ADDRESS from,ADDRESS to) = 0;
     virtual void        setAttributeForRange(const QString &name,const QVariant &val,ADDRESS from,ADDRESS to) = 0;
     virtual QVariantMap getAttributesForRange(ADDRESS from,ADDRESS to) = 0;
+    virtual void        addAttributeFlags(uint32_t flags,ADDRESS from,ADDRESS to) = 0;
+    //! The union of the SectionAttribute flags of all ranges overlapping [from, to)
+    virtual uint32_t    attributeFlagsInRange(ADDRESS from,ADDRESS to) const = 0;
+    //! True if any of the given SectionAttribute flags is set at address a
+    virtual bool        hasAttribute(uint32_t flags,ADDRESS a) const = 0;
 
     ///////////////////
     // utility methods
@@ -33,9 +33,14 @@ public:
 public:
     virtual const IBinarySymbol *find(ADDRESS a) const = 0;  //!< Find an entry by address; nullptr if none
     virtual const IBinarySymbol *find(const QString &s) const = 0;  //!< Find an entry by name; NO_ADDRESS if none
+    //! Find the symbol whose range [location, location+size) contains \a a (the innermost one if they nest);
+    //! nullptr if none
+    virtual const IBinarySymbol *findContainingSymbol(ADDRESS a) const = 0;
     //! Add a new symbol to table, if \a local is set than the symbol is local, thus it won't be
     //! added to global name->symbol mapping
     virtual IBinarySymbol &create(ADDRESS a, const QString &s,bool local=false) = 0;
+    //! Make room for \a n more symbols, so that a loader adding many at once only sizes the indexes once
+    virtual void reserve(size_t /*n*/) {}
 
     virtual iterator            begin()       = 0;
     virtual const_iterator      begin() const = 0;
@@ -2,16 +2,37 @@
 
 #include "types.h"
 
+#include <functional>
 #include <queue>
+#include <set>
+#include <vector>
 class Cfg;
 class BasicBlock;
 //! Put the target queue logic into this small class
+//! Targets are returned lowest address first, so that decoding walks through memory in order, and an address is
+//! only queued once until the queue runs dry.
 class TargetQueue {
-    std::queue<ADDRESS> targets;
+    std::priority_queue<ADDRESS, std::vector<ADDRESS>, std::greater<ADDRESS>> targets;
+    std::vector<ADDRESS> batch; // Popped from targets, still to be returned by nextAddress()
+    size_t batchPos = 0;
+    // Which addresses have been queued by visit(). A bitmap over the text section, with a set for anything else
+    ADDRESS textLow = ADDRESS::g(0L), textHigh = ADDRESS::g(0L);
+    std::vector<bool> queued;
+    std::vector<ADDRESS> marked; // Addresses with their bit set in queued, so that it can be cleared quickly
+    std::set<ADDRESS> queuedOutside;
+
+    bool markQueued(ADDRESS a);
+    void clearMarks();
+    static bool needsDecode(const Cfg &cfg, ADDRESS a);
 
   public:
+    //! Number of targets nextAddress() takes from the queue at a time
+    static const size_t BATCH_SIZE = 16;
+
+    void clear();
     void visit(Cfg *pCfg, ADDRESS uNewAddr, BasicBlock *&pNewBB);
     void initial(ADDRESS uAddr);
+    size_t nextAddresses(const Cfg &cfg, std::vector<ADDRESS> &run, size_t maxCount = BATCH_SIZE);
     ADDRESS nextAddress(const Cfg &cfg);
     void dump();
 
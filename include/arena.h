@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2016, The Boomerang team
+ *
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL
+ * WARRANTIES.
+ *
+ */
+
+/***************************************************************************/ /**
+  * \file       arena.h
+  * \brief   Region allocation of the intermediate representation (Exp, Instruction and RTL objects) of a procedure
+  ******************************************************************************/
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/***************************************************************************/ /**
+  * A ProcArena hands out memory from a few large slabs, so that the IR of one procedure is allocated contiguously
+  * rather than by many separate mallocs. Exp, Instruction and RTL allocate through ProcArena::allocate(), which
+  * uses the arena made current (on this thread) by a ProcArena::Scope, and the heap when there is none.
+  * Deleting an object in an arena only counts the free: its memory is released, together with the rest of the
+  * arena, when the arena is destroyed. Each object carries a small header naming its arena, so that deleting one
+  * needs no lock even while other threads allocate.
+  * \note Only one thread may allocate from an arena at a time
+  ******************************************************************************/
+class ProcArena {
+  public:
+    //! Makes an arena (or the heap, for nullptr) current on this thread for the lifetime of the scope
+    class Scope {
+      public:
+        explicit Scope(ProcArena *arena);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+      private:
+        ProcArena *Saved;
+    };
+
+    ProcArena();
+    ~ProcArena(); //!< Releases all the memory of the arena
+    ProcArena(const ProcArena &) = delete;
+    ProcArena &operator=(const ProcArena &) = delete;
+
+    static void *allocate(size_t size); //!< Allocate from the current arena, or the heap if there is none
+    static void deallocate(void *p);    //!< Free memory from allocate()
+    //! The result of make(), called with the heap current. For objects that must outlive every arena, such as
+    //! function-local statics, which may first be built while some procedure's arena is current
+    template <class F> static auto onHeap(F make) -> decltype(make()) {
+        Scope heap(nullptr);
+        return make();
+    }
+
+    size_t allocations() const { return Allocs; } //!< Number of objects allocated in this arena
+    size_t frees() const { return Frees; }         //!< Number of those that were deleted
+    size_t bytesAllocated() const { return Bytes; }
+    size_t slabCount() const { return Slabs.size(); }
+
+  private:
+    struct Slab {
+        char *begin;
+        char *end;
+    };
+    void *bump(size_t size);
+    Slab newSlab(size_t size);
+
+    static thread_local ProcArena *Current;
+    std::vector<Slab> Slabs;
+    char *Next = nullptr; //!< Free space in the newest small object slab
+    char *Limit = nullptr;
+    std::atomic<size_t> Allocs;
+    std::atomic<size_t> Frees;
+    size_t Bytes = 0;
+};
+
+#endif // __ARENA_H__
@@ -143,6 +143,7 @@ class BasicBlock {
 
     /* Liveness */
     LocationSet LiveIn;                  //!< Set of locations live at BB start
+    LocationBitSet LiveInBits;           //!< LiveIn while Cfg::findInterferences works on it
     /*
      * Depth first traversal of all bbs, numbering as we go and as we come back, forward and reverse passes.
      * Use Cfg::establishDFTOrder() and CFG::establishRevDFTOrder to create these values.
@@ -289,7 +290,7 @@ class BasicBlock {
 
     // Liveness
     bool calcLiveness(ConnectionGraph &ig, UserProc *proc);
-    void getLiveOut(LocationSet &live, LocationSet &phiLocs);
+    void getLiveOut(LocationBitSet &live, LocationSet &phiLocs, LocationNumbering &nums);
 
     bool decodeIndirectJmp(UserProc *proc);
     void processSwitch(UserProc *proc);
@@ -36,6 +36,7 @@
 #include <QObject>
 #include <QDir>
 #include <QTextStream>
+#include <ctime>
 #include <string>
 #include <set>
 #include <vector>
@@ -45,6 +46,7 @@ class QString;
 class SeparateLogger;
 class Log;
 class Prog;
+class FrontEnd;
 class Function;
 class UserProc;
 class HLLCode;
@@ -142,7 +144,10 @@ public:
     /// Returns the path to where the output files are saved.
     const QString &getOutputPath() { return outputPath; }
     Prog *loadAndDecode(const QString &fname, const char *pname = nullptr);
+    Prog *decode(Prog *prog, FrontEnd *fe, const char *pname = nullptr);
     int decompile(const QString &fname, const char *pname = nullptr);
+    int decompile(Prog *prog, time_t start);
+    int decompileArchive(const QString &fname);
     /// Add a Watcher to the set of Watchers for this Boomerang object.
     void addWatcher(Watcher *watcher) { watchers.insert(watcher); }
     void persistToXML(Prog *prog);
@@ -285,6 +290,12 @@ public:
     bool generateCallGraph = false;
     bool generateSymbols = false;
     bool noGlobals = false;
+    bool noSSLCache = false;          ///< Always parse the .ssl file, never use or write its binary cache
+    bool linearSweep = false;         ///< Find procedure starts with a linear sweep of the code before decoding
+    bool lazySections = false;        ///< Copy in each section's contents only when first used
+    bool loadArchive = false;         ///< The input is an archive: decompile each of its members (-LA)
+    bool procArenas = false;          ///< Allocate the IR of each procedure in its own ProcArena
+    int numDecodeThreads = 1;         ///< Number of threads decoding instructions in parallel (1: decode sequentially)
     bool assumeABI = false;    ///< Assume ABI compliance
     bool experimental = false; ///< Activate experimental code. Caution!
     QTextStream LogStream;
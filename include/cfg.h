@@ -19,6 +19,7 @@
 
 #include "types.h"
 #include "exphelp.h"    // For lessExpStar
+#include "managed.h"    // For LocationNumbering
 
 #include <cstdio> // For FILE
 #include <list>
@@ -70,6 +71,7 @@ class Cfg {
     BasicBlock *exitBB;
     sCallStatement CallSites;
     mExpStatement implicitMap;
+    LocationNumbering liveNumbering; //!< Numbers the locations in the BBs' liveness sets
 
   public:
     class BBAlreadyExistsError : public std::exception {
@@ -191,6 +193,7 @@ class Cfg {
     bool implicitsDone() { return ImplicitsDone; }    //!<  True if implicits have been created
     void setImplicitsDone() { ImplicitsDone = true; } //!< Call when implicits have been created
     void findInterferences(ConnectionGraph &ig);
+    LocationNumbering &getLiveNumbering() { return liveNumbering; }
     void appendBBs(std::list<BasicBlock *> &worklist, std::set<BasicBlock *> &workset);
     void removeUsedGlobals(std::set<Global *> &unusedGlobals);
     void bbSearchAll(Exp *search, std::list<Exp *> &result, bool ch);
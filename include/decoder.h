@@ -19,12 +19,15 @@
 
 #include <list>
 #include <cstddef>
+#include <unordered_map>
+#include <mutex>
 #include "types.h"
 #include "rtl.h"
 
 class Exp;
 class RTL;
 class Prog;
+class Function;
 
 // These are the instruction classes defined in "A Transformational Approach to
 // Binary Translation of Delayed Branches" for SPARC instructions.
@@ -81,6 +84,12 @@ struct DecodeResult {
      * At present, only used for the SPARC call/add caller prologue
      */
     ADDRESS forceOutEdge;
+
+    /**
+     * The fixed destination of a call whose procedure the decoder did not create, because the decoding thread holds
+     * a NJMCDecoder::DeferNewProcs; NO_ADDRESS otherwise. FrontEnd::decodeCachedInstruction() creates it later
+     */
+    ADDRESS callDest;
 };
 
 /***************************************************************************/ /**
@@ -94,8 +103,12 @@ public:
     NJMCDecoder(Prog *prog);
     virtual ~NJMCDecoder() {}
 
-    //! Decodes the machine instruction at pc and returns an RTL instance for the instruction.
-    virtual DecodeResult &decodeInstruction(ADDRESS pc, ptrdiff_t delta) = 0;
+    /**
+     * Decodes the machine instruction at pc into result, which is owned by the caller (decoders keep no per
+     * instruction state of their own, so one decoder may be used by several threads at once).
+     * \returns result.valid
+     */
+    virtual bool decodeInstruction(ADDRESS pc, ptrdiff_t delta, DecodeResult &result) = 0;
 
     /**
      * Disassembles the machine instruction at pc and returns the number of bytes disassembled.
@@ -109,8 +122,23 @@ public:
                       DecodeResult &result);
     Prog *getProg() { return prog; }
 
+    //! While one of these is in scope, the decoders leave creating the procedures for the calls they decode on this
+    //! thread to their caller (see DecodeResult::callDest). Held by the decoding threads of
+    //! FrontEnd::decodeInParallel(), so that procedures are only created (and numbered) by the main thread
+    class DeferNewProcs {
+        bool saved;
+
+      public:
+        DeferNewProcs();
+        ~DeferNewProcs();
+        //! True if the calling thread holds one
+        static bool active();
+    };
+
 protected:
+    Function *newCallProc(ADDRESS dest, DecodeResult &result);
     std::list<Instruction *> *instantiate(ADDRESS pc, const char *name, ...);
+    int lookupOpcode(const char *name);
 
     Exp *instantiateNamedParam(char *name, ...);
 
@@ -124,6 +152,13 @@ protected:
     // Public dictionary of instruction patterns, and other information summarised from the SSL file
     // (e.g. source machine's endianness)
     RTLInstDict RTLDict;
+
+    //! RTLDict opcode ids of the instruction names passed to instantiate(), keyed by the address of the name.
+    //! The generated decoders only ever pass string literals or their static MATCH_name tables, so each distinct
+    //! mnemonic is normalised and looked up once.
+    std::unordered_map<const char *, int> opcodeIds;
+    std::mutex opcodeIdsMutex; //!< Guards opcodeIds, the only state decoding threads update
+
 };
 
 // Function used to guess whether a given pc-relative address is the start of a function
@@ -23,6 +23,7 @@
 #include "util.h"
 //#include "statement.h"    // For StmtSet etc
 #include "exphelp.h"
+#include "arena.h"
 //#include "memo.h"
 
 #include <QtCore/QString>
@@ -66,20 +67,64 @@ typedef std::shared_ptr<RTL> SharedRTL;
 //! functions not overridden by derived classes can be called
 class Exp : public Printable {
   protected:
+    //! The hash of an expression shared by hashCons(); zero for all other expressions. Copies (clones) are never
+    //! shared, so copying doesn't copy the hash
+    struct ConsHash {
+        uint32_t value;
+        constexpr ConsHash() : value(0) {}
+        constexpr ConsHash(const ConsHash &) : value(0) {}
+        ConsHash &operator=(const ConsHash &) { return *this; }
+    };
     OPER op; // The operator (e.g. opPlus)
     mutable unsigned lexBegin = 0, lexEnd = 0;
+    ConsHash consHash;
+    //! Generation in which simplify() last left this expression in normal form; zero if it has been changed since.
+    //! See isSimplified()
+    uint64_t simpGen = 0;
     // Constructor, with ID
     constexpr Exp(OPER _op) : op(_op) {}
+    //! Call before changing this expression in place: it must not be shared, and is no longer in normal form
+    void changing() {
+        assert(!isHashConsed());
+        simpGen = 0;
+    }
+    //! True if sub, a direct subexpression of this, has not changed since this was simplified
+    bool childUnchanged(const Exp *sub) const {
+        return sub->isHashConsed() || (sub->simpGen != 0 && sub->simpGen <= simpGen);
+    }
+    //! Replace the subexpression in slot (of this expression) with e, noting the change if there is one. A change
+    //! made in place below e counts, so that it is seen all the way up a recursive rewrite such as accept()
+    void setChild(Exp *&slot, Exp *e) {
+        if (slot != e || !childUnchanged(e)) {
+            simpGen = 0;
+            slot = e;
+        }
+    }
+    //! Record that this expression and all its subexpressions are in normal form, as of generation gen. Parts that
+    //! have not changed since they were last simplified keep their (earlier) generation
+    void setSimplified(uint64_t gen);
+    //! Constant time form of isSimplified(): only this expression and its direct subexpressions are looked at. Sound
+    //! only once clearStaleStamps() has been run over the whole expression, as simplify() does before polySimplify()
+    bool shallowSimplified() const;
+    //! Clear the stamp of every part of this expression that has a changed part below it, so that the stamps that are
+    //! left can be trusted by shallowSimplified(). Returns true if the whole expression is still simplified
+    bool clearStaleStamps();
 
   public:
     // Virtual destructor
     virtual ~Exp() {}
+    //! Expressions are allocated in the arena of the procedure being worked on, if there is one (see ProcArena)
+    static void *operator new(size_t size) { return ProcArena::allocate(size); }
+    static void operator delete(void *p) { ProcArena::deallocate(p); }
 
     //! Return the operator. Note: I'd like to make this protected, but then subclasses don't seem to be able to use
     //! it (at least, for subexpressions)
     OPER getOper() const { return op; }
     const char *getOperName() const;
-    void setOper(OPER x) { op = x; } // A few simplifications use this
+    void setOper(OPER x) { // A few simplifications use this
+        changing();
+        op = x;
+    }
 
     void setLexBegin(unsigned int n) const { lexBegin = n; }
     void setLexEnd(unsigned int n) const { lexEnd = n; }
@@ -104,12 +149,22 @@ class Exp : public Printable {
 
     //! Clone (make copy of self that can be deleted without affecting self)
     virtual Exp *clone() const = 0;
+    //! Return the one shared copy of this expression, if it is of a shape that is never changed in place (constants,
+    //! registers, m[...] and subscripts of those); otherwise a clone. Shared copies must not be modified or deleted
+    Exp *hashCons() const;
+    //! True if this is a shared copy returned by hashCons()
+    bool isHashConsed() const { return consHash.value != 0; }
+    //! True if simplify() has left this expression in normal form, and no part of it has been changed since
+    bool isSimplified() const;
 
     // Comparison
     //! Type sensitive equality
     virtual bool operator==(const Exp &o) const = 0;
+    //! Type sensitive three way comparison: negative, zero or positive as this is less than, equal to (for the
+    //! purposes of ordering) or greater than o
+    virtual int compare(const Exp &o) const = 0;
     //! Type sensitive less than
-    virtual bool operator<(const Exp &o) const = 0;
+    bool operator<(const Exp &o) const { return compare(o) < 0; }
     //! Type insensitive less than. Class TypedExp overrides
     virtual bool operator<<(const Exp &o) const { return (*this < o); }
     //! Comparison ignoring subscripts
@@ -400,7 +455,7 @@ class Const : public Exp {
 
     // Compare
     virtual bool operator==(const Exp &o) const;
-    virtual bool operator<(const Exp &o) const;
+    virtual int compare(const Exp &o) const;
     virtual bool operator*=(Exp &o);
 
     // Get the constant
@@ -412,16 +467,34 @@ class Const : public Exp {
     QString getFuncName() const;
 
     // Set the constant
-    void setInt(int i) { u.i = i; }
-    void setLong(QWord ll) { u.ll = ll; }
-    void setFlt(double d) { u.d = d; }
-    void setStr(const QString &p) { strin = p; }
-    void setAddr(ADDRESS a) { u.a = a; }
+    void setInt(int i) {
+        changing();
+        u.i = i;
+    }
+    void setLong(QWord ll) {
+        changing();
+        u.ll = ll;
+    }
+    void setFlt(double d) {
+        changing();
+        u.d = d;
+    }
+    void setStr(const QString &p) {
+        changing();
+        strin = p;
+    }
+    void setAddr(ADDRESS a) {
+        changing();
+        u.a = a;
+    }
 
     // Get and set the type
     SharedType getType() { return type; }
     const SharedType getType() const { return type; }
-    void setType(SharedType ty) { type = ty; }
+    void setType(SharedType ty) {
+        changing();
+        type = ty;
+    }
 
     virtual void print(QTextStream &os, bool = false) const;
     // Print "recursive" (extra parens not wanted at outer levels)
@@ -437,8 +510,11 @@ class Const : public Exp {
 
     virtual bool match(const QString &pattern, std::map<QString, Exp *> &bindings);
 
-    int getConscript() { return conscript; }
-    void setConscript(int cs) { conscript = cs; }
+    int getConscript() const { return conscript; }
+    void setConscript(int cs) {
+        changing();
+        conscript = cs;
+    }
 
     virtual SharedType ascendType();
     virtual void descendType(SharedType parentType, bool &ch, Instruction *s);
@@ -462,7 +538,7 @@ class Terminal : public Exp {
 
     // Compare
     virtual bool operator==(const Exp &o) const override;
-    virtual bool operator<(const Exp &o) const override;
+    virtual int compare(const Exp &o) const override;
     virtual bool operator*=(Exp &o) override;
     virtual void print(QTextStream &os, bool = false) const override;
     virtual void appendDotFile(QTextStream &of) override;
@@ -504,7 +580,7 @@ class Unary : public Exp {
 
     // Compare
     virtual bool operator==(const Exp &o) const override;
-    virtual bool operator<(const Exp &o) const override;
+    virtual int compare(const Exp &o) const override;
     virtual bool operator*=(Exp &o) override;
 
     // Destructor
@@ -520,7 +596,7 @@ class Unary : public Exp {
 
     // Set first subexpression
     void setSubExp1(Exp *e) override;
-    void setSubExp1ND(Exp *e) { subExp1 = e; }
+    void setSubExp1ND(Exp *e) { setChild(subExp1, e); }
     // Get first subexpression
     Exp *getSubExp1() override;
     const Exp *getSubExp1() const override;
@@ -575,7 +651,7 @@ class Binary : public Unary {
 
     // Compare
     virtual bool operator==(const Exp &o) const override;
-    virtual bool operator<(const Exp &o) const override;
+    virtual int compare(const Exp &o) const override;
     virtual bool operator*=(Exp &o) override;
 
     // Destructor
@@ -647,7 +723,7 @@ class Ternary : public Binary {
 
     // Compare
     virtual bool operator==(const Exp &o) const override;
-    virtual bool operator<(const Exp &o) const override;
+    virtual int compare(const Exp &o) const override;
     virtual bool operator*=(Exp &o) override;
 
     // Destructor
@@ -716,7 +792,7 @@ class TypedExp : public Unary {
 
     // Compare
     virtual bool operator==(const Exp &o) const override;
-    virtual bool operator<(const Exp &o) const override;
+    virtual int compare(const Exp &o) const override;
     virtual bool operator<<(const Exp &o) const override;
     virtual bool operator*=(Exp &o) override;
 
@@ -727,7 +803,10 @@ class TypedExp : public Unary {
     // Get and set the type
     virtual SharedType getType() { return type; }
     virtual const SharedType &getType() const { return type; }
-    virtual void setType(SharedType ty) { type = ty; }
+    virtual void setType(SharedType ty) {
+        changing();
+        type = ty;
+    }
 
     // polySimplify
     virtual Exp *polySimplify(bool &bMod) override;
@@ -753,7 +832,7 @@ class FlagDef : public Unary {
     FlagDef(Exp *params, SharedRTL rtl); // Constructor
     virtual ~FlagDef();             // Destructor
     virtual void appendDotFile(QTextStream &of);
-//    RTL *getRtl() { return rtl; }
+    const SharedRTL &getRtl() const { return rtl; }
 //    void setRtl(RTL *r) { rtl = r; }
 
     // Visitation
@@ -782,18 +861,20 @@ class RefExp : public Unary {
     static RefExp *get(Exp *e, Instruction *def) { return new RefExp(e, def); }
     virtual Exp *clone() const override;
     virtual bool operator==(const Exp &o) const override;
-    virtual bool operator<(const Exp &o) const override;
+    virtual int compare(const Exp &o) const override;
     virtual bool operator*=(Exp &o) override;
 
     virtual void print(QTextStream &os, bool html = false) const override;
     virtual void printx(int ind) const override;
     // virtual int        getNumRefs() {return 1;}
-    Instruction *getDef() { return def; } // Ugh was called getRef()
+    Instruction *getDef() const { return def; } // Ugh was called getRef()
     Exp *addSubscript(Instruction *_def) {
+        simpGen = 0;
         def = _def;
         return this;
     }
     void setDef(Instruction *_def) { /*assert(_def);*/
+        changing();
         def = _def;
     }
     virtual Exp *genConstraints(Exp *restrictTo) override;
@@ -829,10 +910,13 @@ class TypeVal : public Terminal {
     ~TypeVal();
 
     virtual SharedType getType() { return val; }
-    virtual void setType(SharedType t) { val = t; }
+    virtual void setType(SharedType t) {
+        changing();
+        val = t;
+    }
     virtual Exp *clone() const override;
     virtual bool operator==(const Exp &o) const override;
-    virtual bool operator<(const Exp &o) const override;
+    virtual int compare(const Exp &o) const override;
     virtual bool operator*=(Exp &o) override;
     virtual void print(QTextStream &os, bool = false) const override;
     virtual void printx(int ind) const override;
@@ -873,8 +957,11 @@ class Location : public Unary {
     // Clone
     virtual Exp *clone() const override;
 
-    void setProc(UserProc *p) { proc = p; }
-    UserProc *getProc() { return proc; }
+    void setProc(UserProc *p) {
+        changing();
+        proc = p;
+    }
+    UserProc *getProc() const { return proc; }
 
     virtual Exp *polySimplify(bool &bMod) override;
     virtual void getDefinitions(LocationSet &defs);
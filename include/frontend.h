@@ -23,10 +23,13 @@
 #include "sigenum.h" // For enums platform and cc
 #include "BinaryFile.h"
 #include "TargetQueue.h"
+#include "decoder.h" // For DecodeResult
 
 #include <list>
 #include <map>
+#include <mutex>
 #include <queue>
+#include <vector>
 #include <fstream>
 #include <QMap>
 class UserProc;
@@ -38,7 +41,6 @@ class Exp;
 class TypedExp;
 class Cfg;
 class Prog;
-struct DecodeResult;
 class Signature;
 class Instruction;
 class CallStatement;
@@ -81,6 +83,11 @@ protected:
     std::map<ADDRESS, QString> refHints;
     // Map from address to previously decoded RTLs for decoded indirect control transfer instructions
     std::map<ADDRESS, RTL *> previouslyDecoded;
+    std::mutex decodedRtlsMutex; // Guards previouslyDecoded
+    // Map from native address to the decoder's result at that address, so that re-decoding a procedure (e.g. after
+    // a switch statement is found) does not run the decoder again. An entry with a null rtl is never reused
+    std::map<ADDRESS, DecodeResult> decodeCache;
+    std::mutex decodeCacheMutex; // Guards decodeCache
 
 public:
     /*
@@ -108,7 +115,9 @@ public:
     // Function to fetch the smallest machine instruction
     // virtual    int            getInst(int addr);
 
-    virtual DecodeResult &decodeInstruction(ADDRESS pc);
+    virtual bool decodeInstruction(ADDRESS pc, DecodeResult &result);
+    // As decodeInstruction, but reuse (a clone of) an earlier decode of the same address if there is one
+    bool decodeCachedInstruction(ADDRESS pc, DecodeResult &result);
 
     virtual void extraProcessCall(CallStatement * /*call*/, std::list<RTL *> * /*BB_rtls*/) {}
 
@@ -134,6 +143,10 @@ public:
     void decode(Prog *Program, bool decodeMain = true, const char *pname = nullptr);
     // Decode all procs starting at a given address in a given program.
     void decode(Prog *Program, ADDRESS a);
+    // Decode the instructions of all undecoded procedures (and their callees) with numThreads worker threads
+    void decodeInParallel(int numThreads);
+    // Decode the instructions reachable from entry into the decode cache, collecting the call destinations
+    void decodeProcInstructions(ADDRESS entry, std::vector<ADDRESS> &callees);
     // Decode one proc starting at a given address in a given program.
     void decodeOnly(Prog *Program, ADDRESS a);
     // Decode a fragment of a procedure, e.g. for each destination of a switch statement
@@ -158,6 +171,12 @@ public:
      */
     virtual ADDRESS getMainEntryPoint(bool &gotMain) = 0;
 
+    /**
+     * Find likely procedure starts with a fast pass over the code (no semantic decoding), and create undecoded
+     * procs for them. Only implemented for some machines.
+     */
+    virtual void sweepForProcs() {}
+
     /**
      * Returns a list of all available entrypoints.
      */
@@ -195,7 +214,16 @@ public:
      * decoded indirect call statements in a new decode following analysis of such instructions. The CFG is
      * incomplete in these cases, and needs to be restarted from scratch
      */
-    void addDecodedRtl(ADDRESS a, RTL *rtl) { previouslyDecoded[a] = rtl; }
+    void addDecodedRtl(ADDRESS a, RTL *rtl) {
+        std::lock_guard<std::mutex> guard(decodedRtlsMutex);
+        previouslyDecoded[a] = rtl;
+    }
+    //! Find a previously decoded RTL at address a, or nullptr if there is none
+    RTL *findDecodedRtl(ADDRESS a) {
+        std::lock_guard<std::mutex> guard(decodedRtlsMutex);
+        auto ff = previouslyDecoded.find(a);
+        return ff == previouslyDecoded.end() ? nullptr : ff->second;
+    }
     void preprocessProcGoto(std::list<Instruction *>::iterator ss, ADDRESS dest, const std::list<Instruction *> &sl,
                             RTL *pRtl);
     void checkEntryPoint(std::vector<ADDRESS> &entrypoints, ADDRESS addr, const char *type);
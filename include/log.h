@@ -5,6 +5,7 @@
 #include <QString>
 #include <memory>
 #include <fstream>
+#include <mutex>
 
 class Instruction;
 class Exp;
@@ -35,6 +36,7 @@ public:
 class FileLogger : public Log {
 protected:
     std::ofstream out;
+    std::mutex outMutex; //!< Procedures may be decoded by several threads at once
 public:
     FileLogger(); // Implemented in boomerang.cpp
     virtual ~FileLogger() {}
@@ -43,6 +45,7 @@ public:
 class SeparateLogger : public Log {
 protected:
     std::ofstream *out;
+    std::mutex outMutex;
 
 public:
     SeparateLogger(const QString &); // Implemented in boomerang.cpp
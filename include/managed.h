@@ -15,6 +15,8 @@
   *                StatementList
   *                StatementVec
   *                LocationSet
+  *                LocationNumbering
+  *                LocationBitSet
   *                //LocationList
   *                ConnectionGraph
   *==============================================================================================*/
@@ -23,7 +25,9 @@
 #define __MANAGED_H__
 #include "exphelp.h" // For lessExpStar
 
+#include <cstdint>
 #include <list>
+#include <map>
 #include <set>
 #include <vector>
 
@@ -180,32 +184,133 @@ class LocationSet {
     void addSubscript(Instruction *def /* , Cfg* cfg */); // Add a subscript to all elements
 };                                                      // class LocationSet
 
+/// A dense numbering (0, 1, 2...) of the distinct locations seen in one procedure, so that sets of them can be bit
+/// vectors (see LocationBitSet). Locations are told apart with lessExpStar, as in a LocationSet; each one is cloned
+/// when it is first numbered, so changes to the original don't disturb the numbering. The clones are deleted by
+/// clear()
+class LocationNumbering {
+    std::map<Exp *, int, lessExpStar> numbers;
+    std::vector<Exp *> locations;
+    std::vector<int> bases;              // For a subscripted location, the number of the location without the ref
+    std::vector<std::vector<int>> refsOf; // The numbers of the subscripts of each location, in lessExpStar order
+
+  public:
+    LocationNumbering() = default;
+    LocationNumbering(const LocationNumbering &) = delete; // Owns its clones
+    LocationNumbering &operator=(const LocationNumbering &) = delete;
+    ~LocationNumbering() { clear(); }
+    int number(Exp *loc);          //!< The number of loc, numbering it if it is new
+    int find(Exp *loc) const;      //!< The number of loc; -1 if it has none
+    Exp *location(int n) const { return locations[n]; }
+    size_t size() const { return locations.size(); }
+    int baseOf(int n) const { return bases[n]; } //!< For x{d}, the number of x; -1 if n is not subscripted
+    const std::vector<int> &refsOfBase(int base) const { return refsOf[base]; }
+    void clear();
+};
+
+/// A set of locations, as a bit vector indexed by LocationNumbering numbers. Union, difference, intersection and
+/// comparison work a word at a time; iteration is in numbering order (not lessExpStar order)
+class LocationBitSet {
+    std::vector<uint64_t> words;
+
+  public:
+    void insert(int n) {
+        if (size_t(n / 64) >= words.size())
+            words.resize(n / 64 + 1);
+        words[n / 64] |= uint64_t(1) << (n % 64);
+    }
+    void remove(int n) {
+        if (size_t(n / 64) < words.size())
+            words[n / 64] &= ~(uint64_t(1) << (n % 64));
+    }
+    bool exists(int n) const { return size_t(n / 64) < words.size() && (words[n / 64] >> (n % 64)) & 1; }
+    void makeUnion(const LocationBitSet &other);
+    void makeDiff(const LocationBitSet &other);
+    void makeIsect(const LocationBitSet &other);
+    bool isSubSetOf(const LocationBitSet &other) const;
+    bool operator==(const LocationBitSet &o) const;
+    size_t size() const; //!< Number of elements
+    bool empty() const { return size() == 0; }
+    void clear() { words.clear(); }
+    //! Call f with the number of each element, in increasing order
+    template <class F> void forEach(F f) const {
+        for (size_t i = 0; i < words.size(); ++i)
+            for (uint64_t w = words[i]; w; w &= w - 1)
+                f(int(i * 64 + lowestBit(w)));
+    }
+    //! Add the elements to ls (clones of the numbered locations)
+    void toLocationSet(const LocationNumbering &nums, LocationSet &ls) const;
+    //! As LocationSet::findDifferentRef: find an element with the same base as e but a different ref. The first
+    //! such element in lessExpStar order is returned in dr
+    bool findDifferentRef(const LocationNumbering &nums, int e, int &dr) const;
+
+  private:
+    static int lowestBit(uint64_t w);
+};
+
 /// A class to store connections in a graph, e.g. for interferences of types or live ranges, or the phi_unite relation
 /// that phi statements imply
-/// If a is connected to b, then b is automatically connected to a
-// This is implemented in a std::multimap, even though Appel suggests a bitmap (e.g. std::vector<bool> does this in a
-// space efficient manner), but then you still need maps from expression to bit number. So here a standard map is used,
-// and when a -> b is inserted, b->a is redundantly inserted.
+/// Connections are directed (a -> b), but connect() makes both a -> b and b -> a
+// The locations (usually SSA variables, i.e. RefExps) are given dense numbers as they are first seen, so that the
+// connections can be kept in a triangular bit matrix (two bits, one for each direction, for every pair of numbers)
+// for constant time queries and duplicate checks, and in adjacency vectors for enumeration. Only numbering a new
+// location needs a structural (lessExpStar) lookup.
 class ConnectionGraph {
-    std::multimap<Exp *, Exp *, lessExpStar> emap; // The map
   public:
-    typedef std::multimap<Exp *, Exp *, lessExpStar>::iterator iterator;
-    typedef std::multimap<Exp *, Exp *, lessExpStar>::const_iterator const_iterator;
+    typedef std::pair<Exp *, Exp *> value_type;
+    //! Visits the connections a -> b in lessExpStar order of a, then in the order in which they were added
+    class const_iterator {
+      public:
+        const_iterator() : graph(nullptr), pos(0) {}
+        const value_type &operator*() const { return cur; }
+        const value_type *operator->() const { return &cur; }
+        const_iterator &operator++();
+        const_iterator operator++(int) {
+            const_iterator res(*this);
+            ++*this;
+            return res;
+        }
+        bool operator==(const const_iterator &o) const { return var == o.var && pos == o.pos; }
+        bool operator!=(const const_iterator &o) const { return !(*this == o); }
+
+      private:
+        friend class ConnectionGraph;
+        const_iterator(const ConnectionGraph *g, std::map<Exp *, int, lessExpStar>::const_iterator v);
+        void settle(); //!< Move to the first connection at or after (var, pos)
+        const ConnectionGraph *graph;
+        std::map<Exp *, int, lessExpStar>::const_iterator var;
+        size_t pos; //!< Index into the adjacency vector of var
+        value_type cur;
+    };
+    typedef const_iterator iterator;
     ConnectionGraph() {}
 
-    void add(Exp *a, Exp *b); // Add pair with check for existing
+    void add(Exp *a, Exp *b); // Add a -> b if not already there
     void connect(Exp *a, Exp *b);
-    iterator begin() { return emap.begin(); }
-    iterator end() { return emap.end(); }
-    const_iterator begin() const { return emap.begin(); }
-    const_iterator end() const { return emap.end(); }
+    const_iterator begin() const { return const_iterator(this, index.begin()); }
+    const_iterator end() const { return const_iterator(this, index.end()); }
     int count(Exp *a) const;
     bool isConnected(Exp *a, const Exp &b) const;
     void update(Exp *a, Exp *b, Exp *c);
-    iterator remove(iterator aa); // Remove the mapping at *aa
-    void dump() const;            // Dump for debugging
-private:
-    std::vector<Exp *> allConnected(Exp *a);
+    size_t numLocations() const { return vars.size(); } //!< Number of locations numbered so far
+    void clear();
+    void dump() const; // Dump for debugging
+
+  private:
+    int number(Exp *e);             //!< Number of e, numbering it if it is new
+    int find(const Exp *e) const;   //!< Number of e, or -1 if it has none
+    size_t bitOf(int from, int to) const;
+    bool hasEdge(int from, int to) const {
+        size_t bit = bitOf(from, to);
+        return (matrix[bit / 64] >> (bit % 64)) & 1;
+    }
+    void addEdge(int from, int to); //!< Add from -> to if not already there
+    std::vector<int> allConnected(int a) const { return adj[a]; }
+
+    std::map<Exp *, int, lessExpStar> index; //!< Number of each location
+    std::vector<Exp *> vars;                 //!< Location of each number
+    std::vector<std::vector<int>> adj;       //!< Targets of the connections from each number, in the order added
+    std::vector<uint64_t> matrix;            //!< Row i holds columns 0..i; two bits per element
 };
 QTextStream &operator<<(QTextStream &os, const AssignSet *as);
 QTextStream &operator<<(QTextStream &os, const InstructionSet *ss);
@@ -24,6 +24,7 @@
 #include "memo.h"
 #include "dataflow.h"  // For class UseCollector
 #include "statement.h" // For embedded ReturnStatement pointer, etc
+#include "arena.h"
 
 #include <list>
 #include <vector>
@@ -488,7 +489,12 @@ public:
 private:
     ReturnStatement *theReturnStatement;
     mutable int DFGcount; //!< used in dotty output
+    //! Where the IR of this proc is allocated while it is decoded and decompiled; nullptr for the heap. Owned by
+    //! the Prog, since other procs keep pointers into this proc's IR for as long as the program lives
+    ProcArena *arena = nullptr;
 public:
+    ProcArena *getArena() const { return arena; }
+    QString arenaStats() const; //!< Allocation and free counts of this proc's arena, for reporting
     ADDRESS getTheReturnAddr() { return theReturnStatement == nullptr ? NO_ADDRESS : theReturnStatement->getRetAddr(); }
     void setTheReturnAddr(ReturnStatement *s, ADDRESS r) {
         assert(theReturnStatement == nullptr);
@@ -17,11 +17,15 @@
 #define _PROG_H_
 
 #include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "BinaryFile.h"
 #include "frontend.h"
 #include "type.h"
 #include "module.h"
 #include "util.h"
+#include "arena.h"
 // TODO: refactor Prog Global handling into separate class
 class RTLInstDict;
 class Function;
@@ -94,6 +98,8 @@ public:
 
     Function *findProc(ADDRESS uAddr) const;
     Function *findProc(const QString &name) const;
+    //! Lock this while updating procedures shared between decoding threads (see FrontEnd::decodeInParallel)
+    std::recursive_mutex &getProcsMutex() const { return procsMutex; }
     Function *findContainingProc(ADDRESS uAddr) const;
     bool isProcLabel(ADDRESS addr);
     QString getNameNoPath() const;
@@ -115,6 +121,7 @@ public:
     void finishDecode();
     void decompile();
     void removeUnusedGlobals();
+    ProcArena *newProcArena(); //!< A new arena for the IR of a proc, released when the program is
     void removeRestoreStmts(InstructionSet &rs);
     void globalTypeAnalysis();
     bool removeUnusedReturns();
@@ -220,12 +227,17 @@ protected:
     QObject *pLoaderPlugin; //!< Pointer to the instance returned by loader plugin
     LoaderInterface *pLoaderIface = nullptr;
     FrontEnd *DefaultFrontend; //!< Pointer to the FrontEnd object for the project
+    void releaseLoader();
 
     /* Persistent state */
     QString m_name;            // name of the program
     QString m_path;            // its full path
     // FIXME: is a set of Globals the most appropriate data structure? Surely not.
     std::set<Global *> globals; //!< globals to print at code generation time
+    std::mutex globalsMutex;    //!< Serialises globals created by addReloc, which decoding threads call
+    //! Guards the lists of procedures while they are decoded in parallel
+    mutable std::recursive_mutex procsMutex;
+    std::vector<std::unique_ptr<ProcArena>> procArenas; //!< Arenas of all procs, ever; guarded by procsMutex
     DataIntervalMap globalMap;  //!< Map from address to DataInterval (has size, name, type)
     int m_iNumberedProc;        //!< Next numbered proc will use this
     Module *m_rootCluster;     //!< Root of the cluster tree
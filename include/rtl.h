@@ -35,7 +35,9 @@
 #include <utility>                      // for pair
 #include <vector>                       // for vector
 #include <QMap>
+#include <QByteArray>
 #include <memory>
+#include "arena.h"
 
 class Exp;  // lines 38-38
 class Instruction;  // lines 47-47
@@ -56,6 +58,9 @@ class RTL : public std::list<Instruction *> {
     RTL(ADDRESS instNativeAddr, const std::list<Instruction *> *listStmt = nullptr);
     RTL(const RTL &other); // Makes deep copy of "other"
     ~RTL();
+    //! RTLs are allocated in the arena of the procedure being worked on, if there is one (see ProcArena)
+    static void *operator new(size_t size) { return ProcArena::allocate(size); }
+    static void operator delete(void *p) { ProcArena::deallocate(p); }
 
     RTL *clone() const;
     RTL &operator=(const RTL &other);
@@ -109,6 +114,16 @@ class TableEntry {
 
 #define TEF_NEXTPC 1
     int flags; // aka required capabilities. Init. to 0
+
+    //! Precompiled copy of rtl, with every formal parameter replaced by a numbered slot (see
+    //! RTLInstDict::compileTemplates). Empty until the dictionary is compiled.
+    RTL compiled;
+    //! One entry per statement of compiled; true if that statement refers to at least one slot
+    std::vector<bool> slotted;
+    //! True if post-variables depend on the operands, so have to be eliminated after each instantiation
+    bool latePostVars;
+    bool isCompiled;
+    int opcodeId; //!< Index of this entry in RTLInstDict::OpcodeTable, -1 if not numbered yet
 };
 
 /***************************************************************************/ /**
@@ -152,18 +167,32 @@ class RTLInstDict {
     bool readSSLFile(const QString &SSLFileName);
     void reset();
     std::pair<QString, unsigned> getSignature(const char *name);
+    int getOpcodeId(const char *name) const;
+    //! Number of operands taken by the instruction with the given opcode id
+    unsigned getNumOperands(int opcodeId) const { return OpcodeTable[opcodeId]->params.size(); }
 
     int appendToDict(const QString &n, std::list<QString> &p, RTL &rtl);
 
-    std::list<Instruction *> *instantiateRTL(const QString &name, ADDRESS natPC, const std::vector<Exp *> &actuals);
-    std::list<Instruction *> *instantiateRTL(RTL &rtls, ADDRESS, std::list<QString> &params,
-                                           const std::vector<Exp *> &actuals);
+    // Instantiation only reads the dictionary, so once it has been read it can be shared by several decoding threads
+    std::list<Instruction *> *instantiateRTL(const QString &name, ADDRESS natPC,
+                                           const std::vector<Exp *> &actuals) const;
+    std::list<Instruction *> *instantiateRTL(const RTL &rtls, ADDRESS, const std::list<QString> &params,
+                                           const std::vector<Exp *> &actuals) const;
+    std::list<Instruction *> *instantiateRTL(const TableEntry &entry, ADDRESS natPC,
+                                           const std::vector<Exp *> &actuals) const;
+    std::list<Instruction *> *instantiateRTL(int opcodeId, ADDRESS natPC, const std::vector<Exp *> &actuals) const;
 
-    void transformPostVars(std::list<Instruction *> &rts, bool optimise);
+    void transformPostVars(std::list<Instruction *> &rts, bool optimise) const;
     void print(QTextStream &os);
     void addRegister(const QString &name, int id, int size, bool flt);
     bool partialType(Exp *exp, Type &ty);
     void fixupParams();
+    void compileTemplates();
+
+    static QByteArray sslFileHash(const QString &SSLFileName);
+    static QString cacheFileName(const QByteArray &sslHash);
+    bool writeCache(const QString &fileName, const QByteArray &sslHash);
+    bool readCache(const QString &fileName, const QByteArray &sslHash);
 
   public:
     //! A map from the symbolic representation of a register (e.g. "%g0") to its index within an array of registers.
@@ -195,10 +224,17 @@ class RTLInstDict {
     //! The actual dictionary.
     std::map<QString, TableEntry, std::less<QString>> idict;
 
+    //! Dense numbering of the idict entries (see getOpcodeId), built by compileTemplates()
+    std::vector<TableEntry *> OpcodeTable;
+
     //! An RTL describing the machine's basic fetch-execute cycle
     SharedRTL fetchExecCycle;
 
     void fixupParamsSub(const QString &s, std::list<QString> &funcParams, bool &haveCount, int mark);
+
+  protected:
+    void compileTemplate(TableEntry &entry);
+    void dumpIfDebugging();
 };
 
 #endif /*__RTL_H__*/
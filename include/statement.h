@@ -31,6 +31,7 @@
 #include "exphelp.h" // For lessExpStar, lessAssignment etc
 #include "types.h"
 #include "managed.h"
+#include "arena.h"
 #include "dataflow.h"  // For embedded objects DefCollector and UseCollector
 //#include "boomerang.h" // For USE_DOMINANCE_NUMS etc
 
@@ -138,6 +139,10 @@ protected:
 public:
     Instruction() : Parent(nullptr), proc(nullptr), Number(0) {} //, parent(nullptr)
     virtual ~Instruction() {}
+    //! Statements are allocated in the arena of the procedure being worked on, if there is one (see ProcArena)
+    static void *operator new(size_t size) { return ProcArena::allocate(size); }
+    static void *operator new(size_t, void *p) { return p; } // See PhiAssign::convertToAssign
+    static void operator delete(void *p) { ProcArena::deallocate(p); }
 
     // get/set the enclosing BB, etc
     BasicBlock *getBB() { return Parent; }
@@ -1,5 +1,6 @@
 /*
  * Copyright (C) 1998, The University of Queensland
+ * Copyright (C) 2016, The Boomerang team
  *
  * See the file "LICENSE.TERMS" for information on usage and
  * redistribution of this file, and for a DISCLAIMER OF ALL
@@ -11,30 +12,247 @@
  * Desc: This file contains the implementation of the ArchiveFile class
 */
 
-#include "global.h"
+#include "ArchiveFile.h"
+#include "elf/ElfTypes.h"
 
-ArchiveFile::ArchiveFile() { // Constructor
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace {
+const char AR_MAGIC[] = "!<arch>\n";
+const size_t AR_MAGIC_SIZE = 8;
+
+// Header of each archive member; all fields are space padded ASCII
+struct ArHeader {
+    char ar_name[16];
+    char ar_date[12];
+    char ar_uid[6];
+    char ar_gid[6];
+    char ar_mode[8];
+    char ar_size[10];
+    char ar_fmag[2]; // "`\n"
+};
+
+size_t decimalField(const char *p, size_t n) {
+    size_t v = 0;
+    for (size_t i = 0; i < n && p[i] >= '0' && p[i] <= '9'; ++i)
+        v = v * 10 + (p[i] - '0');
+    return v;
+}
+
+uint32_t readBE4(const uint8_t *p) { return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+
+// Read a 2 or 4 byte ELF field of either endianness
+struct ElfReader {
+    bool bigEndian;
+    uint32_t read4(const void *v) const {
+        const uint8_t *p = (const uint8_t *)v;
+        return bigEndian ? readBE4(p) : (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+    }
+    uint16_t read2(const void *v) const {
+        const uint8_t *p = (const uint8_t *)v;
+        return bigEndian ? (p[0] << 8) | p[1] : p[0] | (p[1] << 8);
+    }
+};
+}
+
+ArchiveFile::ArchiveFile() : m_pImage(nullptr), m_size(0) { // Constructor
 }
 
 ArchiveFile::~ArchiveFile() { // Destructor
+    UnLoad();
 }
 
-int ArchiveFile::GetNumMembers() const { return m_FileMap.size(); }
+bool ArchiveFile::Load(const QString &sName) {
+    UnLoad();
+    m_file.setFileName(sName);
+    if (!m_file.open(QFile::ReadOnly)) {
+        fprintf(stderr, "Could not open %s\n", qPrintable(sName));
+        return false;
+    }
+    m_size = m_file.size();
+    // Members are used in place, so the whole archive is mapped rather than read
+    m_pImage = m_file.map(0, m_size);
+    if (m_pImage == nullptr) {
+        m_copy = m_file.readAll();
+        m_pImage = (const uint8_t *)m_copy.constData();
+    }
+    if (m_size < AR_MAGIC_SIZE || memcmp(m_pImage, AR_MAGIC, AR_MAGIC_SIZE) != 0) {
+        fprintf(stderr, "Error - %s is not an archive (.a) file\n", qPrintable(sName));
+        UnLoad();
+        return false;
+    }
+    if (!indexMembers()) {
+        fprintf(stderr, "Error - %s is a corrupt archive\n", qPrintable(sName));
+        UnLoad();
+        return false;
+    }
+    return true;
+}
+
+void ArchiveFile::UnLoad() {
+    m_Members.clear();
+    m_FileMap.clear();
+    m_SymMap.clear();
+    if (m_pImage && m_copy.isEmpty())
+        m_file.unmap(const_cast<uint8_t *>(m_pImage));
+    m_file.close();
+    m_copy.clear();
+    m_pImage = nullptr;
+    m_size = 0;
+}
 
-const char *ArchiveFile::GetMemberFileName(int i) const { return m_FileNames[i]; }
+/***************************************************************************/ /**
+  *
+  * \brief Walk the member headers, recording the name and extent of each member. The symbol index and long name
+  * table are special members, and are not added to m_Members.
+  * \returns false if a header is malformed
+  ******************************************************************************/
+bool ArchiveFile::indexMembers() {
+    const char *longNames = nullptr;
+    size_t longNamesSize = 0;
+    const uint8_t *symIndex = nullptr;
+    size_t symIndexSize = 0;
+    for (size_t offs = AR_MAGIC_SIZE; offs + sizeof(ArHeader) <= m_size;) {
+        const ArHeader *hdr = (const ArHeader *)(m_pImage + offs);
+        if (hdr->ar_fmag[0] != '`' || hdr->ar_fmag[1] != '\n')
+            return false;
+        size_t size = decimalField(hdr->ar_size, sizeof(hdr->ar_size));
+        const uint8_t *data = m_pImage + offs + sizeof(ArHeader);
+        if (size > m_size - offs - sizeof(ArHeader))
+            return false;
+        QString name;
+        if (hdr->ar_name[0] == '/' && hdr->ar_name[1] == ' ') {
+            symIndex = data; // System V / GNU symbol index
+            symIndexSize = size;
+        } else if (hdr->ar_name[0] == '/' && hdr->ar_name[1] == '/') {
+            longNames = (const char *)data;
+            longNamesSize = size;
+        } else if (hdr->ar_name[0] == '/' && hdr->ar_name[1] >= '0' && hdr->ar_name[1] <= '9') {
+            // GNU long name: offset into the long name table, where the name ends with "/\n"
+            size_t at = decimalField(hdr->ar_name + 1, sizeof(hdr->ar_name) - 1);
+            if (longNames == nullptr || at >= longNamesSize)
+                return false;
+            size_t end = at;
+            while (end < longNamesSize && longNames[end] != '/' && longNames[end] != '\n')
+                ++end;
+            name = QString::fromLatin1(longNames + at, end - at);
+        } else if (memcmp(hdr->ar_name, "#1/", 3) == 0) {
+            // BSD long name: stored at the start of the member's data
+            size_t len = decimalField(hdr->ar_name + 3, sizeof(hdr->ar_name) - 3);
+            if (len > size)
+                return false;
+            name = QString::fromLatin1((const char *)data, strnlen((const char *)data, len));
+            data += len;
+            size -= len;
+        } else {
+            size_t len = sizeof(hdr->ar_name);
+            while (len > 0 && (hdr->ar_name[len - 1] == ' ' || hdr->ar_name[len - 1] == '/'))
+                --len;
+            name = QString::fromLatin1(hdr->ar_name, len);
+        }
+        if (!name.isEmpty() && name != "__.SYMDEF" && name != "__.SYMDEF SORTED") {
+            m_FileMap.insert(name, (int)m_Members.size());
+            m_Members.push_back({name, offs, data, size, QStringList()});
+        }
+        offs = (data - m_pImage) + size;
+        offs += offs & 1; // Members are 2 byte aligned
+    }
+    if (symIndex)
+        readSymbolIndex(symIndex, symIndexSize);
+    return true;
+}
 
-BinaryFile *ArchiveFile::GetMemberByProcName(const string &sSym) {
-    // Get the index
-    int idx = m_SymMap[sSym];
-    // Look it up
-    return GetMember(idx);
+/***************************************************************************/ /**
+  *
+  * \brief Read a System V symbol index: a big endian count, then that many big endian offsets of member headers,
+  * then the symbol names (NUL terminated, in the same order)
+  ******************************************************************************/
+void ArchiveFile::readSymbolIndex(const uint8_t *p, size_t size) {
+    if (size < 4)
+        return;
+    uint32_t count = readBE4(p);
+    if (count > (size - 4) / 4)
+        return;
+    std::vector<size_t> headerOffsets;
+    headerOffsets.reserve(m_Members.size());
+    for (const ArchiveMember &m : m_Members)
+        headerOffsets.push_back(m.headerOffset); // Already sorted
+    const char *names = (const char *)p + 4 + 4 * count;
+    const char *namesEnd = (const char *)p + size;
+    for (uint32_t i = 0; i < count && names < namesEnd; ++i) {
+        size_t len = strnlen(names, namesEnd - names);
+        size_t offset = readBE4(p + 4 + 4 * i);
+        auto it = std::lower_bound(headerOffsets.begin(), headerOffsets.end(), offset);
+        // Only the header of an indexed member will do: not a skipped (e.g. long names) member, nor a corrupt offset
+        if (it != headerOffsets.end() && *it == offset)
+            m_SymMap.insert(QString::fromLatin1(names, len), int(it - headerOffsets.begin()));
+        names += len + 1;
+    }
 }
 
-BinaryFile *ArchiveFile::GetMemberByFileName(const string &sFile) {
-    // Get the index
-    int idx = m_FileMap[sFile];
-    // Look it up
-    return GetMember(idx);
+/***************************************************************************/ /**
+  *
+  * \brief Add the global symbols defined by \a member to its definedSymbols, if it is a 32 bit ELF object.
+  * Only reads the member, so several members can be done at the same time.
+  ******************************************************************************/
+void ArchiveFile::readElfSymbols(ArchiveMember &member) {
+    const uint8_t *image = member.data;
+    size_t size = member.size;
+    if (size < sizeof(Elf32_Ehdr) || memcmp(image, "\177ELF", 4) != 0 || image[4] != 1) // 1: ELFCLASS32
+        return;
+    const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)image;
+    ElfReader rd{ehdr->endianness == 2}; // 2: ELFDATA2MSB
+    uint32_t shoff = rd.read4(&ehdr->e_shoff);
+    uint32_t shnum = rd.read2(&ehdr->e_shnum);
+    if (shoff > size || shnum > (size - shoff) / sizeof(Elf32_Shdr))
+        return;
+    const Elf32_Shdr *shdrs = (const Elf32_Shdr *)(image + shoff);
+    for (uint32_t i = 0; i < shnum; ++i) {
+        if (rd.read4(&shdrs[i].sh_type) != SHT_SYMTAB)
+            continue;
+        uint32_t symOff = rd.read4(&shdrs[i].sh_offset), symSize = rd.read4(&shdrs[i].sh_size);
+        uint32_t strSect = rd.read4(&shdrs[i].sh_link);
+        if (strSect >= shnum || symOff > size || symSize > size - symOff)
+            continue;
+        uint32_t strOff = rd.read4(&shdrs[strSect].sh_offset), strSize = rd.read4(&shdrs[strSect].sh_size);
+        if (strOff > size || strSize > size - strOff)
+            continue;
+        const char *strings = (const char *)image + strOff;
+        const Elf32_Sym *syms = (const Elf32_Sym *)(image + symOff);
+        for (uint32_t n = 1; n < symSize / sizeof(Elf32_Sym); ++n) {
+            ElfSymBinding bind = ELF32_ST_BIND(syms[n].st_info);
+            uint32_t name = rd.read4(&syms[n].st_name);
+            if ((bind != STB_GLOBAL && bind != STB_WEAK) || rd.read2(&syms[n].st_shndx) == 0 || name >= strSize)
+                continue; // Local or undefined (SHN_UNDEF)
+            member.definedSymbols << QString::fromLatin1(strings + name, strnlen(strings + name, strSize - name));
+        }
+    }
 }
 
-bool ArchiveFile::PostLoadMember(BinaryFile *pBF, void *handle) { return pBF->PostLoad(handle); }
+void ArchiveFile::extractSymbols(int numThreads) {
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i; (i = next++) < m_Members.size();) {
+            m_Members[i].definedSymbols.clear();
+            readElfSymbols(m_Members[i]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numThreads; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread &t : threads)
+        t.join();
+    // Members without an entry in the archive's symbol index can now be found by the symbols they define
+    for (size_t i = 0; i < m_Members.size(); ++i)
+        for (const QString &sym : m_Members[i].definedSymbols)
+            if (!m_SymMap.contains(sym))
+                m_SymMap.insert(sym, (int)i);
+}
+
+int ArchiveFile::GetMemberByFileName(const QString &sFile) const { return m_FileMap.value(sFile, -1); }
+
+int ArchiveFile::GetMemberByProcName(const QString &sSym) const { return m_SymMap.value(sSym, -1); }
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2016, The Boomerang team
+ *
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL
+ * WARRANTIES.
+ *
+ */
+
+/** \file ArchiveFile.h
+ * \brief This file contains the definition of the ArchiveFile class, a reader for ar (.a) archives
+*/
+#ifndef __ARCHIVEFILE_H__
+#define __ARCHIVEFILE_H__
+
+#include <QFile>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+#include <vector>
+
+//! One member of an archive. Its data is a view into the archive's mapping; nothing is copied
+struct ArchiveMember {
+    QString name;               //!< File name of the member
+    size_t headerOffset;        //!< Offset of the member's header in the archive
+    const uint8_t *data;        //!< The member's contents
+    size_t size;                //!< Size of the member's contents in bytes
+    QStringList definedSymbols; //!< Global symbols the member defines; filled in by extractSymbols()
+};
+
+/***************************************************************************/ /**
+  * ArchiveFile maps an ar archive (a static library) and indexes all of its members when loaded: System V / GNU
+  * (including the "//" long name table) and BSD ("#1/" names) layouts are understood. The archive's own symbol
+  * index ("/"), if there is one, maps symbols to members; extractSymbols() instead reads the symbol tables of the
+  * (32 bit ELF) members themselves, on several threads.
+  ******************************************************************************/
+class ArchiveFile {
+  public:
+    ArchiveFile();
+    ~ArchiveFile();
+    bool Load(const QString &sName); //!< Map and index the archive sName
+    void UnLoad();
+
+    int GetNumMembers() const { return (int)m_Members.size(); }
+    const ArchiveMember &GetMember(int i) const { return m_Members[i]; }
+    QString GetMemberFileName(int i) const { return m_Members[i].name; }
+    int GetMemberByFileName(const QString &sFile) const; //!< Index of the member named sFile; -1 if none
+    int GetMemberByProcName(const QString &sSym) const;  //!< Index of the member defining sSym; -1 if none
+
+    //! Fill in the definedSymbols of every member, using numThreads threads. The results (and the member order)
+    //! don't depend on numThreads
+    void extractSymbols(int numThreads);
+
+  private:
+    bool indexMembers();
+    void readSymbolIndex(const uint8_t *p, size_t size);
+    static void readElfSymbols(ArchiveMember &member);
+
+    QFile m_file;
+    const uint8_t *m_pImage; //!< The mapped (or, failing that, read) archive
+    size_t m_size;
+    QByteArray m_copy;       //!< The archive's contents if it could not be mapped
+    std::vector<ArchiveMember> m_Members;
+    QMap<QString, int> m_FileMap; //!< Member name to member index
+    QMap<QString, int> m_SymMap;  //!< Symbol to member index
+};
+
+#endif // __ARCHIVEFILE_H__
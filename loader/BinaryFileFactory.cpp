@@ -7,6 +7,7 @@
 */
 
 #include "BinaryFile.h"
+#include "ArchiveFile.h"
 #include "boomerang.h"
 #include "IBinaryImage.h"
 #include "IBinarySymbols.h"
@@ -17,6 +18,7 @@
 #include <QString>
 #include <QDebug>
 #include <cstdio>
+#include <cstring>
 
 #define LMMH(x)                                                                                                        \
     ((unsigned)((Byte *)(&x))[0] + ((unsigned)((Byte *)(&x))[1] << 8) + ((unsigned)((Byte *)(&x))[2] << 16) +          \
@@ -24,11 +26,31 @@
 
 using namespace std;
 QString BinaryFileFactory::m_base_path = "";
+QMap<QString, QPointer<QObject>> BinaryFileFactory::m_plugins;
 
-QObject *BinaryFileFactory::Load(const QString &sName) {
+//! Loaders whose Close() resets all the state of the file loaded before, so that one instance can load any number
+//! of files. Instances of the others belong to whoever loaded the file, who deletes them so that the next load
+//! starts from a new instance
+static const char *const ResidentLoaders[] = {"ElfBinaryFile", "Win32BinaryFile", "MachOBinaryFile"};
+
+static bool isReusable(const QString &libName) {
+    for (const char *name : ResidentLoaders)
+        if (libName == name)
+            return true;
+    return false;
+}
+
+//! Empty the image and symbol table for the next file
+void BinaryFileFactory::resetImage() {
     IBinaryImage *Image = Boomerang::get()->getImage();
     Image->reset();
+    Image->setLazySections(Boomerang::get()->lazySections);
     Boomerang::get()->getSymbols()->clear();
+}
+
+QObject *BinaryFileFactory::Load(const QString &sName) {
+    IBinaryImage *Image = Boomerang::get()->getImage();
+    resetImage();
     QObject *pBF = getInstanceFor(sName);
     LoaderInterface *ldr_iface = qobject_cast<LoaderInterface *>(pBF);
     if (ldr_iface == nullptr) {
@@ -43,9 +65,68 @@ QObject *BinaryFileFactory::Load(const QString &sName) {
         return nullptr;
     }
     Image->calculateTextLimits();
+    Image->indexStrings();
     return pBF;
 }
 
+void BinaryFileFactory::LoadBatch(const QStringList &files,
+                                  const std::function<void(const QString &, QObject *)> &process) {
+    for (const QString &fname : files) {
+        QObject *pBF = Load(fname);
+        process(fname, pBF);
+        // Release this file's image, but keep a resident loader instance for the next file of its format
+        LoaderInterface *ldr_iface = qobject_cast<LoaderInterface *>(pBF);
+        if (ldr_iface == nullptr)
+            continue;
+        if (isResident(pBF))
+            ldr_iface->UnLoad();
+        else
+            delete pBF;
+    }
+}
+
+/**
+ * Members are loaded one at a time, in the order they are in the archive, so the results don't depend on anything
+ * but the archive. They can't be loaded concurrently: every load fills the process-wide image and symbol table.
+ * Members that are not ELF files are passed to \a process as not loaded.
+ */
+bool BinaryFileFactory::LoadArchive(const QString &sName,
+                                    const std::function<void(const QString &, QObject *)> &process) {
+    ArchiveFile archive;
+    if (!archive.Load(sName)) {
+        qWarning() << "Loading archive '" << sName << "' failed";
+        return false;
+    }
+    IBinaryImage *Image = Boomerang::get()->getImage();
+    for (int i = 0; i < archive.GetNumMembers(); ++i) {
+        const ArchiveMember &member = archive.GetMember(i);
+        QObject *pBF = nullptr;
+        if (member.size >= 4 && memcmp(member.data, "\177ELF", 4) == 0) {
+            resetImage();
+            pBF = getInstanceOf("ElfBinaryFile");
+            LoaderInterface *ldr_iface = qobject_cast<LoaderInterface *>(pBF);
+            if (ldr_iface == nullptr)
+                pBF = nullptr;
+            else {
+                ldr_iface->initialize(Boomerang::get());
+                ldr_iface->Close();
+                if (ldr_iface->RealLoadFromMemory(member.name, (const char *)member.data, member.size)) {
+                    Image->calculateTextLimits();
+                    Image->indexStrings();
+                } else {
+                    qWarning() << "Loading member '" << member.name << "' of '" << sName << "' failed";
+                    ldr_iface->UnLoad();
+                    pBF = nullptr;
+                }
+            }
+        }
+        process(member.name, pBF);
+        if (pBF)
+            qobject_cast<LoaderInterface *>(pBF)->UnLoad(); // The ELF loader is resident, so it is kept
+    }
+    return true;
+}
+
 #define TESTMAGIC2(buf, off, a, b) (buf[off] == a && buf[off + 1] == b)
 #define TESTMAGIC4(buf, off, a, b, c, d) (buf[off] == a && buf[off + 1] == b && buf[off + 2] == c && buf[off + 3] == d)
 
@@ -105,21 +186,46 @@ static QString selectPluginForFile(const QString &sName) {
  * instance of the appropriate subclass.
  */
 QObject *BinaryFileFactory::getInstanceFor(const QString &sName) {
+    QString libName = selectPluginForFile(sName);
+    if (libName.isEmpty())
+        return nullptr;
+    return getInstanceOf(libName);
+}
+
+//! An instance of the loader in the plugin library \a libName
+QObject *BinaryFileFactory::getInstanceOf(const QString &libName) {
+    // Reuse the instance from an earlier load if there is one; Load() resets it with Close()
+    bool reusable = isReusable(libName);
+    if (reusable && m_plugins.value(libName))
+        return m_plugins.value(libName);
+
     QDir pluginsDir(qApp->applicationDirPath());
     pluginsDir.cd("lib");
     if (!qApp->libraryPaths().contains(pluginsDir.absolutePath())) {
         qApp->addLibraryPath(pluginsDir.absolutePath());
     }
-    QString libName = selectPluginForFile(sName);
-    if (libName.isEmpty())
-        return nullptr;
-
     QPluginLoader plugin_loader(libName);
     if (!plugin_loader.load()) {
         qCritical() << plugin_loader.errorString();
         return nullptr;
     }
-    return plugin_loader.instance();
+    QObject *instance = plugin_loader.instance();
+    if (reusable)
+        m_plugins[libName] = instance;
+    return instance;
+}
+
+/**
+ * True if \a loader is an instance kept by the factory for later loads. It must not be deleted by the Prog (or
+ * anything else) using it; UnLoad() releases the file it has loaded.
+ */
+bool BinaryFileFactory::isResident(const QObject *loader) {
+    if (loader == nullptr)
+        return false;
+    for (const QPointer<QObject> &instance : m_plugins)
+        if (instance == loader)
+            return true;
+    return false;
 }
 
 void BinaryFileFactory::UnLoad() {
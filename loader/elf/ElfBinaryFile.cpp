@@ -60,9 +60,9 @@ struct Translated_ElfSym{
 
 typedef std::map<QString, int, std::less<QString>> StrIntMap;
 
-ElfBinaryFile::ElfBinaryFile() : next_extern(ADDRESS::g(0L)) {
-    m_fd = nullptr;
+ElfBinaryFile::ElfBinaryFile() : next_extern(ADDRESS::g(0L)), m_sh_link(nullptr), m_sh_info(nullptr) {
     m_pFileName = nullptr;
+    m_pImportStubs = nullptr;
     Init(); // Initialise all the common stuff
 }
 
@@ -70,7 +70,7 @@ ElfBinaryFile::~ElfBinaryFile() {
     if (m_pImportStubs)
         // Delete the array of import stubs
         delete []m_pImportStubs;
-    delete  []m_pImage;
+    freeImage();
     delete  []m_sh_link;
     delete  []m_sh_info;
 
@@ -86,6 +86,7 @@ void ElfBinaryFile::initialize(IBoomerang *sys)
 // we're up to
 void ElfBinaryFile::Init() {
     m_pImage = nullptr;
+    m_bImageMapped = false;
     m_pPhdrs = nullptr;   // No program headers
     m_pShdrs = nullptr;   // No section headers
     m_pStrings = nullptr; // No strings
@@ -94,8 +95,15 @@ void ElfBinaryFile::Init() {
     m_uPltMin = 0; // No PLT limits
     m_uPltMax = 0;
     m_iLastSize = 0;
+    delete[] m_pImportStubs;
     m_pImportStubs = nullptr;
+    delete[] m_sh_link;
+    m_sh_link = nullptr;
+    delete[] m_sh_info;
+    m_sh_info = nullptr;
+    first_extern = next_extern = ADDRESS::g(0L);
     ElfSections.clear();
+    m_relocs.clear();
 }
 
 // Hand decompiled from sparc library function
@@ -122,37 +130,54 @@ unsigned elf_hash(const char *o0) {
 } // extern "C"
 // Return true for a good load
 bool ElfBinaryFile::RealLoad(const QString &sName) {
-    int i;
     //    if (m_bArchive) {
     //        // This is a member of an archive. Should not be using this function at all
     //        return false;
     //    }
 
     m_pFileName = sName;
-    m_fd = fopen(qPrintable(sName), "rb");
-    if (m_fd == nullptr)
-        return 0;
-
-    // Determine file size
-    if (fseek(m_fd, 0, SEEK_END)) {
-        fprintf(stderr, "Error seeking to end of binary file\n");
+    m_file.setFileName(sName);
+    if (!m_file.open(QFile::ReadOnly))
+        return false;
+    m_lImageSize = m_file.size();
+    if (m_lImageSize < (long)sizeof(Elf32_Ehdr)) {
+        fprintf(stderr, "Binary file is too small to be an ELF file\n");
         return false;
     }
-    m_lImageSize = ftell(m_fd);
 
-    // Allocate memory to hold the file
-    m_pImage = new char[m_lImageSize];
-    if (m_pImage == nullptr) {
-        fprintf(stderr, "Could not allocate %ld bytes for program image\n", m_lImageSize);
+    // Map the file rather than reading it in, so that only the pages actually used are loaded. The mapping is
+    // private: pages written to (e.g. by applyRelocations()) are copied, and the file itself is never modified
+    m_pImage = (char *)m_file.map(0, m_lImageSize, QFileDevice::MapPrivateOption);
+    m_bImageMapped = m_pImage != nullptr;
+    if (!m_bImageMapped) {
+        // Can't be mapped; allocate memory to hold the file, and read the whole file in
+        m_pImage = new char[m_lImageSize];
+        qint64 size = m_file.read(m_pImage, m_lImageSize);
+        if (size != m_lImageSize)
+            fprintf(stderr, "WARNING! Only read %lld of %ld bytes of binary file!\n", (long long)size, m_lImageSize);
+    }
+    return ProcessElfFile();
+}
+
+// Load an ELF file (e.g. a member of an archive) that is already in memory; sName only names it
+bool ElfBinaryFile::RealLoadFromMemory(const QString &sName, const char *data, size_t size) {
+    m_pFileName = sName;
+    m_lImageSize = size;
+    if (m_lImageSize < (long)sizeof(Elf32_Ehdr)) {
+        fprintf(stderr, "Binary file is too small to be an ELF file\n");
         return false;
     }
-    Elf32_Ehdr *pHeader = (Elf32_Ehdr *)m_pImage; // Save a lot of casts
+    // The image is written to (e.g. by applyRelocations()), so work on a copy rather than the caller's memory
+    m_pImage = new char[m_lImageSize];
+    memcpy(m_pImage, data, m_lImageSize);
+    m_bImageMapped = false;
+    return ProcessElfFile();
+}
 
-    // Read the whole file in
-    fseek(m_fd, 0, SEEK_SET);
-    size_t size = fread(m_pImage, 1, m_lImageSize, m_fd);
-    if (size != (size_t)m_lImageSize)
-        fprintf(stderr, "WARNING! Only read %zd of %ld bytes of binary file!\n", size, m_lImageSize);
+// Read the ELF file in m_pImage: its sections, symbols and relocations
+bool ElfBinaryFile::ProcessElfFile() {
+    int i;
+    Elf32_Ehdr *pHeader = (Elf32_Ehdr *)m_pImage; // Save a lot of casts
 
     // Basic checks
     if (strncmp(m_pImage, "\x7F"
@@ -327,15 +352,20 @@ bool ElfBinaryFile::RealLoad(const QString &sName) {
 
 // Clean up and unload the binary image
 void ElfBinaryFile::UnLoad() {
-    if (m_pImage)
-        delete[] m_pImage;
-    if(m_fd) {
-        fclose(m_fd);
-        m_fd = nullptr;
-    }
+    freeImage();
     Init(); // Set all internal state to 0
 }
 
+void ElfBinaryFile::freeImage() {
+    if (m_bImageMapped)
+        m_file.unmap((uchar *)m_pImage);
+    else
+        delete[] m_pImage;
+    m_pImage = nullptr;
+    m_bImageMapped = false;
+    m_file.close();
+}
+
 // Like a replacement for elf_strptr()
 const char *ElfBinaryFile::GetStrPtr(int idx, int offset) {
     if (idx < 0) {
@@ -465,6 +495,7 @@ void ElfBinaryFile::AddSyms(int secIndex) {
     int nSyms = pSect.Size / pSect.entry_size;
     m_pSym = (const Elf32_Sym *)pSect.image_ptr.m_value; // Pointer to symbols
     int strIdx = m_sh_link[secIndex];               // sh_link points to the string table
+    Symbols->reserve(nSyms);
 
     // Index 0 is a dummy entry
     for (int i = 1; i < nSyms; i++) {
@@ -561,7 +592,7 @@ ADDRESS ElfBinaryFile::NativeToHostAddress(ADDRESS uNative) {
 
 bool ElfBinaryFile::PostLoad(void *handle) {
     Q_UNUSED(handle);
-    // This function is called after an archive member has been loaded by ElfArchiveFile
+    // Not used: archive members are loaded with RealLoadFromMemory() (see BinaryFileFactory::LoadArchive)
 
     // Save the elf pointer
     // m_elf = (Elf*) handle;
@@ -710,6 +741,8 @@ void ElfBinaryFile::applyRelocations() {
         return; // No file loaded
     int machine = elfRead2(&((Elf32_Ehdr *)m_pImage)->e_machine);
     int e_type = elfRead2(&((Elf32_Ehdr *)m_pImage)->e_type);
+    // Index the relocations once, for IsRelocationAt and getRelocations
+    indexRelocations(e_type);
     switch (machine) {
     case EM_SPARC: {
         for (unsigned i = 1; i < ElfSections.size(); ++i) {
@@ -843,62 +876,52 @@ void ElfBinaryFile::applyRelocations() {
     }
 }
 
-bool ElfBinaryFile::IsRelocationAt(ADDRESS uNative) {
-    // int nextFakeLibAddr = -2;            // See R_386_PC32 below; -1 sometimes used for main
-    if (m_pImage == nullptr)
-        return false; // No file loaded
-    int machine = elfRead2(&((Elf32_Ehdr *)m_pImage)->e_machine);
-    int e_type = elfRead2(&((Elf32_Ehdr *)m_pImage)->e_type);
-    switch (machine) {
-    case EM_SPARC:
-        qDebug() << "Unhandled relocation !";
-        break; // Not implemented yet
-    case EM_386: {
-        for (unsigned i = 1; i < ElfSections.size(); ++i) {
-            const SectionParam &ps(ElfSections[i]);
-            if (ps.uType == SHT_REL) {
-                // A section such as .rel.dyn or .rel.plt (without an addend field).
-                // Each entry has 2 words: r_offet and r_info. The r_offset is just the offset from the beginning
-                // of the section (section given by the section header's sh_info) to the word to be modified.
-                // r_info has the type in the bottom byte, and a symbol table index in the top 3 bytes.
-                // A symbol table offset of 0 (STN_UNDEF) means use value 0. The symbol table involved comes from
-                // the section header's sh_link field.
-                int *pReloc = (int *)ps.image_ptr.m_value;
-                unsigned size = ps.Size;
-                // NOTE: the r_offset is different for .o files (E_REL in the e_type header field) than for exe's
-                // and shared objects!
-                ADDRESS destNatOrigin = ADDRESS::g(0L), destHostOrigin;
+/***************************************************************************/ /**
+  *
+  * \brief Index the relocations of every SHT_REL and SHT_RELA section by the native address of the word they
+  * modify, so that IsRelocationAt and getRelocations are lookups rather than walks over the relocation sections.
+  * \note the r_offset of a relocatable object (e_type == E_REL) is an offset into the section given by the
+  * relocation section's sh_info; for executables and shared objects it is a native address.
+  ******************************************************************************/
+void ElfBinaryFile::indexRelocations(int e_type) {
+    m_relocs.clear();
+    for (unsigned i = 1; i < ElfSections.size(); ++i) {
+        const SectionParam &ps(ElfSections[i]);
+        if (ps.uType != SHT_REL && ps.uType != SHT_RELA)
+            continue;
+        size_t entSize = (ps.uType == SHT_RELA) ? sizeof(Elf32_Rela) : sizeof(Elf32_Rel);
+        ADDRESS destNatOrigin = ADDRESS::g(0L);
+        if (e_type == E_REL) {
+            unsigned destSection = m_sh_info[i];
+            if (destSection >= ElfSections.size())
+                continue;
+            destNatOrigin = ElfSections[destSection].SourceAddr;
+        }
+        unsigned symSection = m_sh_link[i]; // Section index for the associated symbol table
+        const Elf32_Sym *symOrigin = nullptr;
+        unsigned numSyms = 0;
+        if (symSection != 0 && symSection < ElfSections.size()) {
+            symOrigin = (const Elf32_Sym *)ElfSections[symSection].image_ptr.m_value;
+            numSyms = ElfSections[symSection].Size / sizeof(Elf32_Sym);
+        }
+        const char *pReloc = (const char *)ps.image_ptr.m_value;
+        for (size_t u = 0; u + entSize <= ps.Size; u += entSize, pReloc += entSize) {
+            unsigned r_offset = elfRead4((const int *)pReloc);
+            unsigned info = elfRead4((const int *)pReloc + 1);
+            unsigned symTabIndex = info >> 8;
+            ADDRESS target = NO_ADDRESS;
+            if (symTabIndex != 0 && symTabIndex < numSyms) {
+                target = ADDRESS::g(elfRead4((const int *)&symOrigin[symTabIndex].st_value));
                 if (e_type == E_REL) {
-                    int destSection = m_sh_info[i];
-                    destNatOrigin = ElfSections[destSection].SourceAddr;
-                    destHostOrigin = ElfSections[destSection].image_ptr;
-                }
-                // int symSection = m_sh_link[i];            // Section index for the associated symbol table
-                // int strSection = m_sh_link[symSection];    // Section index for the string section assoc with this
-                // char* pStrSection = (char*)m_pSections[strSection].uHostAddr;
-                // Elf32_Sym* symOrigin = (Elf32_Sym*) m_pSections[symSection].uHostAddr;
-                for (unsigned u = 0; u < size; u += 2 * sizeof(unsigned)) {
-                    unsigned r_offset = elfRead4(pReloc++);
-                    // unsigned info    = elfRead4(pReloc);
-                    pReloc++;
-                    // unsigned char relType = (unsigned char) info;
-                    // unsigned symTabIndex = info >> 8;
-                    ADDRESS pRelWord; // Pointer to the word to be relocated
-                    if (e_type == E_REL)
-                        pRelWord = destNatOrigin + r_offset;
-                    else {
-                        const IBinarySection *destSec = Image->getSectionInfoByAddr(ADDRESS::g(r_offset));
-                        pRelWord = destSec->sourceAddr() + r_offset;
-                        destNatOrigin = 0;
-                    }
-                    if (uNative == pRelWord)
-                        return true;
+                    unsigned nsec = elfRead2(&symOrigin[symTabIndex].st_shndx);
+                    if (nsec < ElfSections.size())
+                        target += ElfSections[nsec].SourceAddr;
                 }
+                if (target.isZero())
+                    target = NO_ADDRESS; // Undefined in this module
             }
+            m_relocs.add(destNatOrigin + r_offset, info & 0xFF, symTabIndex, target);
         }
     }
-    default:
-        break; // Not implemented
-    }
-    return false;
+    m_relocs.sort();
 }
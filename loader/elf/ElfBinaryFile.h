@@ -19,6 +19,8 @@
   ******************************************************************************/
 
 #include "BinaryFile.h"
+
+#include <QFile>
 struct Elf32_Phdr;
 struct Elf32_Shdr;
 struct Elf32_Rel;
@@ -50,7 +52,7 @@ class ElfBinaryFile : public QObject, public LoaderInterface {
     size_t getImageSize() override;
 
     // Relocation functions
-    bool IsRelocationAt(ADDRESS uNative) override;
+    const RelocationIndex *getRelocations() const override { return &m_relocs; }
 
     // Write an ELF object file for a given procedure
     void writeObjectFile(QString &path, const char *name, void *ptxt, int txtsz, RelocMap &reloc);
@@ -64,14 +66,17 @@ class ElfBinaryFile : public QObject, public LoaderInterface {
     QString m_pFileName; // Pointer to input file name
   protected:
     virtual bool RealLoad(const QString &sName) override; // Load the file; pure virtual
+    bool RealLoadFromMemory(const QString &sName, const char *data, size_t size) override;
 
   private:
     // Apply relocations; important when compiled without -fPIC
     void applyRelocations();
+    // Add the entries of all the SHT_REL and SHT_RELA sections to m_relocs
+    void indexRelocations(int e_type);
     // Not meant to be used externally, but sometimes you just have to have it.
     const char *GetStrPtr(int idx, int offset); // Calc string pointer
     void Init();          // Initialise most member variables
-    int ProcessElfFile(); // Does most of the work
+    bool ProcessElfFile(); // Read the image loaded by RealLoad or RealLoadFromMemory; does most of the work
     void AddSyms(int secIndex);
     void AddRelocsAsSyms(uint32_t secIndex);
     void SetRelocInfo(SectionInfo * pSect);
@@ -85,9 +90,12 @@ class ElfBinaryFile : public QObject, public LoaderInterface {
     int elfRead4(const int *pi) const;      // Read an int with endianness care
     void elfWrite4(int *pi, int val); // Write an int with endianness care
 
-    FILE *m_fd;                             // File stream
+    void freeImage();                       // Unmap or delete the loaded image
+
+    QFile m_file;                           // The input file
     long m_lImageSize;                      // Size of image in bytes
     char *m_pImage;                         // Pointer to the loaded image
+    bool m_bImageMapped;                    // True if m_pImage is a (private) mapping of m_file
     Elf32_Phdr *m_pPhdrs;                   // Pointer to program headers
     Elf32_Shdr *m_pShdrs;                   // Array of section header structs
     char *m_pStrings;                       // Pointer to the string section
@@ -107,6 +115,7 @@ class ElfBinaryFile : public QObject, public LoaderInterface {
     ADDRESS next_extern;                    // where the next extern will be placed
     int *m_sh_link;                         // pointer to array of sh_link values
     int *m_sh_info;                         // pointer to array of sh_info values
+    RelocationIndex m_relocs;               // All relocations, by address
 
     std::vector<struct SectionParam> ElfSections;
     class IBinaryImage *Image;
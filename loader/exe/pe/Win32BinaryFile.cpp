@@ -45,6 +45,7 @@ namespace dbghelp {
 #include <cstring>
 #include <cstdlib>
 #include <cassert>
+#include <algorithm>
 #include <QString>
 #include <QFile>
 
@@ -60,6 +61,8 @@ struct SectionParam {
     size_t PhysSize;
     ADDRESS ImageAddress;
     bool Bss,Code,Data,ReadOnly;
+    const char *LazySource = nullptr; // Where the contents come from, in lazy mode
+    uint32_t LazySize = 0;
 };
 
 }
@@ -71,13 +74,12 @@ struct SectionParam {
 #define IMAGE_SCN_MEM_WRITE 0x80000000
 #endif
 
-Win32BinaryFile::Win32BinaryFile() : mingw_main(false) {
+Win32BinaryFile::Win32BinaryFile()
+    : m_pHeader(nullptr), m_pPEHeader(nullptr), base(nullptr), m_pMapped(nullptr), m_bLazy(false), haveDebugInfo(false),
+      mingw_main(false) {
 }
 
-Win32BinaryFile::~Win32BinaryFile() {
-    if(base)
-        free(base);
-}
+Win32BinaryFile::~Win32BinaryFile() { UnLoad(); }
 void Win32BinaryFile::initialize(IBoomerang *sys) {
     Image = sys->getImage();
     Symbols = sys->getSymbols();
@@ -356,12 +358,13 @@ BOOL CALLBACK lookforsource(dbghelp::PSOURCEFILE pSourceFile, PVOID UserContext)
 
 void Win32BinaryFile::processIAT()
 {
-    PEImportDtor *id = (PEImportDtor *)(LMMH(m_pPEHeader->ImportTableRVA) + base);
+    const PEImportDtor *id = (const PEImportDtor *)loaderView(LMMH(m_pPEHeader->ImportTableRVA));
     if (m_pPEHeader->ImportTableRVA) { // If any import table entry exists
         while (id->name != 0) {
-            char *dllName = LMMH(id->name) + base;
+            const char *dllName = loaderView(LMMH(id->name));
             unsigned thunk = id->originalFirstThunk ? id->originalFirstThunk : id->firstThunk;
-            unsigned *iat = (unsigned *)(LMMH(thunk) + base);
+            const unsigned *iat = (const unsigned *)loaderView(LMMH(thunk));
+            DWord iatRVA = LMMH(thunk);
             unsigned iatEntry = LMMH(*iat);
             ADDRESS paddr = ADDRESS::g(LMMH(id->firstThunk) + LMMH(m_pPEHeader->Imagebase));
             while (iatEntry) {
@@ -372,13 +375,14 @@ void Win32BinaryFile::processIAT()
                     Symbols->create(paddr,nodots).setAttr("Imported",true).setAttr("Function",true);
                 } else {
                     // Normal case (IMAGE_IMPORT_BY_NAME). Skip the useless hint (2 bytes)
-                    QString name((const char *)(iatEntry + 2 + base));
+                    QString name(loaderView(iatEntry + 2));
                     Symbols->create(paddr,name).setAttr("Imported",true).setAttr("Function",true);
-                    ADDRESS old_loc = ADDRESS::host_ptr(iat) - ADDRESS::host_ptr(base) + LMMH(m_pPEHeader->Imagebase);
+                    ADDRESS old_loc = ADDRESS::g(iatRVA + LMMH(m_pPEHeader->Imagebase));
                     if (paddr != old_loc) // add both possibilities
                         Symbols->create(old_loc,QString("old_") + name).setAttr("Imported",true).setAttr("Function",true);
                 }
                 iat++;
+                iatRVA += 4;
                 iatEntry = LMMH(*iat);
                 paddr += 4;
             }
@@ -386,6 +390,41 @@ void Win32BinaryFile::processIAT()
         }
     }
 }
+/***************************************************************************/ /**
+  * \brief Index the base relocations (the .reloc fixup table) by the native address of the word they modify.
+  * The table is a sequence of blocks, each a page RVA and a block size followed by 16 bit entries: the relocation
+  * type in the top 4 bits and the offset into the page in the bottom 12.
+  ******************************************************************************/
+void Win32BinaryFile::processRelocations() {
+    m_relocs.clear();
+    DWord rva = LMMH(m_pPEHeader->FixupTableRVA);
+    DWord size = LMMH(m_pPEHeader->TotalFixupDataSize);
+    DWord imageSize = LMMH(m_pPEHeader->ImageSize);
+    if (rva == 0 || size == 0 || rva >= imageSize || size > imageSize - rva)
+        return;
+    const char *p = loaderView(rva);
+    const char *end = p + size;
+    while (p + 8 <= end) {
+        DWord pageRVA = LMMH2(p);
+        DWord blockSize = LMMH2(p + 4);
+        if (blockSize < 8 || blockSize > DWord(end - p))
+            break;
+        for (const char *e = p + 8; e + 2 <= p + blockSize; e += 2) {
+            unsigned entry = LH(e);
+            unsigned type = entry >> 12;
+            if (type == 0) // IMAGE_REL_BASED_ABSOLUTE: padding
+                continue;
+            DWord offs = pageRVA + (entry & 0xFFF);
+            ADDRESS target = NO_ADDRESS;
+            if (type == 3 && offs <= imageSize - 4) // IMAGE_REL_BASED_HIGHLOW: the word is an absolute address
+                target = ADDRESS::g(LMMH2(loaderView(offs)));
+            m_relocs.add(ADDRESS::g(offs + LMMH(m_pPEHeader->Imagebase)), type, 0, target);
+        }
+        p += blockSize;
+    }
+    m_relocs.sort();
+}
+
 void Win32BinaryFile::readDebugData() {
 #if defined(_WIN32) && !defined(__MINGW32__)
     // attempt to load symbols for the exe or dll
@@ -422,10 +461,31 @@ void Win32BinaryFile::readDebugData() {
     }
 #endif
 }
-bool Win32BinaryFile::LoadFromArray(QByteArray &arr) {
-    const char *data = arr.constData();
-    const char *data_end = arr.constData() + arr.size();
-    if(arr.size()<int(0x40+sizeof(PEHeader)))
+bool Win32BinaryFile::LoadFromArray(QByteArray &arr) { return LoadFromMemory(arr.data(), arr.size()); }
+
+/***************************************************************************/ /**
+  * \brief Check whether the sections of the PE file in data are stored at the offsets given by their RVAs, i.e. the
+  * file is laid out as the image will be in memory
+  ******************************************************************************/
+static bool isLaidOutAsImage(const char *data, size_t size, const PEHeader *hdr, const PEObject *o) {
+    if (LMMH(hdr->ImageSize) > size)
+        return false;
+    uint32_t numSections = LH(&hdr->numObjects);
+    for (unsigned i = 0; i < numSections; i++, o++) {
+        if ((const char *)(o + 1) > data + size)
+            return false;
+        DWord rva = LMMH(o->RVA);
+        if (LMMH(o->PhysicalSize) && LMMH(o->PhysicalOffset) != rva)
+            return false;
+        if (rva + std::max(LMMH(o->VirtualSize), LMMH(o->PhysicalSize)) > size)
+            return false;
+    }
+    return true;
+}
+
+bool Win32BinaryFile::LoadFromMemory(char *data, size_t size) {
+    const char *data_end = data + size;
+    if(size<0x40+sizeof(PEHeader))
         return false;
     DWord peoffLE, peoff;
     peoffLE = *(DWord *)(data+0x3C); // Note: peoffLE will be in Little Endian
@@ -436,16 +496,27 @@ bool Win32BinaryFile::LoadFromArray(QByteArray &arr) {
 
     // Note: all tmphdr fields will be little endian
 
-    base = (char *)malloc(LMMH(tmphdr->ImageSize));
-
-    if (!base) {
-        fprintf(stderr, "Cannot allocate memory for copy of image\n");
-        return false;
-    }
     if(data+LMMH(tmphdr->HeaderSize)>=data_end)
         return false;
-
-    memcpy(base,data,LMMH(tmphdr->HeaderSize));
+    // If the file is laid out as the image (sections at file offsets equal to their RVAs), the private mapping of
+    // the file is used as the image: nothing is copied, and only the pages touched are ever loaded. Otherwise copy
+    // the sections to their RVAs in a new image
+    bool inPlace = data == (char *)m_pMapped &&
+            isLaidOutAsImage(data, size, tmphdr, (PEObject *)((char *)tmphdr + LH(&tmphdr->NtHdrSize) + 24));
+    // Otherwise, in lazy mode each section is only copied in when first used, straight from the mapping
+    m_bLazy = !inPlace && data == (char *)m_pMapped && Image->lazySections();
+    if (inPlace)
+        base = data;
+    else {
+        // In lazy mode the image starts out zero; for a large image, calloc leaves the OS to supply (zero) pages
+        // only as they are written
+        base = (char *)(m_bLazy ? calloc(LMMH(tmphdr->ImageSize), 1) : malloc(LMMH(tmphdr->ImageSize)));
+        if (!base) {
+            fprintf(stderr, "Cannot allocate memory for copy of image\n");
+            return false;
+        }
+        memcpy(base,data,LMMH(tmphdr->HeaderSize));
+    }
     m_pHeader = (Header *)base;
     if (m_pHeader->sigLo != 'M' || m_pHeader->sigHi != 'Z') {
         fprintf(stderr, "error loading file %s, bad magic\n", qPrintable(m_pFileName));
@@ -469,8 +540,22 @@ bool Win32BinaryFile::LoadFromArray(QByteArray &arr) {
     for (unsigned i = 0; i < numSections; i++, o++) {
         SectionParam sect;
         // TODO: Check for unreadable sections (!IMAGE_SCN_MEM_READ)?
-        memset(base + LMMH(o->RVA), 0, LMMH(o->VirtualSize));
-        memcpy(base + LMMH(o->RVA), data+LMMH(o->PhysicalOffset), LMMH(o->PhysicalSize));
+        if (inPlace) {
+            // Only the part of the section not stored in the file needs clearing (copy on write pages)
+            if (LMMH(o->VirtualSize) > LMMH(o->PhysicalSize))
+                memset(base + LMMH(o->RVA) + LMMH(o->PhysicalSize), 0,
+                       LMMH(o->VirtualSize) - LMMH(o->PhysicalSize));
+        } else if (m_bLazy) {
+            // See setLazyContents below
+            DWord imageSize = LMMH(m_pPEHeader->ImageSize);
+            if (LMMH(o->PhysicalSize) && LMMH(o->RVA) < imageSize) {
+                sect.LazySource = data + LMMH(o->PhysicalOffset);
+                sect.LazySize = std::min(LMMH(o->PhysicalSize), imageSize - LMMH(o->RVA));
+            }
+        } else {
+            memset(base + LMMH(o->RVA), 0, LMMH(o->VirtualSize));
+            memcpy(base + LMMH(o->RVA), data+LMMH(o->PhysicalOffset), LMMH(o->PhysicalSize));
+        }
 
         sect.Name = QByteArray(o->ObjectName,8);
         sect.From = ADDRESS::g(LMMH(o->RVA) + LMMH(m_pPEHeader->Imagebase));
@@ -494,13 +579,23 @@ bool Win32BinaryFile::LoadFromArray(QByteArray &arr) {
                 .setReadOnly(par.ReadOnly)
                 .setHostAddr(par.ImageAddress)
                 .setEndian(0); // little endian
+        if (par.LazySource)
+            sect->setLazyContents(par.LazySource, par.LazySize);
         if( !(par.Bss || par.From.isZero()) ) {
             sect->addDefinedArea(par.From,par.From+par.PhysSize);
         }
     }
 
+    // The search for main (GetMainEntryPoint) reads the code around the entry point directly
+    if (m_bLazy) {
+        const IBinarySection *entrySect = Image->getSectionInfoByAddr(GetEntryPoint());
+        if (entrySect)
+            entrySect->materialise();
+    }
+
     // Add the Import Address Table entries to the symbol table
     processIAT();
+    processRelocations();
 
     // Was hoping that _main or main would turn up here for Borland console mode programs. No such luck.
     // I think IDA Pro must find it by a combination of FLIRT and some pattern matching
@@ -523,14 +618,34 @@ bool Win32BinaryFile::LoadFromArray(QByteArray &arr) {
     return true;
 
 }
+/***************************************************************************/ /**
+  * \brief Host pointer to the image data at \a rva, for the loader's own reading of the tables in the image.
+  * In lazy mode this reads the file mapping where the data comes from the file, so the sections it is in need not
+  * be loaded.
+  ******************************************************************************/
+const char *Win32BinaryFile::loaderView(DWord rva) const {
+    if (!m_bLazy)
+        return base + rva;
+    const PEObject *o = (const PEObject *)((const char *)m_pPEHeader + LH(&m_pPEHeader->NtHdrSize) + 24);
+    for (unsigned i = 0, n = LH(&m_pPEHeader->numObjects); i < n; i++, o++) {
+        DWord from = LMMH(o->RVA);
+        if (rva >= from && rva - from < LMMH(o->PhysicalSize))
+            return (const char *)m_pMapped + LMMH(o->PhysicalOffset) + (rva - from);
+    }
+    return base + rva; // Not from the file, so zero (or the headers)
+}
+
 bool Win32BinaryFile::RealLoad(const QString &sName) {
     m_pFileName = sName;
-    QFile fp(sName);
-    if(fp.open(QFile::ReadOnly)) {
-        QByteArray data = fp.readAll();
-        return LoadFromArray(data);
-    }
-    return false;
+    m_file.setFileName(sName);
+    if (!m_file.open(QFile::ReadOnly))
+        return false;
+    // Map the file rather than reading it in; the mapping is private, so writes to it never reach the file
+    m_pMapped = m_file.map(0, m_file.size(), QFileDevice::MapPrivateOption);
+    if (m_pMapped)
+        return LoadFromMemory((char *)m_pMapped, m_file.size());
+    QByteArray data = m_file.readAll();
+    return LoadFromArray(data);
 }
 
 // Used above for a hack to find jump instructions pointing to IATs.
@@ -570,7 +685,22 @@ void Win32BinaryFile::findJumps(ADDRESS curr) {
 }
 
 // Clean up and unload the binary image
-void Win32BinaryFile::UnLoad() {}
+// Release the image, so that this instance can load another file
+void Win32BinaryFile::UnLoad() {
+    if (base && base != (char *)m_pMapped)
+        free(base);
+    if (m_pMapped)
+        m_file.unmap(m_pMapped);
+    m_file.close();
+    base = nullptr;
+    m_pMapped = nullptr;
+    m_bLazy = false;
+    m_pHeader = nullptr;
+    m_pPEHeader = nullptr;
+    m_relocs.clear();
+    haveDebugInfo = false;
+    mingw_main = false;
+}
 
 bool Win32BinaryFile::PostLoad(void *handle) {
     Q_UNUSED(handle);
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "BinaryFile.h"
+#include <QFile>
 #include <string>
 
 /**
@@ -199,23 +200,29 @@ public:
 
 
     bool hasDebugInfo()  override { return haveDebugInfo; }
+    const RelocationIndex *getRelocations() const override { return &m_relocs; }
     void initialize(IBoomerang *sys) override;
 
 protected:
     bool RealLoad(const QString &sName) override; // Load the file; pure virtual
     void processIAT();
+    void processRelocations();
     void readDebugData();
     bool LoadFromArray(QByteArray &arr);
+    bool LoadFromMemory(char *data, size_t size);
 private:
     bool PostLoad(void *handle) override;  // Called after archive member loaded
     void findJumps(ADDRESS curr); // Find names for jumps to IATs
+    const char *loaderView(DWord rva) const; // The loader's own view of the image at rva
 
     Header *m_pHeader;     // Pointer to header
     PEHeader *m_pPEHeader; // Pointer to pe header
     int m_cbImage;         // Size of image
-    int m_cReloc;          // Number of relocation entries
-    DWord *m_pRelocTable;  // The relocation table
+    RelocationIndex m_relocs; // The base relocations, by address
     char *base;            // Beginning of the loaded image
+    QFile m_file;          // The input file
+    uchar *m_pMapped;      // Private mapping of m_file (nullptr if it could not be mapped)
+    bool m_bLazy;          // Sections are copied from m_pMapped into base only when first used
     // Map from address of dynamic pointers to library procedure names:
     QString m_pFileName;
     bool haveDebugInfo;
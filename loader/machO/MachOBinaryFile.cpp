@@ -29,6 +29,9 @@
 #include "objc/objc-class.h"
 #include "objc/objc-runtime.h"
 
+#include <QFile>
+
+#include <algorithm>
 #include <cstdarg>
 #include <cassert>
 #include <cstring>
@@ -53,12 +56,15 @@ struct SectionParam {
 //#define DEBUG_MACHO_LOADER_OBJC
 
 MachOBinaryFile::MachOBinaryFile() {
+    header = nullptr;
+    base = nullptr;
+    entrypoint = loaded_addr = NO_ADDRESS;
+    loaded_size = 0;
     machine = MACHINE_PPC;
     swap_bytes = false;
 }
 
-MachOBinaryFile::~MachOBinaryFile() {
-}
+MachOBinaryFile::~MachOBinaryFile() { UnLoad(); }
 
 void MachOBinaryFile::initialize(IBoomerang *sys)
 {
@@ -92,11 +98,32 @@ ADDRESS MachOBinaryFile::GetMainEntryPoint() {
 
 bool MachOBinaryFile::RealLoad(const QString &sName) {
     m_pFileName = sName;
-    FILE *fp = fopen(qPrintable(sName), "rb");
+    // The headers, symbol and string tables are read straight from a mapping of the file (rather than with one
+    // fread each); the segments are then copied from it to their place in the image
+    QFile file(sName);
+    if (!file.open(QFile::ReadOnly))
+        return false;
+    size_t fileSize = file.size();
+    QByteArray fileCopy;
+    const unsigned char *data = file.map(0, fileSize, QFileDevice::MapPrivateOption);
+    if (data == nullptr) {
+        fileCopy = file.readAll();
+        data = (const unsigned char *)fileCopy.constData();
+    }
+    // Copy n bytes at file offset offs to dest; false if the file is too short
+    auto readAt = [data, fileSize](void *dest, size_t offs, size_t n) {
+        if (offs > fileSize || n > fileSize - offs)
+            return false;
+        memcpy(dest, data + offs, n);
+        return true;
+    };
     unsigned int imgoffs = 0;
 
     unsigned char magic[12 * 4];
-    fread(magic, sizeof(magic), 1, fp);
+    if (!readAt(magic, 0, sizeof(magic))) {
+        fprintf(stderr, "error loading file %s, file too short\n", qPrintable(sName));
+        return false;
+    }
 
     if (magic[0] == 0xca && magic[1] == 0xfe && magic[2] == 0xba && magic[3] == 0xbe) {
         int nimages = BE4(4);
@@ -119,12 +146,9 @@ bool MachOBinaryFile::RealLoad(const QString &sName) {
         }
     }
 
-    fseek(fp, imgoffs, SEEK_SET);
     header = new struct mach_header;
-    fread(header, sizeof(*header), 1, fp);
-
-    if ((header->magic != MH_MAGIC) && (_BMMH(header->magic) != MH_MAGIC)) {
-        fclose(fp);
+    if (!readAt(header, imgoffs, sizeof(*header)) ||
+            ((header->magic != MH_MAGIC) && (_BMMH(header->magic) != MH_MAGIC))) {
         fprintf(stderr, "error loading file %s, bad Mach-O magic\n", qPrintable(sName));
         return false;
     }
@@ -144,27 +168,28 @@ bool MachOBinaryFile::RealLoad(const QString &sName) {
     // uint32_t startundef, nundef;
     // uint32_t  startlocal, nlocal,ndef, startdef;
     std::vector<section> stubs_sects;
-    char *strtbl = nullptr;
-    unsigned *indirectsymtbl = nullptr;
+    const char *strtbl = nullptr;
+    const unsigned *indirectsymtbl = nullptr;
     ADDRESS objc_symbols = NO_ADDRESS, objc_modules = NO_ADDRESS, objc_strings = NO_ADDRESS, objc_refs = NO_ADDRESS;
     unsigned objc_modules_size = 0;
 
-    fseek(fp, imgoffs + sizeof(*header), SEEK_SET);
+    size_t pos = imgoffs + sizeof(*header);
     for (unsigned i = 0; i < BMMH(header->ncmds); i++) {
         struct load_command cmd;
-        long pos = ftell(fp);
-        fread(&cmd, 1, sizeof(struct load_command), fp);
-        fseek(fp, pos, SEEK_SET);
+        if (!readAt(&cmd, pos, sizeof(struct load_command)))
+            break;
         switch (BMMH(cmd.cmd)) {
         case LC_SEGMENT: {
             segment_command seg;
-            fread(&seg, 1, sizeof(seg), fp);
+            if (!readAt(&seg, pos, sizeof(seg)))
+                break;
             segments.push_back(seg);
             DEBUG_PRINT("seg addr %x size %i fileoff %x filesize %i flags %x\n", BMMH(seg.vmaddr), BMMH(seg.vmsize),
                     BMMH(seg.fileoff), BMMH(seg.filesize), BMMH(seg.flags));
             for (unsigned n = 0; n < BMMH(seg.nsects); n++) {
                 section sect;
-                fread(&sect, 1, sizeof(sect), fp);
+                if (!readAt(&sect, pos + sizeof(seg) + n * sizeof(sect), sizeof(sect)))
+                    break;
                 sections.push_back(sect);
                 DEBUG_PRINT("    sectname %s segname %s addr %x size %i flags %x\n", sect.sectname, sect.segname,
                         BMMH(sect.addr), BMMH(sect.size), BMMH(sect.flags));
@@ -194,22 +219,25 @@ bool MachOBinaryFile::RealLoad(const QString &sName) {
         } break;
         case LC_SYMTAB: {
             struct symtab_command syms;
-            fread(&syms, 1, sizeof(syms), fp);
-            fseek(fp, imgoffs + BMMH(syms.stroff), SEEK_SET);
-            strtbl = new char[BMMH(syms.strsize)];
-            fread(strtbl, 1, BMMH(syms.strsize), fp);
-            fseek(fp, imgoffs + BMMH(syms.symoff), SEEK_SET);
+            if (!readAt(&syms, pos, sizeof(syms)))
+                break;
+            if (imgoffs + BMMH(syms.stroff) + BMMH(syms.strsize) <= fileSize)
+                strtbl = (const char *)data + imgoffs + BMMH(syms.stroff);
+            symbols.resize(BMMH(syms.nsyms));
             for (unsigned n = 0; n < BMMH(syms.nsyms); n++) {
-                struct nlist sym;
-                fread(&sym, 1, sizeof(sym), fp);
-                symbols.push_back(sym);
+                struct nlist &sym = symbols[n];
+                if (!readAt(&sym, imgoffs + BMMH(syms.symoff) + n * sizeof(sym), sizeof(sym))) {
+                    symbols.resize(n);
+                    break;
+                }
                 // DEBUG_PRINT(stdout, "got sym %s flags %x value %x\n", strtbl + BMMH(sym.n_un.n_strx), sym.n_type, BMMH(sym.n_value));
             }
             DEBUG_PRINT("symtab contains %i symbols\n", BMMH(syms.nsyms));
         } break;
         case LC_DYSYMTAB: {
             struct dysymtab_command syms;
-            fread(&syms, 1, sizeof(syms), fp);
+            if (!readAt(&syms, pos, sizeof(syms)))
+                break;
             DEBUG_PRINT("dysymtab local %i %i defext %i %i undef %i %i\n", BMMH(syms.ilocalsym),
                     BMMH(syms.nlocalsym), BMMH(syms.iextdefsym), BMMH(syms.nextdefsym), BMMH(syms.iundefsym),
                     BMMH(syms.nundefsym));
@@ -222,9 +250,8 @@ bool MachOBinaryFile::RealLoad(const QString &sName) {
             // nundef = BMMH(syms.nundefsym);
 
             DEBUG_PRINT("dysymtab has %i indirect symbols: ", BMMH(syms.nindirectsyms));
-            indirectsymtbl = new unsigned[BMMH(syms.nindirectsyms)];
-            fseek(fp, imgoffs + BMMH(syms.indirectsymoff), SEEK_SET);
-            fread(indirectsymtbl, 1, BMMH(syms.nindirectsyms) * sizeof(unsigned), fp);
+            if (imgoffs + BMMH(syms.indirectsymoff) + BMMH(syms.nindirectsyms) * sizeof(unsigned) <= fileSize)
+                indirectsymtbl = (const unsigned *)(data + imgoffs + BMMH(syms.indirectsymoff));
             for (unsigned j = 0; j < BMMH(syms.nindirectsyms); j++) {
                 DEBUG_PRINT("%i ", BMMH(indirectsymtbl[j]));
             }
@@ -236,7 +263,12 @@ bool MachOBinaryFile::RealLoad(const QString &sName) {
             break;
         }
 
-        fseek(fp, pos + BMMH(cmd.cmdsize), SEEK_SET);
+        pos += BMMH(cmd.cmdsize);
+    }
+
+    if (segments.empty()) {
+        fprintf(stderr, "error loading file %s, no segments\n", qPrintable(sName));
+        return false;
     }
 
     struct segment_command *lowest = &segments[0], *highest = &segments[0];
@@ -253,18 +285,16 @@ bool MachOBinaryFile::RealLoad(const QString &sName) {
     base = (char *)malloc(loaded_size);
 
     if (!base) {
-        fclose(fp);
         fprintf(stderr, "Cannot allocate memory for copy of image\n");
         return false;
     }
 
     for (unsigned i = 0; i < segments.size(); i++) {
-        fseek(fp, imgoffs + BMMH(segments[i].fileoff), SEEK_SET);
         ADDRESS a = ADDRESS::g(BMMH(segments[i].vmaddr));
         unsigned sz = BMMH(segments[i].vmsize);
-        unsigned fsz = BMMH(segments[i].filesize);
-        memset(base + a.m_value - loaded_addr.m_value, 0, sz);
-        fread(base + a.m_value - loaded_addr.m_value, 1, fsz, fp);
+        unsigned fsz = std::min(BMMH(segments[i].filesize), sz);
+        memset(base + a.m_value - loaded_addr.m_value + fsz, 0, sz - fsz);
+        readAt(base + a.m_value - loaded_addr.m_value, imgoffs + BMMH(segments[i].fileoff), fsz);
         DEBUG_PRINT("loaded segment %tx %i in mem %i in file\n", a.m_value, sz, fsz);
         QString name = QByteArray(segments[i].segname,17);
         IBinarySection *sect = Image->createSection(name,ADDRESS::n(BMMH(segments[i].vmaddr)),
@@ -304,10 +334,12 @@ bool MachOBinaryFile::RealLoad(const QString &sName) {
     for (unsigned j = 0; j < stubs_sects.size(); j++) {
         for (unsigned i = 0; i < BMMH(stubs_sects[j].size) / BMMH(stubs_sects[j].reserved2); i++) {
             unsigned startidx = BMMH(stubs_sects[j].reserved1);
+            if (indirectsymtbl == nullptr || strtbl == nullptr)
+                break;
             unsigned symbol = BMMH(indirectsymtbl[startidx + i]);
             ADDRESS addr = ADDRESS::g(BMMH(stubs_sects[j].addr) + i * BMMH(stubs_sects[j].reserved2));
             DEBUG_PRINT("stub for %s at %tx\n", strtbl + BMMH(symbols[symbol].n_un.n_strx), addr.m_value);
-            char *name = strtbl + BMMH(symbols[symbol].n_un.n_strx);
+            const char *name = strtbl + BMMH(symbols[symbol].n_un.n_strx);
             if (*name == '_') // we want printf not _printf
                 name++;
             Symbols->create(addr,name).setAttr("Function",true).setAttr("Imported",true);
@@ -315,8 +347,8 @@ bool MachOBinaryFile::RealLoad(const QString &sName) {
     }
 
     // process the remaining symbols
-    for (unsigned i = 0; i < symbols.size(); i++) {
-        char *name = strtbl + BMMH(symbols[i].n_un.n_strx);
+    for (unsigned i = 0; strtbl && i < symbols.size(); i++) {
+        const char *name = strtbl + BMMH(symbols[i].n_un.n_strx);
         if (BMMH(symbols[i].n_un.n_strx) != 0 && BMMH(symbols[i].n_value) != 0 && *name != 0) {
 
             uint8_t sym_type  = symbols[i].n_type;
@@ -388,12 +420,22 @@ bool MachOBinaryFile::RealLoad(const QString &sName) {
     // ADDRESS entry = GetMainEntryPoint();
     entrypoint = GetMainEntryPoint();
 
-    fclose(fp);
     return true;
 }
 
 // Clean up and unload the binary image
-void MachOBinaryFile::UnLoad() {}
+void MachOBinaryFile::UnLoad() {
+    free(base);
+    base = nullptr;
+    delete header;
+    header = nullptr;
+    sections.clear();
+    modules.clear();
+    entrypoint = loaded_addr = NO_ADDRESS;
+    loaded_size = 0;
+    machine = MACHINE_PPC;
+    swap_bytes = false;
+}
 
 bool MachOBinaryFile::PostLoad(void *handle) {
     Q_UNUSED(handle);
@@ -34,16 +34,21 @@
 
 #include "../microX86dis.c"
 #include "LoaderTest.h"
+#include "ArchiveFile.h"
 #include "boomerang.h"
 #include "IBinaryImage.h"
+#include "IBinarySection.h"
+#include "IBinarySymbols.h"
 #include "log.h"
 
 #include <QLibrary>
 #include <QTextStream>
 #include <QDir>
 #include <QProcessEnvironment>
+#include <QTemporaryFile>
 #include <QDebug>
 #include <sstream>
+#include <cstring>
 
 static bool logset = false;
 static QString TEST_BASE;
@@ -282,6 +287,40 @@ void LoaderTest::testWinLoad() {
     bff.UnLoad();
 }
 
+/***************************************************************************/ /**
+  * \fn        LoaderTest::testLazySections
+  * OVERVIEW:        Test that a lazily loaded image reads the same as one loaded up front
+  ******************************************************************************/
+void LoaderTest::testLazySections() {
+    QList<int> firstWords;
+    BinaryFileFactory bff;
+    QObject *pBF = bff.Load(SWITCH_BORLAND);
+    QVERIFY(pBF != nullptr);
+    IBinaryImage *image = Boomerang::get()->getImage();
+    ADDRESS mainAddr = qobject_cast<LoaderInterface *>(pBF)->GetMainEntryPoint();
+    for (const IBinarySection *sect : *image)
+        firstWords << image->readNative4(sect->sourceAddr());
+    bff.UnLoad();
+
+    Boomerang::get()->lazySections = true;
+    pBF = bff.Load(SWITCH_BORLAND);
+    Boomerang::get()->lazySections = false;
+    QVERIFY(pBF != nullptr);
+    QCOMPARE((int)image->size(), firstWords.size());
+    QCOMPARE(qobject_cast<LoaderInterface *>(pBF)->GetMainEntryPoint(), mainAddr);
+    int notLoaded = 0;
+    for (const IBinarySection *sect : *image)
+        if (!sect->isMaterialised())
+            ++notLoaded;
+    QVERIFY(notLoaded > 0);
+    int i = 0;
+    for (const IBinarySection *sect : *image) {
+        QCOMPARE(image->readNative4(sect->sourceAddr()), firstWords[i++]);
+        QVERIFY(sect->isMaterialised());
+    }
+    bff.UnLoad();
+}
+
 /***************************************************************************/ /**
   * \fn        LoaderTest::testMicroDis
   * OVERVIEW:        Test the micro disassembler
@@ -564,4 +603,234 @@ void LoaderTest::testElfHash() {
     unsigned exp = 0x737fe;
     QCOMPARE(act,exp);
 }
+
+/***************************************************************************/ /**
+  * \fn        LoaderTest::testElfRelocations
+  * OVERVIEW:        Test the relocation index of the pentium hello world program
+  ******************************************************************************/
+void LoaderTest::testElfRelocations() {
+    BinaryFileFactory bff;
+    QObject *pBF = bff.Load(HELLO_PENTIUM);
+    QVERIFY(pBF != nullptr);
+    LoaderInterface *ldr_iface = qobject_cast<LoaderInterface *>(pBF);
+    QVERIFY(ldr_iface != nullptr);
+    const RelocationIndex *relocs = ldr_iface->getRelocations();
+    QVERIFY(relocs != nullptr);
+    QVERIFY(!relocs->empty());
+    ADDRESS prev = ADDRESS::g(0L);
+    for (const RelocationInfo &r : *relocs) {
+        QVERIFY(prev <= r.addr);
+        prev = r.addr;
+        QVERIFY(ldr_iface->IsRelocationAt(r.addr));
+        QCOMPARE(relocs->find(r.addr)->addr, r.addr);
+    }
+    QVERIFY(!ldr_iface->IsRelocationAt(ADDRESS::g(0L)));
+    bff.UnLoad();
+    delete pBF;
+}
+
+/***************************************************************************/ /**
+  * \fn        LoaderTest::testContainingSymbol
+  * OVERVIEW:        Test finding the symbol whose range contains an address
+  ******************************************************************************/
+void LoaderTest::testContainingSymbol() {
+    BinaryFileFactory bff;
+    QObject *pBF = bff.Load(HELLO_PENTIUM);
+    QVERIFY(pBF != nullptr);
+    IBinarySymbolTable *symbols = Boomerang::get()->getSymbols();
+    const IBinarySymbol *mainSym = symbols->find("main");
+    QVERIFY(mainSym != nullptr);
+    QVERIFY(mainSym->getSize() > 1);
+    ADDRESS start = mainSym->getLocation();
+    QCOMPARE(symbols->findContainingSymbol(start), mainSym);
+    QCOMPARE(symbols->findContainingSymbol(start + 1), mainSym);
+    QVERIFY(symbols->findContainingSymbol(start + (intptr_t)mainSym->getSize()) != mainSym);
+    QVERIFY(symbols->findContainingSymbol(ADDRESS::g(0L)) == nullptr);
+    bff.UnLoad();
+    delete pBF;
+}
+
+/***************************************************************************/ /**
+  * \fn        LoaderTest::testSymbolLookup
+  * OVERVIEW:        Test finding symbols by address and by name in a large symbol table
+  ******************************************************************************/
+void LoaderTest::testSymbolLookup() {
+    IBinarySymbolTable *symbols = Boomerang::get()->getSymbols();
+    symbols->clear();
+    const int count = 20000;
+    symbols->reserve(count / 2); // The indexes must still grow past this
+    for (int i = 0; i < count; ++i)
+        symbols->create(ADDRESS::g(0x1000 + 16 * i), QString("sym%1").arg(i), i % 10 == 0);
+    for (int i = 0; i < count; i += 7) {
+        const IBinarySymbol *sym = symbols->find(ADDRESS::g(0x1000 + 16 * i));
+        QVERIFY(sym != nullptr);
+        QCOMPARE(sym->getName(), QString("sym%1").arg(i));
+        // Local symbols can only be found by address
+        QCOMPARE(symbols->find(QString("sym%1").arg(i)), i % 10 == 0 ? nullptr : sym);
+    }
+    QVERIFY(symbols->find(ADDRESS::g(0x1008)) == nullptr);
+    QVERIFY(symbols->find("sym") == nullptr);
+
+    const IBinarySymbol *sym1 = symbols->find("sym1");
+    QVERIFY(!const_cast<IBinarySymbol *>(sym1)->rename("sym2"));
+    QVERIFY(const_cast<IBinarySymbol *>(sym1)->rename("renamed"));
+    QVERIFY(symbols->find("sym1") == nullptr);
+    QCOMPARE(symbols->find("renamed"), sym1);
+    QCOMPARE(symbols->find(ADDRESS::g(0x1010)), sym1);
+    symbols->clear();
+    QVERIFY(symbols->find("renamed") == nullptr);
+}
+
+/***************************************************************************/ /**
+  * \fn        LoaderTest::testStringIndex
+  * OVERVIEW:        Test the index of strings made when a binary is loaded
+  ******************************************************************************/
+void LoaderTest::testStringIndex() {
+    BinaryFileFactory bff;
+    QObject *pBF = bff.Load(HELLO_PENTIUM);
+    QVERIFY(pBF != nullptr);
+    IBinaryImage *image = Boomerang::get()->getImage();
+    const StringConstant *hello = nullptr;
+    for (const StringConstant &str : image->getStrings()) {
+        const char *text = (const char *)image->readSpan(str.addr, str.length + 1);
+        QVERIFY(text != nullptr);
+        QCOMPARE(strlen(text), size_t(str.length));
+        QVERIFY(!image->getSectionInfoByAddr(str.addr)->isCode());
+        for (const char *c = text; *c; ++c)
+            QVERIFY(((uint8_t)*c >= ' ' && *c != '\x7F') || *c == '\t' || *c == '\n' || *c == '\r');
+        if (QString(text) == "Hello, world!\n")
+            hello = &str;
+    }
+    QVERIFY(hello != nullptr);
+    QCOMPARE(&image->getStrings(), &image->getStrings()); // Made once, not on each call
+    QVERIFY(image->findString(hello->addr) != nullptr);
+    QCOMPARE(image->findString(hello->addr)->addr, hello->addr);
+    QCOMPARE(image->findString(hello->addr + 7), image->findString(hello->addr));
+    QCOMPARE(image->findString(hello->addr)->length, hello->length);
+    QVERIFY(image->findString(hello->addr + (intptr_t)hello->length) == nullptr); // The NUL
+    bff.UnLoad();
+    delete pBF;
+}
+
+/***************************************************************************/ /**
+  * \fn        LoaderTest::testBatchLoad
+  * OVERVIEW:        Test that loading a batch of files reuses the loader instance
+  ******************************************************************************/
+void LoaderTest::testBatchLoad() {
+    BinaryFileFactory bff;
+    QList<QObject *> loaders;
+    QList<int> numSections;
+    bff.LoadBatch(QStringList() << HELLO_PENTIUM << HELLO_PENTIUM, [&](const QString &, QObject *pBF) {
+        loaders << pBF;
+        numSections << Boomerang::get()->getImage()->GetNumSections();
+    });
+    QCOMPARE(loaders.size(), 2);
+    QVERIFY(loaders[0] != nullptr);
+    QCOMPARE(loaders[1], loaders[0]);
+    QCOMPARE(numSections[1], numSections[0]);
+    delete loaders[0];
+}
+/***************************************************************************/ /**
+  * \fn        LoaderTest::testArchiveMembers
+  * OVERVIEW:        Test indexing an archive, and extracting the symbols of its members on several threads
+  ******************************************************************************/
+void LoaderTest::testArchiveMembers() {
+    QFile hello(HELLO_PENTIUM);
+    QVERIFY(hello.open(QFile::ReadOnly));
+    QByteArray member = hello.readAll();
+    // A GNU archive: the long name table, then a long named and a short named copy of hello
+    QByteArray longNames = "a_rather_long_member_name.o/\n";
+    auto header = [](const QByteArray &name, int size) {
+        return QString("%1%2%3").arg(QString(name), -48).arg(size, -10).arg("`\n").toLatin1();
+    };
+    QByteArray ar = "!<arch>\n";
+    ar += header("//", longNames.size()) + longNames;
+    ar += header("/0", member.size()) + member;
+    if (ar.size() & 1)
+        ar += '\n';
+    ar += header("hello.o/", member.size()) + member;
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(ar);
+    file.close();
+
+    ArchiveFile archive;
+    QVERIFY(archive.Load(file.fileName()));
+    QCOMPARE(archive.GetNumMembers(), 2);
+    QCOMPARE(archive.GetMemberFileName(0), QString("a_rather_long_member_name.o"));
+    QCOMPARE(archive.GetMemberFileName(1), QString("hello.o"));
+    QCOMPARE(archive.GetMemberByFileName("hello.o"), 1);
+    QCOMPARE((int)archive.GetMember(1).size, member.size());
+    QVERIFY(memcmp(archive.GetMember(1).data, member.constData(), member.size()) == 0);
+
+    archive.extractSymbols(1);
+    QStringList serial = archive.GetMember(0).definedSymbols;
+    QVERIFY(serial.contains("main"));
+    archive.extractSymbols(4);
+    QCOMPARE(archive.GetMember(0).definedSymbols, serial);
+    QCOMPARE(archive.GetMember(1).definedSymbols, serial);
+    QCOMPARE(archive.GetMemberByProcName("main"), 0); // The first member defining it
+    QCOMPARE(archive.GetMemberByProcName("no_such_symbol"), -1);
+}
+
+/***************************************************************************/ /**
+  * \fn        LoaderTest::testArchiveLoad
+  * OVERVIEW:        Test loading the members of an archive, in archive order, from the archive's memory
+  ******************************************************************************/
+void LoaderTest::testArchiveLoad() {
+    // What ordinary loads of the files find
+    BinaryFileFactory bff;
+    QList<ADDRESS> mains;
+    QList<MACHINE> machines;
+    bff.LoadBatch(QStringList() << HELLO_PENTIUM << HELLO_SPARC, [&](const QString &, QObject *pBF) {
+        LoaderInterface *ldr = qobject_cast<LoaderInterface *>(pBF);
+        QVERIFY(ldr != nullptr);
+        mains << ldr->GetMainEntryPoint();
+        machines << ldr->getMachine();
+    });
+    QCOMPARE(mains.size(), 2);
+
+    // An archive of the two, with a member that is not an ELF file between them
+    auto member = [](const QByteArray &name, const QByteArray &data) {
+        QByteArray res = QString("%1%2%3").arg(QString(name), -48).arg(data.size(), -10).arg("`\n").toLatin1() + data;
+        if (res.size() & 1)
+            res += '\n';
+        return res;
+    };
+    auto contents = [](const QString &path) {
+        QFile f(path);
+        return f.open(QFile::ReadOnly) ? f.readAll() : QByteArray();
+    };
+    QByteArray ar = "!<arch>\n";
+    ar += member("pentium.o/", contents(HELLO_PENTIUM));
+    ar += member("notes.txt/", "not an object file\n");
+    ar += member("sparc.o/", contents(HELLO_SPARC));
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(ar);
+    file.close();
+
+    QStringList names;
+    QList<QObject *> loaders;
+    QList<ADDRESS> memberMains;
+    QList<MACHINE> memberMachines;
+    QVERIFY(bff.LoadArchive(file.fileName(), [&](const QString &name, QObject *pBF) {
+        names << name;
+        loaders << pBF;
+        LoaderInterface *ldr = qobject_cast<LoaderInterface *>(pBF);
+        memberMains << (ldr ? ldr->GetMainEntryPoint() : NO_ADDRESS);
+        memberMachines << (ldr ? ldr->getMachine() : MACHINE_UNKNOWN);
+        if (ldr)
+            QCOMPARE(ldr->getFilename(), name);
+    }));
+    QCOMPARE(names, QStringList() << "pentium.o" << "notes.txt" << "sparc.o");
+    QVERIFY(loaders[0] != nullptr);
+    QVERIFY(loaders[1] == nullptr);
+    QCOMPARE(loaders[2], loaders[0]); // The resident ELF loader
+    QVERIFY(memberMains[0] == mains[0]);
+    QVERIFY(memberMains[2] == mains[1]);
+    QCOMPARE(memberMachines[0], machines[0]);
+    QCOMPARE(memberMachines[2], machines[1]);
+    QVERIFY(!bff.LoadArchive(baseDir.absoluteFilePath("no/such/archive.a"), [](const QString &, QObject *) {}));
+}
 QTEST_MAIN(LoaderTest)
@@ -9,10 +9,18 @@ class LoaderTest : public QObject {
     void testHppaLoad();
     void testPalmLoad();
     void testWinLoad();
+    void testLazySections();
 
     void testMicroDis1();
     void testMicroDis2();
 
     void testElfHash();
+    void testElfRelocations();
+    void testContainingSymbol();
+    void testSymbolLookup();
+    void testStringIndex();
+    void testBatchLoad();
+    void testArchiveMembers();
+    void testArchiveLoad();
     void initTestCase();
 };
@@ -76,11 +76,13 @@ Log &Log::operator<<(ADDRESS a) {
 }
 
 Log &FileLogger::operator<<(const QString &str) {
+    std::lock_guard<std::mutex> guard(outMutex);
     out << str.toStdString() << std::flush;
     return *this;
 }
 
 Log &SeparateLogger::operator<<(const QString &str) {
+    std::lock_guard<std::mutex> guard(outMutex);
     (*out) << str.toStdString() << std::flush;
     return *this;
 }
@@ -29,13 +29,18 @@ static void help() {
     q_cout << "  -E <addr>        : Decode the procedure at addr, no callees\n";
     q_cout << "                     Use -e and -E repeatedly for multiple entry points\n";
     q_cout << "  -ic              : Decode through type 0 Indirect Calls\n";
+    q_cout << "  -is              : Find procedures with a linear sweep of the code before decoding (x86)\n";
+    q_cout << "  -j <num>         : Decode instructions with num threads in parallel\n";
     q_cout << "  -S <min>         : Stop decompilation after specified number of minutes\n";
     q_cout << "  -t               : Trace (print address of) every instruction decoded\n";
     q_cout << "  -Tc              : Use old constraint-based type analysis\n";
     q_cout << "  -Td              : Use data-flow-based type analysis\n";
+    q_cout << "  -LA              : <program> is an archive (.a): decompile each of its members in turn\n";
     q_cout << "  -LD              : Load before decompile (<program> becomes xml input file)\n";
+    q_cout << "  -LS              : Load each section only when first used (huge PE binaries)\n";
     q_cout << "  -SD              : Save before decompile\n";
     q_cout << "  -a               : Assume ABI compliance\n";
+    q_cout << "  -A               : Allocate the IR of each procedure in an arena, freed with the program\n";
     q_cout << "  -W               : Windows specific decompilation mode (requires pdb information)\n";
     //    q_cout << "  -pa              : only propagate if can propagate to all\n";
     q_cout << "Output\n";
@@ -81,6 +86,7 @@ static void help() {
     q_cout << "                     DriverMain)\n";
     q_cout << "  -nr              : No removal of unneeded labels\n";
     q_cout << "  -nR              : No removal of unused Returns\n";
+    q_cout << "  -nS              : No use of the cached SSL dictionary (always parse the .ssl file)\n";
     q_cout << "  -l <depth>       : Limit multi-propagations to expressions with depth <depth>\n";
     q_cout << "  -p <num>         : Only do num propagations\n";
     q_cout << "  -m <num>         : Max memory depth\n";
@@ -181,16 +187,34 @@ int CommandlineDriver::applyCommandline(const QStringList &args) {
         case 'i':
             if (arg[2] == 'c')
                 boom.decodeThruIndCall = true; // -ic;
+            else if (arg[2] == 's')
+                boom.linearSweep = true; // -is
             break;
         case '-':
             break; // No effect: ignored
         case 'L':
-            if (arg[2] == 'D')
+            if (arg[2] == 'A')
+                boom.loadArchive = true; // -LA
+            else if (arg[2] == 'D')
                 boom.loadBeforeDecompile = true;
+            else if (arg[2] == 'S')
+                boom.lazySections = true; // -LS
             break;
         case 'k':
             kmd = 1;
             break;
+        case 'j': {
+            if (++i == args.size()) {
+                usage();
+                return 1;
+            }
+            bool converted = false;
+            boom.numDecodeThreads = args[i].toInt(&converted);
+            if (!converted || boom.numDecodeThreads < 1) {
+                LOG_STREAM() << "bad number of decode threads: " << args[i] << '\n';
+                exit(1);
+            }
+        } break;
         case 'P': {
             QString qstr(args[++i] + "/");
             QFileInfo qfi(qstr);
@@ -232,6 +256,9 @@ int CommandlineDriver::applyCommandline(const QStringList &args) {
             case 'g':
                 boom.noGlobals = true;
                 break;
+            case 'S':
+                boom.noSSLCache = true;
+                break;
             case 'G':
 #ifndef NO_GARBAGE_COLLECTOR
                 GC_disable();
@@ -316,6 +343,9 @@ int CommandlineDriver::applyCommandline(const QStringList &args) {
         case 'a':
             boom.assumeABI = true;
             break;
+        case 'A':
+            boom.procArenas = true;
+            break;
         case 'l':
             if (++i == args.size()) {
                 usage();
@@ -381,7 +411,7 @@ void CommandlineDriver::onCompilationTimeout() {
 
 void DecompilationThread::run() {
     Boomerang &boom(*Boomerang::get());
-    Result = boom.decompile(m_decompiled);
+    Result = boom.loadArchive ? boom.decompileArchive(m_decompiled) : boom.decompile(m_decompiled);
     boom.getLogStream().flush();
     boom.getLogStream(LL_Error).flush();
 }